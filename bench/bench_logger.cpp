@@ -0,0 +1,240 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../include/logger.hpp"
+
+// Discards everything written to it, so console pipelines can be measured without a terminal
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override {
+        return c;
+    }
+
+    std::streamsize xsputn(const char*, std::streamsize count) override {
+        return count;
+    }
+};
+
+// Redirects std::cout to a NullBuffer for the lifetime of the object
+class SilencedConsole {
+public:
+    SilencedConsole() : previous(std::cout.rdbuf(&buffer)) {}
+    ~SilencedConsole() {
+        std::cout.rdbuf(previous);
+    }
+
+private:
+    NullBuffer buffer;
+    std::streambuf* previous;
+};
+
+using LoggerMaker = std::function<std::unique_ptr<ILogger>(const std::string& filename)>;
+
+struct PipelineCase {
+    std::string name;
+    LoggerMaker make;
+    bool threadSafe; // Only thread-safe pipelines are measured with several producer threads
+};
+
+static const std::string Message = "request handled in 42 ms for user 1234";
+
+static std::string benchFile(const std::string& name)
+{
+    std::string filename = "bench_" + name + ".log";
+    std::remove(filename.c_str());
+    return filename;
+}
+
+static void removeBenchFile(const std::string& name)
+{
+    std::remove(("bench_" + name + ".log").c_str());
+}
+
+static std::unique_ptr<ILogger> makeMultiOutputLogger(const std::string& filename)
+{
+    std::vector<std::unique_ptr<IOutputStrategy>> outputs;
+    outputs.push_back(std::make_unique<ConsoleOutput>());
+    outputs.push_back(std::make_unique<FileOutput>(filename));
+    return std::make_unique<Logger>(std::make_unique<MultiOutput>(std::move(outputs)));
+}
+
+static std::unique_ptr<ILogger> makeFanOutLogger(const std::string& filename)
+{
+    std::vector<SinkConfig> sinks;
+    sinks.push_back(SinkConfig{std::make_unique<ConsoleOutput>()});
+    sinks.push_back(SinkConfig{std::make_unique<BufferedFileOutput>(filename)});
+    return std::make_unique<Logger>(std::make_unique<FanOutOutput>(std::move(sinks)));
+}
+
+// ConsoleOutput writing straight to a descriptor, without the std::cout redirection fallback
+static std::unique_ptr<ILogger> makeConsoleDescriptorLogger(const std::string&)
+{
+    static const int devNull = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+    ConsoleOptions options;
+    options.outputFd = devNull;
+    return std::make_unique<Logger>(std::make_unique<ConsoleOutput>(options));
+}
+
+// Every pipeline the benchmarks cover, by name
+static const std::vector<PipelineCase>& pipelines()
+{
+    static const std::vector<PipelineCase> all = {
+        {"ConsoleWithLevel", [](const std::string&) { return LoggerFactory::createConsoleLoggerWithLevel(); }, false},
+        {"ConsoleDescriptor", makeConsoleDescriptorLogger, false},
+        {"FileWithLevelFilter", [](const std::string& file) { return LoggerFactory::createFileLoggerWithLevelFilter(file); }, false},
+        {"BufferedFileWithLevelFilter", [](const std::string& file) { return LoggerFactory::createFileLoggerWithLevelFilter(file, FlushPolicy()); }, false},
+        {"FileWithLevelAndTimestamp", [](const std::string& file) { return LoggerFactory::createFileLoggerWithLevelAndTimestamp(file); }, false},
+        {"BufferedFileWithLevelAndTimestamp", [](const std::string& file) { return LoggerFactory::createFileLoggerWithLevelAndTimestamp(file, FlushPolicy()); }, false},
+        {"IoUringFile", [](const std::string& file) { return std::make_unique<Logger>(std::make_unique<IoUringFileOutput>(file)); }, false},
+        {"AsyncFile", [](const std::string& file) { return LoggerFactory::createAsyncFileLogger(file); }, true},
+        {"ShardedFile", [](const std::string& file) { return LoggerFactory::createShardedFileLogger(file); }, true},
+        {"MultiOutput", makeMultiOutputLogger, false},
+        {"FanOutOutput", makeFanOutLogger, true},
+    };
+    return all;
+}
+
+// Throughput of one pipeline, shared by all benchmark threads
+static void BM_Pipeline(benchmark::State& state, const std::string& name, const LoggerMaker& make)
+{
+    static std::unique_ptr<SilencedConsole> console;
+    static std::unique_ptr<ILogger> logger;
+    if (state.thread_index() == 0) {
+        console = std::make_unique<SilencedConsole>();
+        logger = make(benchFile(name));
+    }
+    for (auto _ : state) {
+        logger->log(LogLevel::Info, Message);
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        logger.reset();
+        console.reset();
+        removeBenchFile(name);
+    }
+}
+
+// Cost of a record that LevelFilterDecorator rejects
+static void BM_FilteredOut(benchmark::State& state)
+{
+    auto logger = LoggerFactory::createFileLoggerWithLevelFilter(benchFile("filtered"));
+    logger->setMinLevel(LogLevel::Warning);
+    for (auto _ : state) {
+        logger->log(LogLevel::Debug, Message);
+    }
+    state.SetItemsProcessed(state.iterations());
+    logger.reset();
+    removeBenchFile("filtered");
+}
+BENCHMARK(BM_FilteredOut);
+
+// Cost of a rejected record through the isEnabled() check of the logging macros
+static void BM_FilteredOutMacro(benchmark::State& state)
+{
+    auto logger = LoggerFactory::createFileLoggerWithLevelFilter(benchFile("filtered_macro"));
+    logger->setMinLevel(LogLevel::Warning);
+    int value = 42;
+    for (auto _ : state) {
+        CPPLOGGER_DEBUG(logger, "value {}", value);
+    }
+    state.SetItemsProcessed(state.iterations());
+    logger.reset();
+    removeBenchFile("filtered_macro");
+}
+BENCHMARK(BM_FilteredOutMacro);
+
+// Binary logging of a formatted record, for comparison with the text pipelines
+static void BM_BinaryLogger(benchmark::State& state)
+{
+    static std::unique_ptr<BinaryLogger> logger;
+    if (state.thread_index() == 0) {
+        logger = std::make_unique<BinaryLogger>(benchFile("binary"));
+    }
+    int milliseconds = 42;
+    for (auto _ : state) {
+        CPPLOGGER_BINARY_LOG(logger, LogLevel::Info, "request handled in {} ms for user {}", milliseconds, 1234);
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        logger.reset();
+        removeBenchFile("binary");
+    }
+}
+BENCHMARK(BM_BinaryLogger)->ThreadRange(1, 8)->UseRealTime();
+
+// Throughput of a statically composed pipeline, for comparison with its decorator chain
+template <typename Fused>
+static void BM_Fused(benchmark::State& state, const std::string& name)
+{
+    SilencedConsole console;
+    std::unique_ptr<Fused> logger;
+    if constexpr (std::is_same_v<Fused, ConsolePipelineWithLevel>) {
+        logger = std::make_unique<Fused>();
+    } else {
+        logger = std::make_unique<Fused>(benchFile(name));
+    }
+    for (auto _ : state) {
+        logger->log(LogLevel::Info, Message);
+    }
+    state.SetItemsProcessed(state.iterations());
+    logger.reset();
+    removeBenchFile(name);
+}
+
+// Per-call latency percentiles of one pipeline on a single thread
+static void BM_Latency(benchmark::State& state, const std::string& name, const LoggerMaker& make)
+{
+    SilencedConsole console;
+    std::unique_ptr<ILogger> logger = make(benchFile(name + "_latency"));
+    std::vector<std::int64_t> samples;
+    samples.reserve(1 << 20);
+    for (auto _ : state) {
+        auto started = std::chrono::steady_clock::now();
+        logger->log(LogLevel::Info, Message);
+        auto elapsed = std::chrono::steady_clock::now() - started;
+        if (samples.size() < samples.capacity()) {
+            samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+    }
+    logger.reset();
+    removeBenchFile(name + "_latency");
+
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double fraction) {
+        return samples.empty() ? 0.0 : static_cast<double>(samples[static_cast<std::size_t>(fraction * (samples.size() - 1))]);
+    };
+    state.counters["p50_ns"] = percentile(0.50);
+    state.counters["p99_ns"] = percentile(0.99);
+    state.counters["p999_ns"] = percentile(0.999);
+    state.SetItemsProcessed(state.iterations());
+}
+
+static const int registered = [] {
+    int maxThreads = static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+    for (const PipelineCase& pipeline : pipelines()) {
+        auto* throughput = benchmark::RegisterBenchmark(("BM_Pipeline/" + pipeline.name).c_str(), BM_Pipeline, pipeline.name, pipeline.make);
+        throughput->UseRealTime();
+        if (pipeline.threadSafe) {
+            throughput->ThreadRange(1, maxThreads);
+        }
+        benchmark::RegisterBenchmark(("BM_Latency/" + pipeline.name).c_str(), BM_Latency, pipeline.name, pipeline.make);
+    }
+    benchmark::RegisterBenchmark("BM_Fused/ConsoleWithLevel", BM_Fused<ConsolePipelineWithLevel>, std::string("fused_console"));
+    benchmark::RegisterBenchmark("BM_Fused/FileWithLevelFilter", BM_Fused<FilePipelineWithLevelFilter>, std::string("fused_filter"));
+    benchmark::RegisterBenchmark("BM_Fused/BufferedFileWithLevelFilter", BM_Fused<BufferedFilePipelineWithLevelFilter>, std::string("fused_buffered_filter"));
+    benchmark::RegisterBenchmark("BM_Fused/FileWithLevelAndTimestamp", BM_Fused<FilePipelineWithLevelAndTimestamp>, std::string("fused_timestamp"));
+    benchmark::RegisterBenchmark("BM_Fused/BufferedFileWithLevelAndTimestamp", BM_Fused<BufferedFilePipelineWithLevelAndTimestamp>, std::string("fused_buffered_timestamp"));
+    return 0;
+}();
+
+BENCHMARK_MAIN();
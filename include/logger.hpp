@@ -4,14 +4,63 @@
  */
 
 #pragma once
+#include <atomic>
 #include <chrono>
 #include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <condition_variable>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <initializer_list>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <iomanip>
 #include <fstream>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define CPPLOGGER_HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(CPPLOGGER_HAVE_ZLIB)
+#include <zlib.h>
+#endif
 
 // Log Level
 enum class LogLevel {
@@ -23,320 +72,8947 @@ enum class LogLevel {
     Noise
 };
 
+// Lock-free bounded ring buffer
 /**
- * @brief Represents a network service for sending messages.
+ * @brief A bounded, lock-free multi-producer queue backed by a fixed ring of cells.
+ *
+ * Every cell carries a sequence number that tells producers and consumers whether it is free
+ * or holds a published value, so producers only contend on a single atomic cursor and never
+ * take a lock. tryPop() is safe to call from several threads as well, but the loggers in this
+ * file drain each ring from one background thread.
+ *
+ * @tparam T The element type. It must be default constructible and move assignable.
  */
-class NetworkService {
+template <typename T>
+class LockFreeRingBuffer {
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    static constexpr std::size_t CacheLineSize = 64;
+
+    std::unique_ptr<Cell[]> cells; /**< The ring storage, sized to a power of two. */
+    std::size_t mask;              /**< capacity - 1, used to map positions to cells. */
+    alignas(CacheLineSize) std::atomic<std::size_t> enqueuePos{0};
+    alignas(CacheLineSize) std::atomic<std::size_t> dequeuePos{0};
+
+    static std::size_t roundUpToPowerOfTwo(std::size_t value) {
+        std::size_t result = 2;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
 public:
     /**
-     * @brief Constructs a NetworkService object with the specified service URL.
-     * 
-     * @param serviceUrl The URL of the network service.
+     * @brief Constructs a ring buffer that can hold at least the specified number of elements.
+     *
+     * @param capacity The minimum capacity. It is rounded up to the next power of two.
      */
-    NetworkService(const std::string& serviceUrl) {}
+    explicit LockFreeRingBuffer(std::size_t capacity)
+        : cells(new Cell[roundUpToPowerOfTwo(capacity)]), mask(roundUpToPowerOfTwo(capacity) - 1) {
+        for (std::size_t i = 0; i <= mask; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    LockFreeRingBuffer(const LockFreeRingBuffer&) = delete;
+    LockFreeRingBuffer& operator=(const LockFreeRingBuffer&) = delete;
 
     /**
-     * @brief Sends a message through the network service.
-     * 
-     * @param message The message to be sent.
+     * @brief Attempts to append a value without blocking.
+     *
+     * @param value The value to be moved into the ring. It is left untouched if the ring is full.
+     * @return true if the value was enqueued, false if the ring is full.
      */
-    void send(const std::string& message) {}
-};
+    bool tryPush(T& value) {
+        std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
 
-/**
- * @brief The ILogger class is an interface for logging messages with different log levels.
- */
-class ILogger {
-public:
-    virtual ~ILogger() = default;
+    /**
+     * @brief Attempts to remove the oldest published value without blocking.
+     *
+     * @param value Receives the dequeued value.
+     * @return true if a value was dequeued, false if no published value is available.
+     */
+    bool tryPop(T& value) {
+        std::size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = std::move(cell.value);
+                    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
 
     /**
-     * @brief Logs a message with the specified log level.
-     * 
-     * @param level The log level of the message.
-     * @param message The message to be logged.
+     * @brief Returns the number of elements the ring can hold.
      */
-    virtual void log(LogLevel level, const std::string& message) = 0;
-};
+    std::size_t capacity() const {
+        return mask + 1;
+    }
 
-/**
- * @brief Interface for output strategies.
- * 
- * This interface defines the contract for output strategies in the logger module.
- * Any class that implements this interface must provide an implementation for the
- * output() function, which is responsible for outputting a message.
- */
-class IOutputStrategy {
-public:
     /**
-     * @brief Virtual destructor.
+     * @brief Returns the total number of positions claimed by producers so far.
+     *
+     * Claimed positions may not be published yet, so this is an upper bound on what a
+     * consumer can dequeue.
      */
-    virtual ~IOutputStrategy() = default;
+    std::size_t pushedCount() const {
+        return enqueuePos.load(std::memory_order_acquire);
+    }
 
     /**
-     * @brief Outputs a message.
-     * 
-     * This function is responsible for outputting the given message.
-     * 
-     * @param message The message to be outputted.
+     * @brief Returns an approximate number of queued elements.
      */
-    virtual void output(const std::string& message) = 0;
+    std::size_t size() const {
+        std::size_t head = dequeuePos.load(std::memory_order_relaxed);
+        std::size_t tail = enqueuePos.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
 };
 
 /**
-    * @brief Outputs the given message to the console.
-    * 
-    * @param message The message to be outputted.
-    */
-class ConsoleOutput : public IOutputStrategy {
-public:
-    void output(const std::string& message) override {
-        std::cout << message << std::endl;
-    }
+ * @brief What a producer does when the bounded queue it writes to is full.
+ */
+enum class OverflowPolicy {
+    Block,            /**< Wait until the consumer frees space. */
+    DropNewest,       /**< Discard the record that did not fit and count it as dropped. */
+    BlockWithTimeout, /**< Wait up to the block timeout, then discard the record. */
+    OverwriteOldest,  /**< Discard the oldest queued record to make room for the new one. */
+    ShedByLevel       /**< Discard verbose records early as the queue fills; Error and Fatal always wait. */
 };
 
 /**
- * @brief A class that represents a file output strategy for logging.
+ * @brief The size of a bounded queue and what happens when it is full.
+ */
+struct QueueOptions {
+    std::size_t capacity = 8192;                            /**< Records that can wait for the consumer. */
+    OverflowPolicy overflowPolicy = OverflowPolicy::Block;  /**< What happens when the queue is full. */
+    std::chrono::microseconds blockTimeout{1000};           /**< How long BlockWithTimeout waits for space. */
+};
+
+/**
+ * @brief The outcome of offering a record to a bounded queue.
+ */
+struct EnqueueResult {
+    bool queued = false;        /**< Whether the record went into the queue. */
+    std::size_t evicted = 0;    /**< Older records OverwriteOldest removed to make room. */
+};
+
+/**
+ * @brief Returns true if ShedByLevel drops a record of the specified level at this queue depth.
  * 
- * This class inherits from the IOutputStrategy interface and provides
- * functionality to output log messages to a file.
+ * Noise and Debug records are dropped once the queue is half full and Info records once it is
+ * three quarters full. More severe records are only subject to the queue being full.
+ * 
+ * @param level The level of the record.
+ * @param depth How much of the queue is in use.
+ * @param capacity The size of the queue, in the same unit as depth.
  */
-class FileOutput : public IOutputStrategy {
-private:
-    std::ofstream file;
-public:
-    /**
-     * @brief Constructs a FileOutput object with the specified filename.
-     * 
-     * @param filename The name of the file to output log messages to.
-     * @throws std::runtime_error if the file cannot be opened.
-     */
-    FileOutput(const std::string& filename) : file(filename, std::ios::app) {
-        if (!file) {
-            throw std::runtime_error("Unable to open file");
+inline bool shedsEarly(LogLevel level, std::size_t depth, std::size_t capacity) {
+    return (level >= LogLevel::Debug && depth >= capacity / 2) || (level == LogLevel::Info && depth >= capacity / 4 * 3);
+}
+
+/**
+ * @brief Pushes a value into a bounded queue, following an overflow policy when it is full.
+ * 
+ * ShedByLevel sheds in steps: Noise and Debug records are dropped once the queue is half full,
+ * Info records once it is three quarters full, Warning records when it is full, and Error and
+ * Fatal records wait for space. The caller counts what was not queued or was evicted.
+ * 
+ * @param queue The queue.
+ * @param value The value to push. It is moved from if it is queued.
+ * @param level The level of the record, used by ShedByLevel.
+ * @param policy The overflow policy.
+ * @param blockTimeout How long BlockWithTimeout waits.
+ * @param wake Called while waiting, to make sure the consumer is draining.
+ */
+template <typename T, typename Wake>
+EnqueueResult enqueueWithPolicy(LockFreeRingBuffer<T>& queue, T& value, LogLevel level, OverflowPolicy policy,
+                                std::chrono::microseconds blockTimeout, Wake&& wake) {
+    EnqueueResult result;
+    if (policy == OverflowPolicy::ShedByLevel) {
+        if (shedsEarly(level, queue.size(), queue.capacity())) {
+            return result;
         }
+        policy = level <= LogLevel::Error ? OverflowPolicy::Block : OverflowPolicy::DropNewest;
     }
-
-    /**
-     * @brief Outputs the specified message to the file.
-     * 
-     * @param message The log message to be outputted.
-     */
-    void output(const std::string& message) override {
-        file << message << std::endl;
+    std::chrono::steady_clock::time_point deadline{};
+    while (!queue.tryPush(value)) {
+        if (policy == OverflowPolicy::DropNewest) {
+            return result;
+        }
+        if (policy == OverflowPolicy::OverwriteOldest) {
+            T oldest;
+            if (queue.tryPop(oldest)) {
+                ++result.evicted;
+            }
+            continue;
+        }
+        if (policy == OverflowPolicy::BlockWithTimeout) {
+            auto now = std::chrono::steady_clock::now();
+            if (deadline == std::chrono::steady_clock::time_point{}) {
+                deadline = now + blockTimeout;
+            } else if (now >= deadline) {
+                return result;
+            }
+        }
+        wake();
+        std::this_thread::yield();
     }
-};
+    result.queued = true;
+    wake();
+    return result;
+}
 
+// Per-thread storage
 /**
- * @brief A class that represents an output strategy for sending log messages to a network service.
+ * @brief Gives every thread its own instance of T, owned by the PerThread object.
  * 
- * This class inherits from the IOutputStrategy interface and uses a NetworkService object to send messages to a network service.
+ * local() returns the calling thread's instance, creating it on first use. The lookup is a
+ * thread_local cache hit in the common case of one PerThread object per type being used
+ * repeatedly, and a short scan otherwise, so hot paths can keep per-thread state without
+ * locking. The instances stay alive until the PerThread object is destroyed, even when their
+ * thread exits, so forEach() can still reach whatever a finished thread left behind. When a
+ * thread exits, its instance is handed to the next thread that needs one, so the number of
+ * instances is bounded by the number of threads alive at once rather than ever created.
+ * 
+ * @tparam T The per-thread type. It must be default constructible.
  */
-class NetworkOutput : public IOutputStrategy {
+template <typename T>
+class PerThread {
 private:
-    NetworkService networkService; /**< The NetworkService object used to send messages to a network service. */
-public:
     /**
-     * @brief Constructs a NetworkOutput object with the specified service URL.
-     * 
-     * @param serviceUrl The URL of the network service.
+     * @brief The state that threads reach at exit, which may be after the PerThread is gone.
      */
-    NetworkOutput(const std::string& serviceUrl) : networkService(serviceUrl) {}
+    struct Shared {
+        std::mutex mutex;
+        bool alive = true;       /**< Cleared by the destructor, guarded by mutex. */
+        std::vector<T*> idle;    /**< Instances of exited threads, guarded by mutex. */
+    };
+
+    struct LastEntry {
+        std::uint64_t owner = 0;
+        T* value = nullptr;
+    };
+
+    struct CacheEntry {
+        std::uint64_t owner = 0;
+        T* value = nullptr;
+        std::weak_ptr<Shared> shared;
+    };
 
     /**
-     * @brief Sends the specified message to the network service.
-     * 
-     * @param message The log message to be sent.
+     * @brief The instances of the calling thread, given back to their objects at thread exit.
      */
-    void output(const std::string& message) override {
-        networkService.send(message);
+    struct ThreadEntries {
+        std::vector<CacheEntry> entries;
+
+        ~ThreadEntries() {
+            last = LastEntry();
+            for (CacheEntry& entry : entries) {
+                std::shared_ptr<Shared> shared = entry.shared.lock();
+                if (shared) {
+                    std::lock_guard<std::mutex> lock(shared->mutex);
+                    if (shared->alive) {
+                        shared->idle.push_back(entry.value);
+                    }
+                }
+            }
+        }
+    };
+
+    static inline thread_local LastEntry last;
+
+    const std::uint64_t id = nextId();
+    std::shared_ptr<Shared> shared = std::make_shared<Shared>();
+    std::vector<std::unique_ptr<T>> values; /**< Guarded by shared->mutex. */
+
+    static std::uint64_t nextId() {
+        static std::atomic<std::uint64_t> counter{0};
+        return counter.fetch_add(1, std::memory_order_relaxed) + 1;
     }
-};
 
-// Composite Output Strategy
-/**
- * @brief A class that represents a multi-output strategy for logging.
- * 
- * This class inherits from the IOutputStrategy interface and allows multiple output strategies to be used simultaneously.
- * When the `output` function is called, it forwards the log message to all the registered output strategies.
- */
-class MultiOutput : public IOutputStrategy {
-private:
-    std::vector<std::unique_ptr<IOutputStrategy>> outputs; /**< The vector of output strategies. */
 public:
+    PerThread() = default;
+    PerThread(const PerThread&) = delete;
+    PerThread& operator=(const PerThread&) = delete;
+
+    ~PerThread() {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        shared->alive = false;
+    }
+
     /**
-     * @brief Constructs a MultiOutput object with the given output strategies.
-     * 
-     * @param outputs The vector of output strategies.
+     * @brief Returns the calling thread's instance, creating it or taking over the instance of an
+     * exited thread on first use.
      */
-    MultiOutput(std::vector<std::unique_ptr<IOutputStrategy>> outputs) : outputs(std::move(outputs)) {}
+    T& local() {
+        if (last.owner == id) {
+            return *last.value;
+        }
+        // Entries of destroyed PerThread objects are never matched again, since ids are not reused
+        static thread_local ThreadEntries owned;
+        for (const CacheEntry& entry : owned.entries) {
+            if (entry.owner == id) {
+                last = LastEntry{entry.owner, entry.value};
+                return *entry.value;
+            }
+        }
+        T* value;
+        {
+            std::lock_guard<std::mutex> lock(shared->mutex);
+            if (!shared->idle.empty()) {
+                value = shared->idle.back();
+                shared->idle.pop_back();
+            } else {
+                values.push_back(std::make_unique<T>());
+                value = values.back().get();
+            }
+        }
+        owned.entries.push_back(CacheEntry{id, value, shared});
+        last = LastEntry{id, value};
+        return *value;
+    }
 
     /**
-     * @brief Outputs the log message to all the registered output strategies.
+     * @brief Calls a function for the instance of every thread that has used this object.
      * 
-     * @param message The log message to be outputted.
+     * The function runs while new instances are locked out, and must do its own synchronization
+     * with the threads that own the instances.
+     * 
+     * @param function Called as function(T&) for every instance.
      */
-    void output(const std::string& message) override {
-        for (auto& output : outputs) {
-            output->output(message);
+    template <typename Function>
+    void forEach(Function&& function) {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        for (const std::unique_ptr<T>& value : values) {
+            function(*value);
         }
     }
 };
 
+// Compile-time minimum log level
 /**
- * @brief The base class for logger decorators.
+ * @brief The most verbose log level compiled into the program, as an integer LogLevel value.
  * 
- * This class is derived from the ILogger interface and provides a common base for all logger decorators.
- * Logger decorators can be used to add additional functionality to an existing logger.
+ * Define CPPLOGGER_MIN_LEVEL (the CMake cache variable of the same name does this for the
+ * cpplogger target) to strip more verbose calls made through the CPPLOGGER_LOG macros at
+ * compile time. The default keeps every level.
  */
-class ILoggerDecorator : public ILogger {
-protected:
-    std::unique_ptr<ILogger> logger;
-public:
-    /**
-     * @brief Constructs an ILoggerDecorator object with the specified logger.
-     * 
-     * @param logger The logger to be decorated.
-     */
-    ILoggerDecorator(std::unique_ptr<ILogger> logger) : logger(std::move(logger)) {}
+#ifndef CPPLOGGER_MIN_LEVEL
+#define CPPLOGGER_MIN_LEVEL 5
+#endif
 
-    /**
-     * @brief Default destructor.
-     */
-    virtual ~ILoggerDecorator() = default;
-};
+constexpr LogLevel CompiledMinLevel = static_cast<LogLevel>(CPPLOGGER_MIN_LEVEL); /**< The compile-time minimum log level. */
 
-// Level Logger Decorator class
 /**
- * @brief Decorator class that adds log level information to the log message.
+ * @brief Returns true if calls at the specified level survive a compile-time minimum level.
+ * 
+ * @param level The log level of the call.
+ * @param minLevel The compile-time minimum level. Default is CompiledMinLevel.
  */
-class LogLevelDecorator : public ILoggerDecorator {
-public:
-    /**
-     * @brief Constructs a LogLevelDecorator object with the specified logger.
-     * @param logger The logger to be decorated.
-     */
-    LogLevelDecorator(std::unique_ptr<ILogger> logger) : ILoggerDecorator(std::move(logger)) {}
+constexpr bool isLevelCompiledIn(LogLevel level, LogLevel minLevel = CompiledMinLevel) {
+    return static_cast<int>(level) <= static_cast<int>(minLevel);
+}
 
-    /**
-     * @brief Logs the message with the specified log level.
-     * @param level The log level.
-     * @param message The log message.
-     */
-    void log(LogLevel level, const std::string& message) override {
-        // Add log level to message
-        std::string leveledMessage = "[" + std::to_string(static_cast<int>(level)) + "] " + message;
-        logger->log(level, leveledMessage);
+// Message formatting
+/**
+ * @brief Appends the text form of a formatting argument to a string.
+ * 
+ * Integers and floating point numbers are converted with std::to_chars, strings are appended
+ * as they are (a char array up to its first null character), and any other type that can be written to a std::ostream goes through
+ * operator<<.
+ * 
+ * @param out The string to append to.
+ * @param value The argument to format.
+ */
+template <typename T>
+void appendFormatted(std::string& out, const T& value) {
+    using Type = std::decay_t<T>;
+    if constexpr (std::is_same_v<Type, bool>) {
+        out.append(value ? "true" : "false");
+    } else if constexpr (std::is_same_v<Type, char>) {
+        out.push_back(value);
+    } else if constexpr (std::is_arithmetic_v<Type>) {
+        char buffer[64];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, result.ptr);
+    } else if constexpr (std::is_array_v<T> && std::is_same_v<std::remove_cv_t<std::remove_extent_t<T>>, char>) {
+        out.append(value, std::find(value, value + std::extent_v<T>, '\0'));
+    } else if constexpr (std::is_same_v<Type, const char*> || std::is_same_v<Type, char*>) {
+        out.append(value != nullptr ? value : "(null)");
+    } else if constexpr (std::is_convertible_v<const Type&, std::string_view>) {
+        out.append(std::string_view(value));
+    } else if constexpr (std::is_enum_v<Type>) {
+        appendFormatted(out, static_cast<std::underlying_type_t<Type>>(value));
+    } else if constexpr (std::is_pointer_v<Type>) {
+        char buffer[2 + 2 * sizeof(void*)] = {'0', 'x'};
+        auto result = std::to_chars(buffer + 2, buffer + sizeof(buffer), reinterpret_cast<std::uintptr_t>(value), 16);
+        out.append(buffer, result.ptr);
+    } else {
+        std::ostringstream stream;
+        stream << value;
+        out.append(stream.str());
     }
-};
+}
 
-// Level Filter Logger Decorator class
 /**
- * @brief Decorator class that filters log messages based on the minimum log level.
+ * @brief Expands the "{}" placeholders of a format string, appending the result to a string.
  * 
- * The LevelFilterDecorator class is a concrete implementation of the ILoggerDecorator interface.
- * It decorates an ILogger object and filters log messages based on the minimum log level specified.
- * Log messages with a level lower than or equal to the minimum log level will be passed to the decorated logger.
+ * This is the parser behind formatMessage(). It is separate so that arguments only known at
+ * run time, such as those read back from a binary log, are formatted by exactly the same rules.
+ * 
+ * @param out The string to append to.
+ * @param format The format string.
+ * @param argumentCount The number of arguments available.
+ * @param appendArgument Called as appendArgument(out, index) to append the argument at index.
  */
-class LevelFilterDecorator : public ILoggerDecorator {
-private:
-    LogLevel minLevel; /**< The minimum log level for filtering log messages. */
+template <typename Appender>
+void formatPlaceholders(std::string& out, std::string_view format, std::size_t argumentCount, Appender&& appendArgument) {
+    std::size_t nextArgument = 0;
+    std::size_t i = 0;
+    while (i < format.size()) {
+        char c = format[i];
+        if ((c == '{' || c == '}') && i + 1 < format.size() && format[i + 1] == c) {
+            out.push_back(c);
+            i += 2;
+            continue;
+        }
+        if (c == '{') {
+            std::size_t close = format.find('}', i);
+            if (close != std::string_view::npos) {
+                std::string_view spec = format.substr(i + 1, close - i - 1);
+                std::size_t index = nextArgument;
+                bool valid = spec.empty();
+                if (!valid) {
+                    auto result = std::from_chars(spec.data(), spec.data() + spec.size(), index);
+                    valid = result.ec == std::errc() && result.ptr == spec.data() + spec.size();
+                } else {
+                    ++nextArgument;
+                }
+                if (valid && index < argumentCount) {
+                    appendArgument(out, index);
+                    i = close + 1;
+                    continue;
+                }
+            }
+        }
+        out.push_back(c);
+        ++i;
+    }
+}
+
+/**
+ * @brief Formats a message with "{}" placeholders and appends it to a string.
+ * 
+ * Each "{}" is replaced by the next argument and "{N}" by the argument at index N. "{{" and
+ * "}}" produce literal braces. Placeholders without a matching argument are copied verbatim.
+ * 
+ * @param out The string to append to.
+ * @param format The format string.
+ * @param args The arguments to substitute.
+ */
+template <typename... Args>
+void formatMessage(std::string& out, std::string_view format, const Args&... args) {
+    using Appender = void (*)(std::string&, const void*);
+    const void* values[sizeof...(Args) + 1] = {static_cast<const void*>(&args)..., nullptr};
+    const Appender appenders[sizeof...(Args) + 1] = {
+        [](std::string& text, const void* value) { appendFormatted(text, *static_cast<const Args*>(value)); }...,
+        nullptr};
+    formatPlaceholders(out, format, sizeof...(Args), [&values, &appenders](std::string& text, std::size_t index) {
+        appenders[index](text, values[index]);
+    });
+}
+
+// Structured fields
+/**
+ * @brief A key-value pair attached to a log record.
+ * 
+ * Fields are built on the caller's stack and hold views of the key and of string values, so
+ * attaching them to a record never allocates. Integers, floating point numbers, booleans and
+ * single characters are stored by value; anything convertible to std::string_view is referenced. Like the
+ * message, a field is only valid for the duration of the log call.
+ */
+class LogField {
 public:
     /**
-     * @brief Constructs a LevelFilterDecorator object with the specified logger and minimum log level.
-     * 
-     * @param logger The logger to be decorated.
-     * @param minLevel The minimum log level for filtering log messages. Default is LogLevel::Info.
+     * @brief The kind of value a field holds.
      */
-    LevelFilterDecorator(std::unique_ptr<ILogger> logger, LogLevel minLevel = LogLevel::Info) 
-        : ILoggerDecorator(std::move(logger)), minLevel(minLevel) {}
+    enum class Type : std::uint8_t {
+        Int,
+        UInt,
+        Double,
+        Bool,
+        Char,
+        String
+    };
+
+    std::string_view key;       /**< The name of the field. */
+    Type type = Type::String;   /**< Which of the members below holds the value. */
+    union {
+        std::int64_t intValue;
+        std::uint64_t uintValue;
+        double doubleValue;
+        bool boolValue;
+        char charValue;
+    };
+    std::string_view stringValue; /**< The value of a String field. */
 
     /**
-     * @brief Logs a message with the specified log level, if it meets the minimum log level requirement.
-     * 
-     * This function checks if the specified log level is lower than or equal to the minimum log level.
-     * If it is, the log message is passed to the decorated logger for logging.
-     * 
-     * @param level The log level of the message.
-     * @param message The log message to be logged.
+     * @brief Constructs an empty String field, so that arrays of fields can be declared.
      */
-    void log(LogLevel level, const std::string& message) override {
-        if (static_cast<int>(level) <= static_cast<int>(minLevel)) {
-            logger->log(level, message);
-        }
-    }
+    LogField() : uintValue(0) {}
 
     /**
-     * @brief Sets the minimum log level for filtering log messages.
+     * @brief Constructs a field from a key and a value.
      * 
-     * @param newMinLevel The new minimum log level to be set.
+     * @param key The name of the field. It is referenced, not copied.
+     * @param value The value. Strings are referenced, everything else is copied.
      */
-    void setMinLevel(LogLevel newMinLevel) {
-        minLevel = newMinLevel;
+    template <typename T>
+    LogField(std::string_view key, const T& value) : key(key), uintValue(0) {
+        using Value = std::decay_t<T>;
+        if constexpr (std::is_same_v<Value, bool>) {
+            type = Type::Bool;
+            boolValue = value;
+        } else if constexpr (std::is_same_v<Value, char>) {
+            type = Type::Char;
+            charValue = value;
+        } else if constexpr (std::is_integral_v<Value> && std::is_signed_v<Value>) {
+            type = Type::Int;
+            intValue = value;
+        } else if constexpr (std::is_integral_v<Value>) {
+            type = Type::UInt;
+            uintValue = value;
+        } else if constexpr (std::is_floating_point_v<Value>) {
+            type = Type::Double;
+            doubleValue = static_cast<double>(value);
+        } else if constexpr (std::is_enum_v<Value>) {
+            type = Type::Int;
+            intValue = static_cast<std::int64_t>(value);
+        } else if constexpr (std::is_same_v<Value, const char*> || std::is_same_v<Value, char*>) {
+            stringValue = value != nullptr ? std::string_view(value) : std::string_view("(null)");
+        } else {
+            static_assert(std::is_convertible_v<const Value&, std::string_view>,
+                          "LogField values must be numbers, booleans or convertible to std::string_view");
+            stringValue = std::string_view(value);
+        }
     }
 };
 
-// Timestamp Logger Decorator class
 /**
- * @brief Decorator class that adds a timestamp to log messages.
+ * @brief A view of the fields attached to a record.
+ */
+struct LogFields {
+    const LogField* data = nullptr;
+    std::size_t count = 0;
+
+    const LogField* begin() const { return data; }
+    const LogField* end() const { return data + count; }
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+};
+
+/**
+ * @brief An owned copy of the fields of a record, for loggers that keep records past the log call.
  * 
- * This class inherits from the ILoggerDecorator interface and wraps an existing ILogger object.
- * It adds a timestamp to the log messages before forwarding them to the wrapped logger.
+ * The keys and string values are copied into one block on the heap, which stays put when the
+ * copy is moved, so the views inside the copied fields remain valid while it sits in a queue.
+ * Records without fields copy nothing and allocate nothing.
  */
-class TimestampDecorator : public ILoggerDecorator {
+class LogFieldCopy {
 public:
+    LogFieldCopy() = default;
+
     /**
-     * @brief Constructs a TimestampDecorator object with the specified logger.
-     * 
-     * @param logger The logger object to be wrapped.
+     * @brief Takes over the storage of other, leaving it empty and without capacity.
      */
-    TimestampDecorator(std::unique_ptr<ILogger> logger) : ILoggerDecorator(std::move(logger)) {}
+    LogFieldCopy(LogFieldCopy&& other) noexcept
+        : fields(std::move(other.fields)), text(std::move(other.text)), textCapacity(std::exchange(other.textCapacity, 0)) {
+        other.fields.clear();
+    }
+
+    LogFieldCopy& operator=(LogFieldCopy&& other) noexcept {
+        fields = std::move(other.fields);
+        text = std::move(other.text);
+        textCapacity = std::exchange(other.textCapacity, 0);
+        other.fields.clear();
+        return *this;
+    }
 
     /**
-     * @brief Logs a message with the specified log level and adds a timestamp to it.
+     * @brief Replaces the contents with a copy of the specified fields.
      * 
-     * @param level The log level of the message.
-     * @param message The message to be logged.
+     * @param source The fields to copy.
      */
-    void log(LogLevel level, const std::string& message) override {
-        // Get current time
-        auto now = std::chrono::system_clock::now();
-        std::time_t now_c = std::chrono::system_clock::to_time_t(now);
-        std::stringstream timestamp;
-        timestamp << std::put_time(std::localtime(&now_c), "%F %T");
-
-        // Add timestamp to message
-        std::string timestampedMessage = "[" + timestamp.str() + "] " + message;
-        logger->log(level, timestampedMessage);
+    void assign(LogFields source) {
+        fields.clear();
+        if (source.empty()) {
+            return;
+        }
+        std::size_t textSize = 0;
+        for (const LogField& field : source) {
+            textSize += field.key.size() + (field.type == LogField::Type::String ? field.stringValue.size() : 0);
+        }
+        if (textSize > textCapacity) {
+            text = std::make_unique<char[]>(textSize);
+            textCapacity = textSize;
+        }
+        char* next = text.get();
+        auto copy = [&next](std::string_view view) {
+            if (view.empty()) {
+                return std::string_view();
+            }
+            std::memcpy(next, view.data(), view.size());
+            std::string_view copied(next, view.size());
+            next += view.size();
+            return copied;
+        };
+        fields.assign(source.begin(), source.end());
+        for (LogField& field : fields) {
+            field.key = copy(field.key);
+            if (field.type == LogField::Type::String) {
+                field.stringValue = copy(field.stringValue);
+            }
+        }
     }
-};
 
-// Logger with output strategy
+    /**
+     * @brief Returns a view of the copied fields.
+     */
+    LogFields view() const {
+        return LogFields{fields.data(), fields.size()};
+    }
+
+private:
+    std::vector<LogField> fields;
+    std::unique_ptr<char[]> text;
+    std::size_t textCapacity = 0;
+};
+
+// Log Record
+/**
+ * @brief Identifies a call site of the CPPLOGGER_LOG macros by its address.
+ * 
+ * The macros declare one as a function-local static per call site and pass it to
+ * ILogger::log(), which stores its address in LogRecord::site.
+ */
+struct LogSite {
+    char unused = 0; /**< Gives every site an address of its own. */
+};
+
+/**
+ * @brief A single log event as it travels from the caller to the output strategy.
+ * 
+ * The record refers to the caller's message instead of copying it, and keeps the level and
+ * timestamp as separate fields. Decorators annotate the record in place: they set fields and
+ * prepend their text into a fixed block of headroom in front of the message, so a chain of any
+ * depth builds its prefix without allocating. Text prepended later appears first, which keeps
+ * the output of a decorator chain identical to what nested string concatenation produced.
+ * Only the output strategy at the end of the chain serializes the record, once.
+ * 
+ * The message view is only valid for the duration of the log call; anything that keeps a
+ * record around (such as AsyncLogger) must copy it.
+ */
+class LogRecord {
+public:
+    static constexpr std::size_t PrefixCapacity = 128; /**< Bytes of inline headroom for prefixes. */
+
+    /**
+     * @brief Renders a deferred message: appends the formatted text of the arguments to out.
+     */
+    using MessageFormatter = void (*)(std::string& out, std::string_view format, const void* arguments);
+
+    LogLevel level;                                    /**< The log level of the record. */
+    std::chrono::system_clock::time_point time{};      /**< When the record was stamped, or the epoch if it was not. */
+    std::string_view message;                          /**< The caller's message without any prefix, or the format string of a deferred message. */
+    LogFields fields;                                  /**< Structured fields attached by the caller, referenced like the message. */
+    bool bypassFilters = false;                        /**< Set on records replayed by FlightRecorderDecorator; filters let them through. */
+    const LogSite* site = nullptr;                     /**< The call site, for records logged through the CPPLOGGER_LOG macros. */
+
+    /**
+     * @brief Constructs a record for the specified level and message.
+     * 
+     * @param level The log level of the record.
+     * @param message The message. It is referenced, not copied.
+     */
+    LogRecord(LogLevel level, std::string_view message) : level(level), message(message) {}
+
+    /**
+     * @brief Turns the message into a deferred one that is formatted only when it is serialized.
+     * 
+     * @param messageFormatter The function that renders the message from its arguments.
+     * @param messageArguments The arguments, owned by the caller for the duration of the log call.
+     */
+    void defer(MessageFormatter messageFormatter, const void* messageArguments) {
+        formatter = messageFormatter;
+        arguments = messageArguments;
+    }
+
+    /**
+     * @brief Returns true if the message still has to be formatted from its arguments.
+     */
+    bool isDeferred() const {
+        return formatter != nullptr;
+    }
+
+    /**
+     * @brief Appends the message text, formatting a deferred message, to a string.
+     * 
+     * @param out The string to append to.
+     */
+    void appendMessageTo(std::string& out) const {
+        if (formatter != nullptr) {
+            formatter(out, message, arguments);
+        } else {
+            out.append(message);
+        }
+    }
+
+    /**
+     * @brief Returns the message text, formatting a deferred message into scratch if needed.
+     * 
+     * @param scratch A buffer that holds the formatted text of a deferred message.
+     * @return A view of the message text, valid until scratch or the record changes.
+     */
+    std::string_view messageText(std::string& scratch) const {
+        if (formatter == nullptr) {
+            return message;
+        }
+        scratch.clear();
+        formatter(scratch, message, arguments);
+        return scratch;
+    }
+
+    /**
+     * @brief Returns true if a timestamp has been attached to the record.
+     */
+    bool hasTime() const {
+        return time != std::chrono::system_clock::time_point{};
+    }
+
+    /**
+     * @brief Prepends text in front of any prefix added so far.
+     * 
+     * The text is copied into the inline headroom. Only if the accumulated prefix outgrows the
+     * headroom does the record fall back to a heap-allocated prefix.
+     * 
+     * @param text The text to prepend.
+     */
+    void prepend(std::string_view text) {
+        if (prefixOverflow.empty() && text.size() <= prefixStart) {
+            prefixStart -= text.size();
+            std::memcpy(prefixBuffer + prefixStart, text.data(), text.size());
+            return;
+        }
+        if (prefixOverflow.empty()) {
+            prefixOverflow.assign(prefixBuffer + prefixStart, PrefixCapacity - prefixStart);
+        }
+        prefixOverflow.insert(0, text.data(), text.size());
+    }
+
+    /**
+     * @brief Returns the text prepended by decorators so far.
+     */
+    std::string_view prefix() const {
+        if (!prefixOverflow.empty()) {
+            return prefixOverflow;
+        }
+        return std::string_view(prefixBuffer + prefixStart, PrefixCapacity - prefixStart);
+    }
+
+    /**
+     * @brief Returns the length of the serialized record, without a line terminator.
+     * 
+     * For a deferred message this is only an estimate, based on the length of the format string.
+     */
+    std::size_t size() const {
+        return prefix().size() + message.size();
+    }
+
+    /**
+     * @brief Appends the serialized record (prefix followed by message) to a string.
+     * 
+     * @param out The string to append to.
+     */
+    void appendTo(std::string& out) const {
+        out.append(prefix());
+        appendMessageTo(out);
+    }
+
+    /**
+     * @brief Returns the serialized record as a new string.
+     */
+    std::string str() const {
+        std::string text;
+        text.reserve(size());
+        appendTo(text);
+        return text;
+    }
+
+private:
+    char prefixBuffer[PrefixCapacity];
+    std::size_t prefixStart = PrefixCapacity;
+    std::string prefixOverflow;
+    MessageFormatter formatter = nullptr;
+    const void* arguments = nullptr;
+};
+
+/**
+ * @brief An owned copy of a LogRecord, for loggers and outputs that keep records past the log call.
+ * 
+ * The prefix and the formatted message are kept back to back in one string and the fields in a
+ * LogFieldCopy, so the record rebuilt by materialize() has the same level, time, prefix,
+ * message and fields as the original and serializes to the same text.
+ */
+class StoredRecord {
+public:
+    LogLevel level = LogLevel::Info;                   /**< The log level of the record. */
+    std::chrono::system_clock::time_point time;        /**< The timestamp of the record. */
+    bool bypassFilters = false;                        /**< Whether filters let the record through. */
+
+    StoredRecord() = default;
+
+    /**
+     * @brief Constructs a copy of the specified record.
+     * 
+     * @param record The record to copy. A deferred message is formatted.
+     */
+    explicit StoredRecord(const LogRecord& record) {
+        assign(record);
+    }
+
+    /**
+     * @brief Replaces the contents with a copy of the specified record.
+     * 
+     * @param record The record to copy. A deferred message is formatted.
+     */
+    void assign(const LogRecord& record) {
+        level = record.level;
+        time = record.time;
+        bypassFilters = record.bypassFilters;
+        text.clear();
+        text.reserve(record.size());
+        record.appendTo(text);
+        prefixLength = record.prefix().size();
+        fields.assign(record.fields);
+    }
+
+    /**
+     * @brief Returns the serialized record, prefix followed by message.
+     */
+    std::string_view str() const {
+        return text;
+    }
+
+    /**
+     * @brief Rebuilds a LogRecord that refers to this copy.
+     * 
+     * The returned record is valid as long as this object is neither modified nor destroyed.
+     */
+    LogRecord materialize() const {
+        std::string_view view(text);
+        LogRecord record(level, view.substr(prefixLength));
+        record.time = time;
+        record.bypassFilters = bypassFilters;
+        record.prepend(view.substr(0, prefixLength));
+        record.fields = fields.view();
+        return record;
+    }
+
+private:
+    std::string text;
+    std::size_t prefixLength = 0;
+    LogFieldCopy fields;
+};
+
+// Record pool
+/**
+ * @brief A pool of fixed-size slabs that queued records are stored in, recycled per thread.
+ * 
+ * Every producer thread allocates from a free list of its own, so taking a slab needs no
+ * atomic operation and never calls malloc once the pool has warmed up. A slab remembers the
+ * thread it came from, and whoever releases it (usually the consumer of a queue) pushes it back
+ * onto that thread's return stack with one compare-and-swap; the producer takes the whole stack
+ * back in one exchange when its free list runs dry. New slabs are only allocated while the
+ * number of records in flight is still growing. The cache of a thread that exits, with its
+ * slabs and those still in flight, is taken over by the next thread that starts producing, so
+ * short-lived threads do not each leave slabs behind.
+ * 
+ * The slabs live until the pool is destroyed. Every PooledRecord must be released first.
+ */
+class RecordPool {
+public:
+    static constexpr std::size_t DefaultSlabSize = 512; /**< Default bytes of text a slab holds inline. */
+
+    /**
+     * @brief Constructs a pool whose slabs hold the specified number of bytes of text.
+     * 
+     * @param slabSize Bytes of prefix and message a slab holds; longer records spill to the heap.
+     */
+    explicit RecordPool(std::size_t slabSize = DefaultSlabSize) : slabSize(slabSize) {}
+
+    RecordPool(const RecordPool&) = delete;
+    RecordPool& operator=(const RecordPool&) = delete;
+
+    /**
+     * @brief Returns the number of slabs allocated so far.
+     */
+    std::uint64_t slabCount() const {
+        return slabs.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the number of records that were too long for a slab.
+     */
+    std::uint64_t spillCount() const {
+        return spills.load(std::memory_order_relaxed);
+    }
+
+private:
+    friend class PooledRecord;
+
+    struct Cache;
+
+    struct Slab {
+        Cache* owner;
+        Slab* next = nullptr;
+        std::atomic<std::uint32_t> references{0};
+        LogLevel level = LogLevel::Info;
+        bool bypassFilters = false;
+        std::chrono::system_clock::time_point time;
+        std::size_t prefixLength = 0;
+        std::size_t length = 0;
+        std::unique_ptr<char[]> spill;
+        LogFieldCopy fields;
+
+        explicit Slab(Cache* owner) : owner(owner) {}
+
+        char* inlineText() {
+            return reinterpret_cast<char*>(this + 1);
+        }
+
+        const char* text() const {
+            return spill ? spill.get() : reinterpret_cast<const char*>(this + 1);
+        }
+    };
+
+    struct Cache {
+        Slab* free = nullptr;                    /**< Only touched by the owning thread. */
+        std::atomic<Slab*> returned{nullptr};    /**< Pushed by any thread, taken by the owner. */
+        std::vector<std::unique_ptr<char[]>> memory;
+
+        ~Cache() {
+            for (auto& block : memory) {
+                reinterpret_cast<Slab*>(block.get())->~Slab();
+            }
+        }
+    };
+
+    std::size_t slabSize;
+    PerThread<Cache> caches;
+    std::atomic<std::uint64_t> slabs{0};
+    std::atomic<std::uint64_t> spills{0};
+
+    Slab* acquire() {
+        Cache& cache = caches.local();
+        if (cache.free == nullptr) {
+            cache.free = cache.returned.exchange(nullptr, std::memory_order_acquire);
+        }
+        Slab* slab = cache.free;
+        if (slab != nullptr) {
+            cache.free = slab->next;
+            return slab;
+        }
+        cache.memory.push_back(std::make_unique<char[]>(sizeof(Slab) + slabSize));
+        slabs.fetch_add(1, std::memory_order_relaxed);
+        return new (cache.memory.back().get()) Slab(&cache);
+    }
+
+    static void release(Slab* slab) {
+        slab->spill.reset();
+        Cache* owner = slab->owner;
+        Slab* head = owner->returned.load(std::memory_order_relaxed);
+        do {
+            slab->next = head;
+        } while (!owner->returned.compare_exchange_weak(head, slab, std::memory_order_release, std::memory_order_relaxed));
+    }
+};
+
+/**
+ * @brief A reference-counted handle to a copy of a LogRecord stored in a RecordPool slab.
+ * 
+ * Copying the handle shares the stored record, so a fan-out can queue one copy for many
+ * consumers; the slab goes back to the thread that filled it when the last handle is released.
+ * The prefix and message are copied into the slab, or into a heap spill buffer if they do not
+ * fit. Fields are copied into a LogFieldCopy that stays with the slab, so its storage is reused
+ * as well.
+ */
+class PooledRecord {
+public:
+    PooledRecord() = default;
+
+    /**
+     * @brief Copies a record into a slab of the specified pool.
+     * 
+     * @param record The record to copy. A deferred message is formatted.
+     * @param pool The pool to take the slab from.
+     */
+    PooledRecord(const LogRecord& record, RecordPool& pool) : slab(pool.acquire()) {
+        slab->references.store(1, std::memory_order_relaxed);
+        slab->level = record.level;
+        slab->bypassFilters = record.bypassFilters;
+        slab->time = record.time;
+        std::string_view prefix = record.prefix();
+        std::string_view message = record.message;
+        if (record.isDeferred()) {
+            static thread_local std::string formatted;
+            formatted.clear();
+            record.appendMessageTo(formatted);
+            message = formatted;
+        }
+        slab->prefixLength = prefix.size();
+        slab->length = prefix.size() + message.size();
+        char* text = slab->inlineText();
+        if (slab->length > pool.slabSize) {
+            slab->spill = std::make_unique<char[]>(slab->length);
+            text = slab->spill.get();
+            pool.spills.fetch_add(1, std::memory_order_relaxed);
+        }
+        std::memcpy(text, prefix.data(), prefix.size());
+        std::memcpy(text + prefix.size(), message.data(), message.size());
+        slab->fields.assign(record.fields);
+    }
+
+    PooledRecord(const PooledRecord& other) noexcept : slab(other.slab) {
+        if (slab != nullptr) {
+            slab->references.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    PooledRecord(PooledRecord&& other) noexcept : slab(other.slab) {
+        other.slab = nullptr;
+    }
+
+    PooledRecord& operator=(PooledRecord other) noexcept {
+        std::swap(slab, other.slab);
+        return *this;
+    }
+
+    ~PooledRecord() {
+        reset();
+    }
+
+    /**
+     * @brief Drops this handle; the last one returns the slab to its pool.
+     */
+    void reset() {
+        if (slab != nullptr && slab->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            RecordPool::release(slab);
+        }
+        slab = nullptr;
+    }
+
+    /**
+     * @brief Rebuilds a LogRecord that refers to the stored copy.
+     * 
+     * The returned record is valid as long as this handle holds the copy.
+     */
+    LogRecord materialize() const {
+        std::string_view text(slab->text(), slab->length);
+        LogRecord record(slab->level, text.substr(slab->prefixLength));
+        record.time = slab->time;
+        record.bypassFilters = slab->bypassFilters;
+        record.prepend(text.substr(0, slab->prefixLength));
+        record.fields = slab->fields.view();
+        return record;
+    }
+
+    /**
+     * @brief Returns the serialized record, prefix followed by message.
+     */
+    std::string_view str() const {
+        return std::string_view(slab->text(), slab->length);
+    }
+
+private:
+    RecordPool::Slab* slab = nullptr;
+};
+
+// Telemetry
+/**
+ * @brief A counter that many threads can increment without sharing a cache line.
+ * 
+ * Increments go to one of a few cache-line sized stripes, picked per thread, with a relaxed
+ * add; reading sums the stripes. The total is exact once the incrementing threads are quiet
+ * and a close approximation while they run.
+ */
+class StripedCounter {
+public:
+    static constexpr std::size_t Stripes = 8; /**< Number of independent stripes. */
+
+    /**
+     * @brief Adds to the counter.
+     * 
+     * @param amount The amount to add.
+     * @param order The memory order of the increment; counters used for statistics keep the default.
+     */
+    void add(std::uint64_t amount = 1, std::memory_order order = std::memory_order_relaxed) {
+        stripes[stripeIndex()].value.fetch_add(amount, order);
+    }
+
+    /**
+     * @brief Returns the current total.
+     * 
+     * @param order The memory order of the loads of the stripes.
+     */
+    std::uint64_t load(std::memory_order order = std::memory_order_relaxed) const {
+        std::uint64_t total = 0;
+        for (const Stripe& stripe : stripes) {
+            total += stripe.value.load(order);
+        }
+        return total;
+    }
+
+private:
+    struct alignas(64) Stripe {
+        std::atomic<std::uint64_t> value{0};
+    };
+
+    Stripe stripes[Stripes];
+
+    static std::size_t stripeIndex() {
+        static std::atomic<std::size_t> nextThread{0};
+        static thread_local std::size_t index = nextThread.fetch_add(1, std::memory_order_relaxed) % Stripes;
+        return index;
+    }
+};
+
+/**
+ * @brief A histogram of latencies in power-of-two nanosecond buckets.
+ * 
+ * Bucket i counts samples below 2^i ns (and at least 2^(i-1) ns), so recording is a short
+ * scan and a relaxed increment. Percentiles are reported as the upper bound of their bucket, which
+ * is within a factor of two of the true value.
+ */
+class LatencyHistogram {
+public:
+    static constexpr std::size_t Buckets = 40; /**< Enough for latencies up to about 9 minutes. */
+
+    /**
+     * @brief A copy of the histogram at one point in time.
+     */
+    struct Snapshot {
+        std::uint64_t counts[Buckets] = {}; /**< Samples per bucket. */
+        std::uint64_t count = 0;            /**< Total number of samples. */
+
+        /**
+         * @brief Returns the latency, in nanoseconds, below which a fraction of the samples fall.
+         * 
+         * @param fraction The fraction of samples, for example 0.99.
+         * @return The upper bound of the bucket holding the percentile, or 0 without samples.
+         */
+        std::uint64_t percentile(double fraction) const {
+            if (count == 0) {
+                return 0;
+            }
+            auto rank = static_cast<std::uint64_t>(fraction * static_cast<double>(count - 1)) + 1;
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < Buckets; ++i) {
+                seen += counts[i];
+                if (seen >= rank) {
+                    return std::uint64_t{1} << i;
+                }
+            }
+            return std::uint64_t{1} << (Buckets - 1);
+        }
+    };
+
+    /**
+     * @brief Records one sample.
+     * 
+     * @param latency The measured latency.
+     */
+    void record(std::chrono::nanoseconds latency) {
+        auto nanoseconds = static_cast<std::uint64_t>(std::max<std::int64_t>(latency.count(), 0));
+        std::size_t bucket = 0;
+        while (bucket + 1 < Buckets && (std::uint64_t{1} << bucket) <= nanoseconds) {
+            ++bucket;
+        }
+        counts[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns a copy of the current counts.
+     */
+    Snapshot snapshot() const {
+        Snapshot copy;
+        for (std::size_t i = 0; i < Buckets; ++i) {
+            copy.counts[i] = counts[i].load(std::memory_order_relaxed);
+            copy.count += copy.counts[i];
+        }
+        return copy;
+    }
+
+private:
+    std::atomic<std::uint64_t> counts[Buckets] = {};
+};
+
+/**
+ * @brief A snapshot of the telemetry of an output strategy or logger.
+ * 
+ * Fields that do not apply to the component they were taken from stay zero.
+ */
+struct TelemetrySnapshot {
+    std::uint64_t recordsIn = 0;       /**< Records accepted. */
+    std::uint64_t recordBytes = 0;     /**< Record text handed to write(), one newline each; see measuredWrite(). */
+    std::uint64_t recordsDropped = 0;  /**< Records discarded because a queue was full or a send failed. */
+    std::uint64_t recordsFiltered = 0; /**< Records rejected by a level filter. */
+    std::uint64_t queueDepth = 0;      /**< Records currently queued. */
+    std::uint64_t peakQueueDepth = 0;  /**< Most records seen queued at once. */
+    LatencyHistogram::Snapshot writeLatency; /**< Latency of writing one record. */
+    LatencyHistogram::Snapshot flushLatency; /**< Latency of a flush. */
+
+    /**
+     * @brief Calls a function with the name and value of every metric, for exporting.
+     * 
+     * Latencies are reported as p50, p99 and p999 in nanoseconds.
+     * 
+     * @param function Called as function(std::string_view name, std::uint64_t value).
+     */
+    template <typename Function>
+    void forEachMetric(Function&& function) const {
+        function("records_in", recordsIn);
+        function("record_bytes", recordBytes);
+        function("records_dropped", recordsDropped);
+        function("records_filtered", recordsFiltered);
+        function("queue_depth", queueDepth);
+        function("peak_queue_depth", peakQueueDepth);
+        function("write_latency_p50_ns", writeLatency.percentile(0.5));
+        function("write_latency_p99_ns", writeLatency.percentile(0.99));
+        function("write_latency_p999_ns", writeLatency.percentile(0.999));
+        function("flush_latency_p50_ns", flushLatency.percentile(0.5));
+        function("flush_latency_p99_ns", flushLatency.percentile(0.99));
+        function("flush_latency_p999_ns", flushLatency.percentile(0.999));
+    }
+};
+
+/**
+ * @brief Tracks the peak of a value that only one thread updates.
+ * 
+ * @param peak The peak so far.
+ * @param value The current value.
+ */
+inline void updatePeak(std::atomic<std::uint64_t>& peak, std::uint64_t value) {
+    if (value > peak.load(std::memory_order_relaxed)) {
+        peak.store(value, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief The ILogger class is an interface for logging messages with different log levels.
+ * 
+ * Every logger caches the most verbose level that can get through it and the loggers it wraps,
+ * so isEnabled() is a single relaxed load and compare no matter how deep the chain is. When a
+ * layer's own limit changes it recomputes its cache and asks the layer wrapping it to do the
+ * same, which keeps the outermost cache current.
+ */
+class ILogger {
+public:
+    virtual ~ILogger() = default;
+
+    /**
+     * @brief Returns true if a record at the specified level would get through this logger.
+     * 
+     * @param level The log level to check.
+     */
+    bool isEnabled(LogLevel level) const {
+        return static_cast<int>(level) <= enabledLevel.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Logs a message with the specified log level.
+     * 
+     * This is a thin wrapper that puts the message into a LogRecord and hands it to logRecord().
+     * Messages at a disabled level return before the record is built.
+     * 
+     * @param level The log level of the message.
+     * @param message The message to be logged.
+     */
+    void log(LogLevel level, const std::string& message) {
+        if (!isEnabled(level)) {
+            disabled.add();
+            return;
+        }
+        LogRecord record(level, message);
+        logRecord(record);
+    }
+
+    /**
+     * @brief Logs a message with structured fields attached.
+     * 
+     * The fields live on the caller's stack for the duration of the call, so attaching them does
+     * not allocate. Structured strategies such as JsonOutput write them as separate keys; text
+     * strategies print only the prefix and the message.
+     * 
+     * @param level The log level of the message.
+     * @param message The message to be logged.
+     * @param fields The fields, for example {{"user", id}, {"elapsed_ms", 42}}.
+     */
+    void log(LogLevel level, std::string_view message, std::initializer_list<LogField> fields) {
+        if (!isEnabled(level)) {
+            disabled.add();
+            return;
+        }
+        LogRecord record(level, message);
+        record.fields = LogFields{fields.begin(), fields.size()};
+        logRecord(record);
+    }
+
+    /**
+     * @brief Logs a message built from a format string and arguments.
+     * 
+     * The arguments are captured by reference and the message is only formatted, with
+     * formatMessage(), when an output strategy serializes the record. Records dropped by a
+     * filter never pay for the formatting.
+     * 
+     * @param level The log level of the message.
+     * @param format The format string, with "{}" placeholders.
+     * @param arg The first argument.
+     * @param args The remaining arguments.
+     */
+    template <typename Arg, typename... Args>
+    void log(LogLevel level, std::string_view format, const Arg& arg, const Args&... args) {
+        if (!isEnabled(level)) {
+            disabled.add();
+            return;
+        }
+        std::tuple<const Arg&, const Args&...> arguments(arg, args...);
+        LogRecord record(level, format);
+        record.defer(&formatArguments<Arg, Args...>, &arguments);
+        logRecord(record);
+    }
+
+    /**
+     * @brief Logs a message from a known call site, as the CPPLOGGER_LOG macros do.
+     * 
+     * @param site The call site, stored in LogRecord::site.
+     * @param level The log level of the message.
+     * @param message The message to be logged.
+     */
+    void log(const LogSite& site, LogLevel level, const std::string& message) {
+        if (!isEnabled(level)) {
+            disabled.add();
+            return;
+        }
+        LogRecord record(level, message);
+        record.site = &site;
+        logRecord(record);
+    }
+
+    /**
+     * @brief Logs a message with structured fields from a known call site.
+     * 
+     * @param site The call site, stored in LogRecord::site.
+     * @param level The log level of the message.
+     * @param message The message to be logged.
+     * @param fields The fields, referenced for the duration of the call.
+     */
+    void log(const LogSite& site, LogLevel level, std::string_view message, std::initializer_list<LogField> fields) {
+        if (!isEnabled(level)) {
+            disabled.add();
+            return;
+        }
+        LogRecord record(level, message);
+        record.site = &site;
+        record.fields = LogFields{fields.begin(), fields.size()};
+        logRecord(record);
+    }
+
+    /**
+     * @brief Logs a message built from a format string and arguments from a known call site.
+     * 
+     * @param site The call site, stored in LogRecord::site.
+     * @param level The log level of the message.
+     * @param format The format string, with "{}" placeholders.
+     * @param arg The first argument.
+     * @param args The remaining arguments.
+     */
+    template <typename Arg, typename... Args>
+    void log(const LogSite& site, LogLevel level, std::string_view format, const Arg& arg, const Args&... args) {
+        if (!isEnabled(level)) {
+            disabled.add();
+            return;
+        }
+        std::tuple<const Arg&, const Args&...> arguments(arg, args...);
+        LogRecord record(level, format);
+        record.site = &site;
+        record.defer(&formatArguments<Arg, Args...>, &arguments);
+        logRecord(record);
+    }
+
+    /**
+     * @brief Logs a record.
+     * 
+     * Decorators annotate the record in place and pass it on; loggers at the end of the chain
+     * hand it to their output strategy.
+     * 
+     * @param record The record to be logged.
+     */
+    virtual void logRecord(LogRecord& record) = 0;
+
+protected:
+    /**
+     * @brief Returns the most verbose level that can get through this logger, as an integer.
+     * 
+     * The default accepts every level. Decorators combine their own limit with the cached
+     * level of the logger they wrap.
+     */
+    virtual int computeEnabledLevel() const {
+        return static_cast<int>(LogLevel::Noise);
+    }
+
+    /**
+     * @brief Recomputes the cached enabled level of this logger and every logger wrapping it.
+     */
+    void refreshEnabledLevel() {
+        for (ILogger* layer = this; layer != nullptr; layer = layer->parent) {
+            layer->enabledLevel.store(layer->computeEnabledLevel(), std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Returns the mutex that serializes level changes, so concurrent refreshes of the
+     * same chain cannot leave a stale cache behind. Reading levels never takes it.
+     */
+    static std::mutex& levelChangeMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    /**
+     * @brief Counts a record that log() discarded because its level was disabled.
+     */
+    void countDisabled() {
+        disabled.add();
+    }
+
+    /**
+     * @brief Returns the number of records log() discarded, on this logger and every logger wrapping it.
+     */
+    std::uint64_t disabledCountThroughParents() const {
+        std::uint64_t total = 0;
+        for (const ILogger* layer = this; layer != nullptr; layer = layer->parent) {
+            total += layer->disabled.load();
+        }
+        return total;
+    }
+
+private:
+    friend class ILoggerDecorator;
+    friend class ReloadableLogger;
+
+    StripedCounter disabled; /**< Records discarded by the isEnabled() check of log(). */
+
+    ILogger* parent = nullptr; /**< The decorator wrapping this logger, if any. */
+    std::atomic<int> enabledLevel{static_cast<int>(LogLevel::Noise)}; /**< Cached result of computeEnabledLevel(). */
+
+    template <typename... Args>
+    static void formatArguments(std::string& out, std::string_view format, const void* arguments) {
+        const auto& values = *static_cast<const std::tuple<const Args&...>*>(arguments);
+        std::apply([&out, format](const Args&... args) { formatMessage(out, format, args...); }, values);
+    }
+};
+
+/**
+ * @brief Interface for output strategies.
+ * 
+ * This interface defines the contract for output strategies in the logger module.
+ * Any class that implements this interface must provide an implementation for the
+ * output() function, which is responsible for outputting a message.
+ */
+class IOutputStrategy {
+public:
+    /**
+     * @brief Virtual destructor.
+     */
+    virtual ~IOutputStrategy() = default;
+
+    /**
+     * @brief Outputs a message.
+     * 
+     * This function is responsible for outputting the given message.
+     * 
+     * @param message The message to be outputted.
+     */
+    virtual void output(const std::string& message) = 0;
+
+    /**
+     * @brief Outputs a log record.
+     * 
+     * This is what loggers call. The default implementation serializes the record into a string
+     * and calls output(). Strategies override it to serialize the record straight into their
+     * destination, or to react to fields such as the level.
+     * 
+     * @param record The record to be outputted.
+     */
+    virtual void write(const LogRecord& record) {
+        output(record.str());
+    }
+
+    /**
+     * @brief Writes out any messages the strategy is still holding in memory.
+     * 
+     * The default implementation does nothing, since unbuffered strategies have nothing to flush.
+     */
+    virtual void flush() {}
+
+    /**
+     * @brief Writes a record through write() and updates the telemetry of this strategy.
+     * 
+     * Loggers call this instead of write(). It counts the record and its size with relaxed
+     * atomics and times one in LatencySampleInterval writes, so the clock is rarely read.
+     * 
+     * The size is LogRecord::size() plus one newline. A deferred message is formatted by the
+     * strategy, so its format string is counted instead; the figure tracks the volume handed
+     * to the strategy, not the bytes it ends up writing.
+     * 
+     * @param record The record to be outputted.
+     */
+    void measuredWrite(const LogRecord& record) {
+        std::uint64_t sequence = telemetry.recordsIn.fetch_add(1, std::memory_order_relaxed);
+        telemetry.recordBytes.fetch_add(record.size() + 1, std::memory_order_relaxed);
+        if (sequence % LatencySampleInterval != 0) {
+            write(record);
+            return;
+        }
+        auto started = std::chrono::steady_clock::now();
+        write(record);
+        telemetry.writeLatency.record(std::chrono::steady_clock::now() - started);
+    }
+
+    /**
+     * @brief Calls flush() and records how long it took.
+     */
+    void measuredFlush() {
+        auto started = std::chrono::steady_clock::now();
+        flush();
+        telemetry.flushLatency.record(std::chrono::steady_clock::now() - started);
+    }
+
+    /**
+     * @brief Returns a snapshot of the telemetry of this strategy.
+     * 
+     * Strategies with a queue of their own override this to add drops and queue depth.
+     */
+    virtual TelemetrySnapshot stats() const {
+        return telemetry.snapshot();
+    }
+
+    static constexpr std::uint64_t LatencySampleInterval = 8; /**< One in this many writes is timed. */
+
+protected:
+    /**
+     * @brief The live counters behind stats().
+     */
+    struct Telemetry {
+        std::atomic<std::uint64_t> recordsIn{0};
+        std::atomic<std::uint64_t> recordBytes{0};
+        LatencyHistogram writeLatency;
+        LatencyHistogram flushLatency;
+
+        TelemetrySnapshot snapshot() const {
+            TelemetrySnapshot copy;
+            copy.recordsIn = recordsIn.load(std::memory_order_relaxed);
+            copy.recordBytes = recordBytes.load(std::memory_order_relaxed);
+            copy.writeLatency = writeLatency.snapshot();
+            copy.flushLatency = flushLatency.snapshot();
+            return copy;
+        }
+    };
+
+    Telemetry telemetry; /**< Updated by measuredWrite() and measuredFlush(). */
+};
+
+/**
+ * @brief Selects how a ConsoleOutput batches records before writing them.
+ */
+enum class ConsoleBuffering {
+    Auto,   /**< Line-buffer when the descriptor is a terminal, block-buffer otherwise. */
+    Line,   /**< Write every record as soon as it arrives. */
+    Block   /**< Collect records and write them in large blocks. */
+};
+
+/**
+ * @brief Configures a ConsoleOutput.
+ */
+struct ConsoleOptions {
+    ConsoleBuffering buffering = ConsoleBuffering::Auto;    /**< How records are batched. */
+    bool errorsToStderr = false;                            /**< Send Error and Fatal records to the error descriptor. */
+    std::size_t bufferSize = 64 * 1024;                     /**< Write once this many bytes are buffered. */
+    std::chrono::milliseconds flushInterval{1000};          /**< Longest time a record stays buffered. */
+    LogLevel flushLevel = LogLevel::Error;                  /**< Write immediately for this level and more severe ones. */
+    int outputFd = STDOUT_FILENO;                           /**< Descriptor for regular records. */
+    int errorFd = STDERR_FILENO;                            /**< Descriptor for Error and Fatal records when errorsToStderr is set. */
+};
+
+/**
+ * @brief Outputs log records to the console without going through iostreams.
+ * 
+ * Records are appended to a buffer per descriptor and handed to the operating system with
+ * plain write() calls; a record that does not fit is written together with the buffer in a
+ * single writev(). The buffer of a descriptor is shared by every ConsoleOutput writing to it,
+ * so records from different outputs keep the order in which they were logged. On a terminal
+ * every record is written immediately, while on a pipe or file the buffer is written when it is
+ * full, when a record at or above the flush level is written, and at the latest one flush
+ * interval after its first record arrived, by a background thread if no record comes along.
+ * 
+ * Buffered records are written after anything printed so far through std::cout, std::cerr or
+ * stdio, but text printed that way while records are buffered comes out ahead of them; use
+ * ConsoleBuffering::Line where the two must interleave exactly.
+ * 
+ * If std::cout (or std::cerr) has been redirected with rdbuf() away from the buffer it had at
+ * startup, records for that stream go through the stream instead, so code capturing console
+ * output that way keeps working.
+ */
+class ConsoleOutput : public IOutputStrategy {
+private:
+    /**
+     * @brief The buffer of one descriptor, shared by every ConsoleOutput writing to it.
+     */
+    struct Channel {
+        int fd = -1;
+        std::ostream* mirror = nullptr;     /**< The iostream writing to the same descriptor, if any. */
+        std::streambuf* original = nullptr; /**< The buffer of mirror at startup. */
+        std::FILE* stdioStream = nullptr;   /**< The stdio stream writing to the same descriptor, if any. */
+        std::mutex mutex;
+        std::string buffer;                 /**< Guarded by mutex. */
+        std::chrono::steady_clock::time_point deadline; /**< When buffer must be written, guarded by mutex. */
+    };
+
+    static inline std::streambuf* const originalCoutBuffer = std::cout.rdbuf();
+    static inline std::streambuf* const originalCerrBuffer = std::cerr.rdbuf();
+
+    static void writeAll(int fd, iovec* parts, int count) {
+        while (count > 0) {
+            ssize_t written = ::writev(fd, parts, count);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            auto remaining = static_cast<std::size_t>(written);
+            while (count > 0 && remaining >= parts->iov_len) {
+                remaining -= parts->iov_len;
+                ++parts;
+                --count;
+            }
+            if (count > 0) {
+                parts->iov_base = static_cast<char*>(parts->iov_base) + remaining;
+                parts->iov_len -= remaining;
+            }
+        }
+    }
+
+    /**
+     * @brief Writes the buffer of a channel, and optionally a record after it; mutex must be held.
+     */
+    static void drain(Channel& channel, std::string_view prefix = {}, std::string_view text = {}, bool withRecord = false) {
+        if (channel.mirror != nullptr) {
+            channel.mirror->flush(); // Anything already printed through the stream comes first
+        }
+        if (channel.stdioStream != nullptr) {
+            std::fflush(channel.stdioStream);
+        }
+        iovec parts[4];
+        int count = 0;
+        auto add = [&parts, &count](const char* data, std::size_t size) {
+            if (size > 0) {
+                parts[count].iov_base = const_cast<char*>(data);
+                parts[count].iov_len = size;
+                ++count;
+            }
+        };
+        add(channel.buffer.data(), channel.buffer.size());
+        if (withRecord) {
+            add(prefix.data(), prefix.size());
+            add(text.data(), text.size());
+            add("\n", 1);
+        }
+        writeAll(channel.fd, parts, count);
+        channel.buffer.clear();
+    }
+
+    /**
+     * @brief Owns the channels and the thread that writes buffers whose flush interval has elapsed.
+     * 
+     * The instance is created by the first ConsoleOutput, so it outlives every ConsoleOutput and
+     * writes whatever is still buffered when the program exits.
+     */
+    class Console {
+    public:
+        static Console& instance() {
+            static Console console;
+            return console;
+        }
+
+        ~Console() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+                condition.notify_one();
+            }
+            if (flusher.joinable()) {
+                flusher.join();
+            }
+            for (auto& channel : channels) {
+                std::lock_guard<std::mutex> lock(channel->mutex);
+                if (!channel->buffer.empty()) {
+                    drain(*channel);
+                }
+            }
+        }
+
+        Channel& channel(int fd) {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto& channel : channels) {
+                if (channel->fd == fd) {
+                    return *channel;
+                }
+            }
+            auto channel = std::make_unique<Channel>();
+            channel->fd = fd;
+            if (fd == STDOUT_FILENO) {
+                channel->mirror = &std::cout;
+                channel->original = originalCoutBuffer;
+                channel->stdioStream = stdout;
+            } else if (fd == STDERR_FILENO) {
+                channel->mirror = &std::cerr;
+                channel->original = originalCerrBuffer;
+                channel->stdioStream = stderr;
+            }
+            channels.push_back(std::move(channel));
+            return *channels.back();
+        }
+
+        /**
+         * @brief Tells the flusher that a channel has a new, earlier deadline.
+         */
+        void schedule() {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!flusher.joinable()) {
+                flusher = std::thread([this] { run(); });
+            }
+            rescheduled = true;
+            condition.notify_one();
+        }
+
+    private:
+        std::mutex mutex; /**< Guards channels and the flusher state; taken before a channel mutex. */
+        std::condition_variable condition;
+        std::vector<std::unique_ptr<Channel>> channels;
+        bool stopping = false;
+        bool rescheduled = false;
+        std::thread flusher;
+
+        Console() = default;
+
+        void run() {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stopping) {
+                auto now = std::chrono::steady_clock::now();
+                auto next = std::chrono::steady_clock::time_point::max();
+                for (auto& channel : channels) {
+                    std::lock_guard<std::mutex> channelLock(channel->mutex);
+                    if (channel->buffer.empty()) {
+                        continue;
+                    }
+                    if (channel->deadline <= now) {
+                        drain(*channel);
+                    } else {
+                        next = std::min(next, channel->deadline);
+                    }
+                }
+                auto woken = [this] { return stopping || rescheduled; };
+                if (next == std::chrono::steady_clock::time_point::max()) {
+                    condition.wait(lock, woken);
+                } else {
+                    condition.wait_until(lock, next, woken);
+                }
+                rescheduled = false;
+            }
+        }
+    };
+
+    ConsoleOptions options;
+    Channel& out;
+    Channel& err;
+    bool outLineBuffered;
+    bool errLineBuffered;
+    std::string scratch; /**< Holds the formatted text of deferred messages. */
+
+    bool lineBuffered(int fd) const {
+        return options.buffering == ConsoleBuffering::Line
+            || (options.buffering == ConsoleBuffering::Auto && ::isatty(fd) == 1);
+    }
+
+    static bool redirected(const Channel& channel) {
+        return channel.mirror != nullptr && channel.mirror->rdbuf() != channel.original;
+    }
+
+    static void flushChannel(Channel& channel) {
+        std::lock_guard<std::mutex> lock(channel.mutex);
+        if (!channel.buffer.empty()) {
+            drain(channel);
+        }
+    }
+
+    void emit(LogLevel level, std::string_view prefix, std::string_view text) {
+        bool toError = options.errorsToStderr && static_cast<int>(level) <= static_cast<int>(LogLevel::Error);
+        Channel& channel = toError ? err : out;
+        if (&out != &err) {
+            flushChannel(toError ? out : err); // Keep the order of records written to different descriptors
+        }
+        bool scheduleFlush = false;
+        {
+            std::lock_guard<std::mutex> lock(channel.mutex);
+            if (redirected(channel)) {
+                if (!channel.buffer.empty()) {
+                    drain(channel);
+                }
+                *channel.mirror << prefix << text << std::endl;
+                return;
+            }
+            std::size_t size = prefix.size() + text.size() + 1;
+            if (channel.buffer.size() + size > options.bufferSize) {
+                if (size >= options.bufferSize) {
+                    drain(channel, prefix, text, true);
+                    return;
+                }
+                drain(channel);
+            }
+            if (toError ? errLineBuffered : outLineBuffered) {
+                drain(channel, prefix, text, true);
+                return;
+            }
+            if (channel.buffer.empty()) {
+                channel.buffer.reserve(options.bufferSize);
+            }
+            channel.buffer.append(prefix);
+            channel.buffer.append(text);
+            channel.buffer.push_back('\n');
+            if (static_cast<int>(level) <= static_cast<int>(options.flushLevel)) {
+                drain(channel);
+                return;
+            }
+            auto now = std::chrono::steady_clock::now();
+            if (channel.buffer.size() == size || now + options.flushInterval < channel.deadline) {
+                channel.deadline = now + options.flushInterval;
+                scheduleFlush = true;
+            }
+        }
+        if (scheduleFlush) {
+            Console::instance().schedule();
+        }
+    }
+
+public:
+    /**
+     * @brief Constructs a ConsoleOutput object with the specified options.
+     * 
+     * @param options The descriptors, buffering mode and flush policy to use.
+     */
+    ConsoleOutput(ConsoleOptions options = ConsoleOptions())
+        : options(options), out(Console::instance().channel(options.outputFd)),
+          err(Console::instance().channel(options.errorFd)),
+          outLineBuffered(lineBuffered(options.outputFd)), errLineBuffered(lineBuffered(options.errorFd)) {}
+
+    /**
+     * @brief Writes any buffered records before the object is destroyed.
+     */
+    ~ConsoleOutput() override {
+        flush();
+    }
+
+    /**
+     * @brief Outputs the specified message to the console.
+     * 
+     * @param message The log message to be outputted.
+     */
+    void output(const std::string& message) override {
+        emit(LogLevel::Info, std::string_view(), message);
+    }
+
+    /**
+     * @brief Outputs the specified record, choosing the descriptor from its level.
+     * 
+     * @param record The log record to be outputted.
+     */
+    void write(const LogRecord& record) override {
+        emit(record.level, record.prefix(), record.messageText(scratch));
+    }
+
+    /**
+     * @brief Writes all buffered records of the descriptors of this output.
+     */
+    void flush() override {
+        flushChannel(out);
+        if (&out != &err) {
+            flushChannel(err);
+        }
+    }
+};
+
+/**
+ * @brief A class that represents a file output strategy for logging.
+ * 
+ * This class inherits from the IOutputStrategy interface and provides
+ * functionality to output log messages to a file.
+ */
+class FileOutput : public IOutputStrategy {
+private:
+    std::ofstream file;
+    std::string scratch; /**< Holds the formatted text of deferred messages. */
+public:
+    /**
+     * @brief Constructs a FileOutput object with the specified filename.
+     * 
+     * @param filename The name of the file to output log messages to.
+     * @throws std::runtime_error if the file cannot be opened.
+     */
+    FileOutput(const std::string& filename) : file(filename, std::ios::app) {
+        if (!file) {
+            throw std::runtime_error("Unable to open file");
+        }
+    }
+
+    /**
+     * @brief Outputs the specified message to the file.
+     * 
+     * @param message The log message to be outputted.
+     */
+    void output(const std::string& message) override {
+        file << message << std::endl;
+    }
+
+    /**
+     * @brief Outputs the specified record to the file.
+     * 
+     * @param record The log record to be outputted.
+     */
+    void write(const LogRecord& record) override {
+        file << record.prefix() << record.messageText(scratch) << std::endl;
+    }
+};
+
+/**
+ * @brief Controls when a BufferedFileOutput hands its buffer to the operating system.
+ */
+struct FlushPolicy {
+    std::size_t bufferSize = 64 * 1024;                     /**< Flush once this many bytes are buffered. */
+    std::chrono::milliseconds flushInterval{1000};          /**< Longest time a record stays buffered; IoUringFileOutput checks it when a message arrives. */
+    LogLevel flushLevel = LogLevel::Error;                  /**< Flush immediately for this level and more severe ones. */
+};
+
+/**
+ * @brief A file output strategy that collects messages in memory and writes them in large blocks.
+ * 
+ * Unlike FileOutput, which flushes the stream after every line, this class appends messages to
+ * an in-memory buffer and issues a single write when the FlushPolicy says so: when the buffer
+ * is full, when a message at or above the flush level is written, or at the latest one flush
+ * interval after the first buffered message arrived. A background thread, started with the
+ * first buffered message, writes the buffer at that deadline if no message comes along, so a
+ * burst followed by silence does not stay in memory; the buffer is guarded by a mutex it shares
+ * with the callers. The underlying stream is unbuffered, so every flush is exactly one write to
+ * the file. Anything still buffered is written on destruction.
+ */
+class BufferedFileOutput : public IOutputStrategy {
+private:
+    std::ofstream file;
+    FlushPolicy policy;
+    std::mutex mutex;
+    std::string buffer;                             /**< Guarded by mutex. */
+    std::chrono::steady_clock::time_point deadline; /**< When buffer must be written, guarded by mutex. */
+    std::condition_variable condition;
+    bool stopping = false;                          /**< Guarded by mutex. */
+    std::thread flusher;
+
+    /**
+     * @brief Writes the buffer to the file; mutex must be held.
+     */
+    void drain() {
+        if (!buffer.empty()) {
+            file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+
+    /**
+     * @brief Flushes or arms the deadline after a message was appended; mutex must be held.
+     * 
+     * @param wasEmpty True if the buffer was empty before the message.
+     * @param urgent True if the message must be written right away.
+     */
+    void appended(bool wasEmpty, bool urgent) {
+        if (urgent || buffer.size() >= policy.bufferSize) {
+            drain();
+            return;
+        }
+        if (wasEmpty) {
+            deadline = std::chrono::steady_clock::now() + policy.flushInterval;
+            if (!flusher.joinable()) {
+                flusher = std::thread([this] { run(); });
+            }
+            condition.notify_one();
+        }
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            if (buffer.empty()) {
+                condition.wait(lock);
+            } else if (std::chrono::steady_clock::now() >= deadline) {
+                drain();
+            } else {
+                condition.wait_until(lock, deadline);
+            }
+        }
+    }
+
+public:
+    /**
+     * @brief Constructs a BufferedFileOutput object with the specified filename and flush policy.
+     * 
+     * @param filename The name of the file to output log messages to.
+     * @param policy The policy that decides when buffered messages are written.
+     * @throws std::runtime_error if the file cannot be opened.
+     */
+    BufferedFileOutput(const std::string& filename, FlushPolicy policy = FlushPolicy()) : policy(policy) {
+        file.rdbuf()->pubsetbuf(nullptr, 0);
+        file.open(filename, std::ios::app);
+        if (!file) {
+            throw std::runtime_error("Unable to open file");
+        }
+        buffer.reserve(policy.bufferSize);
+    }
+
+    /**
+     * @brief Stops the background thread and writes any buffered messages before closing the file.
+     */
+    ~BufferedFileOutput() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            condition.notify_one();
+        }
+        if (flusher.joinable()) {
+            flusher.join();
+        }
+        flush();
+    }
+
+    /**
+     * @brief Buffers the specified message, flushing if the buffer is full.
+     * 
+     * @param message The log message to be outputted.
+     */
+    void output(const std::string& message) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        bool wasEmpty = buffer.empty();
+        buffer.append(message);
+        buffer.push_back('\n');
+        appended(wasEmpty, false);
+    }
+
+    /**
+     * @brief Buffers the specified record, flushing immediately if its level requires it.
+     * 
+     * @param record The log record to be outputted.
+     */
+    void write(const LogRecord& record) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        bool wasEmpty = buffer.empty();
+        record.appendTo(buffer);
+        buffer.push_back('\n');
+        appended(wasEmpty, static_cast<int>(record.level) <= static_cast<int>(policy.flushLevel));
+    }
+
+    /**
+     * @brief Writes all buffered messages to the file in a single write.
+     */
+    void flush() override {
+        std::lock_guard<std::mutex> lock(mutex);
+        drain();
+    }
+};
+
+/**
+ * @brief A file output strategy that hands its buffers to the kernel through io_uring.
+ * 
+ * Records are collected in one of two buffers that are registered with an io_uring instance.
+ * When the FlushPolicy says so, the full buffer is submitted as a single fixed-buffer write and
+ * filling continues in the other one, so the caller never waits for the disk unless both
+ * buffers are in flight. Completions are reaped before a buffer is reused; short writes are
+ * resubmitted and writes the ring rejects are finished with pwrite(). flush() submits the
+ * current buffer and waits until every write has completed.
+ * 
+ * Where io_uring is not available (other systems, old kernels, or a sandbox that forbids it),
+ * the same interface is served by a BufferedFileOutput.
+ */
+class IoUringFileOutput : public IOutputStrategy {
+private:
+    FlushPolicy policy;
+    std::unique_ptr<BufferedFileOutput> fallback;
+    std::string scratch; /**< Holds the formatted text of deferred messages. */
+
+#if defined(CPPLOGGER_HAVE_IO_URING)
+    struct Buffer {
+        char* data = nullptr;
+        std::size_t size = 0;       /**< Bytes filled so far. */
+        bool inFlight = false;
+        std::size_t submitted = 0;  /**< Bytes of the in-flight write that completed. */
+        std::uint64_t offset = 0;   /**< File offset of the in-flight write. */
+    };
+
+    static constexpr unsigned RingEntries = 8;
+
+    int fd = -1;
+    int ringFd = -1;
+    bool registered = false;
+    std::unique_ptr<char[]> memory;
+    Buffer buffers[2];
+    int active = 0;
+    std::uint64_t fileOffset = 0;
+    std::chrono::steady_clock::time_point lastFlush;
+
+    void* sqRing = MAP_FAILED;
+    void* cqRing = MAP_FAILED;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    std::size_t sqRingSize = 0;
+    std::size_t cqRingSize = 0;
+    std::size_t sqesSize = 0;
+    unsigned* sqTail = nullptr;
+    unsigned* sqMask = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned* cqMask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+
+    bool setupRing() {
+        io_uring_params params{};
+        ringFd = static_cast<int>(::syscall(__NR_io_uring_setup, RingEntries, &params));
+        if (ringFd < 0) {
+            return false;
+        }
+        sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMap) {
+            sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+        }
+        sqRing = ::mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+        if (sqRing == MAP_FAILED) {
+            return false;
+        }
+        cqRing = singleMap ? sqRing
+                           : ::mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED) {
+            return false;
+        }
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(
+            ::mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES));
+        if (sqes == MAP_FAILED) {
+            return false;
+        }
+        char* sq = static_cast<char*>(sqRing);
+        char* cq = static_cast<char*>(cqRing);
+        sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        // Registered buffers save the kernel from mapping the pages on every write; without
+        // them (for example under a low RLIMIT_MEMLOCK) plain writes are used instead
+        iovec vectors[2];
+        for (int i = 0; i < 2; ++i) {
+            vectors[i].iov_base = buffers[i].data;
+            vectors[i].iov_len = policy.bufferSize;
+        }
+        registered = ::syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_BUFFERS, vectors, 2) == 0;
+        return true;
+    }
+
+    void releaseRing() {
+        if (sqes != MAP_FAILED) {
+            ::munmap(sqes, sqesSize);
+        }
+        if (cqRing != MAP_FAILED && cqRing != sqRing) {
+            ::munmap(cqRing, cqRingSize);
+        }
+        if (sqRing != MAP_FAILED) {
+            ::munmap(sqRing, sqRingSize);
+        }
+        if (ringFd >= 0) {
+            ::close(ringFd);
+        }
+        ringFd = -1;
+    }
+
+    void submit(int index) {
+        Buffer& buffer = buffers[index];
+        unsigned tail = *sqTail;
+        unsigned slot = tail & *sqMask;
+        io_uring_sqe& sqe = sqes[slot];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = registered ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<std::uint64_t>(buffer.data + buffer.submitted);
+        sqe.len = static_cast<std::uint32_t>(buffer.size - buffer.submitted);
+        sqe.off = buffer.offset + buffer.submitted;
+        sqe.buf_index = static_cast<std::uint16_t>(index);
+        sqe.user_data = static_cast<std::uint64_t>(index);
+        sqArray[slot] = slot;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        long result;
+        do {
+            result = ::syscall(__NR_io_uring_enter, ringFd, 1, 0, 0, nullptr, 0);
+        } while (result < 0 && errno == EINTR);
+        if (result < 1) {
+            // The kernel took nothing (EBUSY, EAGAIN, ENOMEM...), so no completion will come:
+            // take the entry back and write the buffer here instead
+            __atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+            finishSynchronously(buffer);
+            retire(buffer);
+        }
+    }
+
+    static void retire(Buffer& buffer) {
+        buffer.size = 0;
+        buffer.submitted = 0;
+        buffer.inFlight = false;
+    }
+
+    void finishSynchronously(Buffer& buffer) {
+        while (buffer.submitted < buffer.size) {
+            ssize_t written = ::pwrite(fd, buffer.data + buffer.submitted, buffer.size - buffer.submitted,
+                                       static_cast<off_t>(buffer.offset + buffer.submitted));
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written <= 0) {
+                break;
+            }
+            buffer.submitted += static_cast<std::size_t>(written);
+        }
+    }
+
+    void complete(int index, int result) {
+        Buffer& buffer = buffers[index];
+        if (result == -EINTR || result == -EAGAIN) {
+            submit(index);
+            return;
+        }
+        if (result > 0) {
+            buffer.submitted += static_cast<std::size_t>(result);
+            if (buffer.submitted < buffer.size) {
+                submit(index);
+                return;
+            }
+        } else {
+            finishSynchronously(buffer);
+        }
+        retire(buffer);
+    }
+
+    void waitFor(int index) {
+        while (buffers[index].inFlight) {
+            unsigned head = *cqHead;
+            unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+            if (head == tail) {
+                ::syscall(__NR_io_uring_enter, ringFd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+                continue;
+            }
+            const io_uring_cqe& cqe = cqes[head & *cqMask];
+            auto completed = static_cast<int>(cqe.user_data);
+            int result = cqe.res;
+            __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+            complete(completed, result);
+        }
+    }
+
+    void submitActive() {
+        Buffer& buffer = buffers[active];
+        if (buffer.size == 0) {
+            return;
+        }
+        buffer.offset = fileOffset;
+        buffer.submitted = 0;
+        buffer.inFlight = true;
+        fileOffset += buffer.size;
+        submit(active);
+        active ^= 1;
+        waitFor(active); // Usually long done: it was submitted one buffer ago
+        lastFlush = std::chrono::steady_clock::now();
+    }
+
+    void append(std::string_view prefix, std::string_view text) {
+        std::size_t size = prefix.size() + text.size() + 1;
+        if (buffers[active].size + size > policy.bufferSize) {
+            submitActive();
+        }
+        if (size > policy.bufferSize) {
+            // Too large for a buffer: write it directly once everything before it is done
+            waitFor(active ^ 1);
+            std::string line;
+            line.reserve(size);
+            line.append(prefix).append(text).push_back('\n');
+            Buffer direct;
+            direct.data = line.data();
+            direct.size = line.size();
+            direct.offset = fileOffset;
+            fileOffset += line.size();
+            finishSynchronously(direct);
+            return;
+        }
+        Buffer& buffer = buffers[active];
+        std::memcpy(buffer.data + buffer.size, prefix.data(), prefix.size());
+        std::memcpy(buffer.data + buffer.size + prefix.size(), text.data(), text.size());
+        buffer.data[buffer.size + size - 1] = '\n';
+        buffer.size += size;
+    }
+
+    bool flushDue(LogLevel level) const {
+        return static_cast<int>(level) <= static_cast<int>(policy.flushLevel)
+            || buffers[active].size >= policy.bufferSize
+            || std::chrono::steady_clock::now() - lastFlush >= policy.flushInterval;
+    }
+#endif
+
+public:
+    /**
+     * @brief Constructs an IoUringFileOutput object with the specified filename and flush policy.
+     * 
+     * @param filename The name of the file to output log messages to. Records are appended.
+     * @param policy The size of each of the two buffers and when a buffer is submitted.
+     * @throws std::runtime_error if the file cannot be opened.
+     */
+    IoUringFileOutput(const std::string& filename, FlushPolicy policy = FlushPolicy()) : policy(policy) {
+        this->policy.bufferSize = std::max<std::size_t>(this->policy.bufferSize, 1);
+#if defined(CPPLOGGER_HAVE_IO_URING)
+        fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Unable to open file");
+        }
+        struct stat status{};
+        if (::fstat(fd, &status) == 0) {
+            fileOffset = static_cast<std::uint64_t>(status.st_size);
+        }
+        memory = std::make_unique<char[]>(2 * this->policy.bufferSize);
+        buffers[0].data = memory.get();
+        buffers[1].data = memory.get() + this->policy.bufferSize;
+        lastFlush = std::chrono::steady_clock::now();
+        if (setupRing()) {
+            return;
+        }
+        releaseRing();
+        ::close(fd);
+        fd = -1;
+#endif
+        fallback = std::make_unique<BufferedFileOutput>(filename, this->policy);
+    }
+
+    /**
+     * @brief Waits for every write, including the buffered records, before closing the file.
+     */
+    ~IoUringFileOutput() override {
+#if defined(CPPLOGGER_HAVE_IO_URING)
+        if (!fallback) {
+            flush();
+            releaseRing();
+            ::close(fd);
+        }
+#endif
+    }
+
+    IoUringFileOutput(const IoUringFileOutput&) = delete;
+    IoUringFileOutput& operator=(const IoUringFileOutput&) = delete;
+
+    /**
+     * @brief Returns true if writes go through io_uring, false if the BufferedFileOutput fallback is used.
+     */
+    bool usesIoUring() const {
+        return !fallback;
+    }
+
+    /**
+     * @brief Buffers the specified message, submitting the buffer if the policy says so.
+     * 
+     * @param message The log message to be outputted.
+     */
+    void output(const std::string& message) override {
+        if (fallback) {
+            fallback->output(message);
+            return;
+        }
+#if defined(CPPLOGGER_HAVE_IO_URING)
+        append(std::string_view(), message);
+        if (flushDue(LogLevel::Info)) {
+            submitActive();
+        }
+#endif
+    }
+
+    /**
+     * @brief Buffers the specified record, submitting the buffer if the policy says so.
+     * 
+     * @param record The log record to be outputted.
+     */
+    void write(const LogRecord& record) override {
+        if (fallback) {
+            fallback->write(record);
+            return;
+        }
+#if defined(CPPLOGGER_HAVE_IO_URING)
+        append(record.prefix(), record.messageText(scratch));
+        if (flushDue(record.level)) {
+            submitActive();
+        }
+#endif
+    }
+
+    /**
+     * @brief Submits the current buffer and waits until all writes have completed.
+     */
+    void flush() override {
+        if (fallback) {
+            fallback->flush();
+            return;
+        }
+#if defined(CPPLOGGER_HAVE_IO_URING)
+        submitActive();
+        waitFor(0);
+        waitFor(1);
+        lastFlush = std::chrono::steady_clock::now();
+#endif
+    }
+};
+
+/**
+ * @brief Writes a whole buffer to a file descriptor, retrying after partial writes and EINTR.
+ * 
+ * @param fd The file descriptor.
+ * @param data The bytes to write.
+ * @param size The number of bytes.
+ * @return false if a write failed.
+ */
+inline bool writeAll(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+        ssize_t result = ::write(fd, data, size);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += result;
+        size -= static_cast<std::size_t>(result);
+    }
+    return true;
+}
+
+/**
+ * @brief Settings of a DurableFileOutput.
+ */
+struct DurabilityOptions {
+    LogLevel durableLevel = LogLevel::Error;         /**< Records at this level or more severe are committed to stable storage. */
+    std::chrono::microseconds maxCommitDelay{2000};  /**< Longest a durable record waits for others to share its commit. */
+    std::chrono::milliseconds flushInterval{100};    /**< How often other records are written, without a sync. */
+    std::size_t maxBatchBytes = 1024 * 1024;         /**< Pending bytes that start a write before the delay elapses. */
+};
+
+/**
+ * @brief A file output strategy that commits audit records to stable storage in groups.
+ * 
+ * write() only appends the record to a pending buffer under a short lock. A committer thread
+ * writes the whole buffer with one write() and, when it holds a durable record, follows it
+ * with one fdatasync() before it wakes every waiter at once. A durable record waits at most
+ * maxCommitDelay for others to share its commit; while a commit is in progress the next batch
+ * builds up behind it, so one sync covers many records under load. Records below the durable
+ * level go into the same ordered stream but never force a sync: they are written every flush
+ * interval or when the batch reaches maxBatchBytes.
+ * 
+ * Every record gets a Token, a sequence number; wait() blocks until the record and everything
+ * before it is on stable storage. Callers going through a logger chain take pendingToken()
+ * after logging, which covers every record the output has received so far. Records still
+ * queued in an AsyncLogger in front of the output are not covered until they arrive.
+ */
+class DurableFileOutput : public IOutputStrategy {
+public:
+    /**
+     * @brief Identifies a record, or everything written up to it, for wait() and isCommitted().
+     */
+    struct Token {
+        std::uint64_t sequence = 0; /**< Position of the record in the file's record stream, from 1. */
+    };
+
+private:
+    DurabilityOptions options;
+    int fd = -1;
+    mutable std::mutex mutex;
+    std::condition_variable workCondition;
+    mutable std::condition_variable commitCondition;
+    std::string pending;                      /**< Records appended since the committer last took the buffer. */
+    std::string writing;                      /**< The batch the committer is writing; swapped with pending. */
+    std::uint64_t appended = 0;               /**< Sequence of the last appended record. */
+    std::uint64_t durableThrough = 0;         /**< Sequence of the last durable record. */
+    std::uint64_t syncRequestedThrough = 0;   /**< Sequence a waiter asked to be synced without delay. */
+    std::uint64_t flushRequestedThrough = 0;  /**< Sequence flush() asked to be written. */
+    std::uint64_t written = 0;                /**< Sequence of the last record handed to the kernel. */
+    std::uint64_t committed = 0;              /**< Sequence of the last record on stable storage. */
+    std::uint64_t failedThrough = 0;          /**< End of the last batch whose write or sync failed. */
+    std::uint64_t commits = 0;                /**< Number of syncs. */
+    bool durableWaiting = false;              /**< Whether pending holds a durable record. */
+    std::chrono::steady_clock::time_point firstDurable;
+    bool stopping = false;
+    std::thread committer;
+
+    bool syncDue() const {
+        return durableWaiting || syncRequestedThrough > committed;
+    }
+
+    Token append(const LogRecord& record, bool durable) {
+        std::lock_guard<std::mutex> lock(mutex);
+        record.appendTo(pending);
+        pending.push_back('\n');
+        Token token{++appended};
+        bool wake = pending.size() >= options.maxBatchBytes;
+        if (durable) {
+            durableThrough = token.sequence;
+            if (!durableWaiting) {
+                durableWaiting = true;
+                firstDurable = std::chrono::steady_clock::now();
+                wake = true;
+            }
+        }
+        if (wake) {
+            workCondition.notify_one();
+        }
+        return token;
+    }
+
+    void commit(std::unique_lock<std::mutex>& lock) {
+        bool sync = syncDue();
+        std::uint64_t through = appended;
+        writing.swap(pending);
+        durableWaiting = false;
+        lock.unlock();
+        bool succeeded = writeAll(fd, writing.data(), writing.size());
+        if (sync && ::fdatasync(fd) != 0) {
+            succeeded = false;
+        }
+        writing.clear();
+        lock.lock();
+        written = through;
+        if (!succeeded) {
+            failedThrough = through;
+        }
+        if (sync) {
+            committed = through;
+            ++commits;
+        }
+        commitCondition.notify_all();
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            workCondition.wait_for(lock, options.flushInterval, [this] {
+                return stopping || syncDue() || flushRequestedThrough > written || pending.size() >= options.maxBatchBytes;
+            });
+            if (durableWaiting && syncRequestedThrough <= committed && flushRequestedThrough <= written) {
+                workCondition.wait_until(lock, firstDurable + options.maxCommitDelay, [this] {
+                    return stopping || syncRequestedThrough > committed || flushRequestedThrough > written ||
+                           pending.size() >= options.maxBatchBytes;
+                });
+            }
+            if (!pending.empty() || syncDue()) {
+                commit(lock);
+            } else if (stopping) {
+                break;
+            }
+        }
+    }
+
+public:
+    /**
+     * @brief Opens the file for appending and starts the committer thread.
+     * 
+     * @param filename The name of the file to output log messages to.
+     * @param options Which records are durable and how long they wait to share a commit.
+     * @throws std::runtime_error if the file cannot be opened.
+     */
+    DurableFileOutput(const std::string& filename, DurabilityOptions options = DurabilityOptions()) : options(options) {
+        fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Unable to open file");
+        }
+        committer = std::thread([this] { run(); });
+    }
+
+    /**
+     * @brief Commits every pending record, including a final sync, before closing the file.
+     */
+    ~DurableFileOutput() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            syncRequestedThrough = appended;
+        }
+        workCondition.notify_one();
+        committer.join();
+        ::close(fd);
+    }
+
+    DurableFileOutput(const DurableFileOutput&) = delete;
+    DurableFileOutput& operator=(const DurableFileOutput&) = delete;
+
+    /**
+     * @brief Appends the specified message as a non-durable Info record.
+     * 
+     * @param message The log message to be outputted.
+     */
+    void output(const std::string& message) override {
+        append(LogRecord(LogLevel::Info, message), false);
+    }
+
+    /**
+     * @brief Appends the record; records at the durable level are scheduled for a commit.
+     * 
+     * @param record The log record to be outputted.
+     */
+    void write(const LogRecord& record) override {
+        append(record, static_cast<int>(record.level) <= static_cast<int>(options.durableLevel));
+    }
+
+    /**
+     * @brief Appends the record and schedules it for a commit, whatever its level.
+     * 
+     * @param record The log record to be outputted.
+     * @return The token to wait for.
+     */
+    Token writeDurable(const LogRecord& record) {
+        return append(record, true);
+    }
+
+    /**
+     * @brief Returns a token covering every record the output has received so far.
+     */
+    Token pendingToken() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return Token{appended};
+    }
+
+    /**
+     * @brief Blocks until the record of the token, and everything before it, is on stable storage.
+     * 
+     * A durable record is committed within the commit delay; waiting for any other record
+     * starts a commit right away.
+     * 
+     * @param token The token of the record.
+     * @return false if a write or sync failed for the record's batch or any later one, in which
+     * case the record may not be on stable storage.
+     */
+    bool wait(Token token) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (token.sequence > durableThrough && token.sequence > syncRequestedThrough) {
+            syncRequestedThrough = token.sequence;
+            workCondition.notify_one();
+        }
+        commitCondition.wait(lock, [this, token] { return committed >= token.sequence; });
+        return token.sequence > failedThrough;
+    }
+
+    /**
+     * @brief Returns true if the record of the token has been committed to stable storage.
+     * 
+     * @param token The token of the record.
+     */
+    bool isCommitted(Token token) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return committed >= token.sequence && token.sequence > failedThrough;
+    }
+
+    /**
+     * @brief Blocks until every record received so far has been written to the file, without a sync.
+     */
+    void flush() override {
+        std::unique_lock<std::mutex> lock(mutex);
+        std::uint64_t target = appended;
+        flushRequestedThrough = std::max(flushRequestedThrough, target);
+        workCondition.notify_one();
+        commitCondition.wait(lock, [this, target] { return written >= target; });
+    }
+
+    /**
+     * @brief Blocks until every record received so far is on stable storage.
+     * 
+     * @return false if a write or sync failed, as for wait().
+     */
+    bool sync() {
+        return wait(pendingToken());
+    }
+
+    /**
+     * @brief Returns the number of syncs, each of which committed a whole batch of records.
+     */
+    std::uint64_t commitCount() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return commits;
+    }
+};
+
+/**
+ * @brief A file output strategy that writes records into memory-mapped, preallocated segments.
+ * 
+ * Each segment is a file of fixed size ("<filename>.<index>") that is preallocated and mapped
+ * into memory. Writing a record reserves space with a single atomic add on the segment offset
+ * and copies the bytes in with memcpy, so any number of threads can write concurrently without
+ * locks and without a system call; the page cache writes the data back to disk. When a record
+ * does not fit, the segment is rolled: a new one is mapped, the old one is truncated to the
+ * bytes actually written once its last writer is done, and writing continues in the new one.
+ * The current segment is truncated the same way on destruction.
+ * 
+ * Until a segment is closed, its unused tail reads back as zero bytes.
+ */
+class MmapFileOutput : public IOutputStrategy {
+public:
+    static constexpr std::size_t DefaultSegmentSize = 16 * 1024 * 1024; /**< Default size of a segment in bytes. */
+
+private:
+    struct Segment {
+        std::string path;
+        int fd = -1;
+        char* data = nullptr;
+        std::size_t size = 0;
+        std::atomic<std::size_t> offset{0};    /**< Bytes reserved so far, possibly beyond size. */
+        std::atomic<std::size_t> end{0};       /**< Offset of the first reservation that did not fit. */
+        std::atomic<std::size_t> writers{0};   /**< Threads currently using the segment. */
+        std::size_t index = 0;
+    };
+
+    std::string filename;
+    std::size_t segmentSize;
+    std::size_t nextIndex = 0;
+    std::atomic<Segment*> current{nullptr};
+    std::atomic<std::size_t> entering{0}; /**< Threads between loading current and registering as its writer. */
+    std::vector<std::unique_ptr<Segment>> segments; /**< The current segment and closed ones late writers may still check. */
+    std::mutex rollMutex;
+
+    std::unique_ptr<Segment> openSegment(std::size_t size) {
+        auto segment = std::make_unique<Segment>();
+        segment->index = nextIndex;
+        segment->path = filename + "." + std::to_string(nextIndex++);
+        segment->size = size;
+        segment->end.store(size, std::memory_order_relaxed);
+        segment->fd = ::open(segment->path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (segment->fd < 0) {
+            throw std::runtime_error("Unable to open file");
+        }
+        if (::posix_fallocate(segment->fd, 0, static_cast<off_t>(size)) != 0
+            && ::ftruncate(segment->fd, static_cast<off_t>(size)) != 0) {
+            ::close(segment->fd);
+            throw std::runtime_error("Unable to allocate file segment");
+        }
+        void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, segment->fd, 0);
+        if (mapping == MAP_FAILED) {
+            ::close(segment->fd);
+            throw std::runtime_error("Unable to map file segment");
+        }
+        segment->data = static_cast<char*>(mapping);
+        return segment;
+    }
+
+    static void closeSegment(Segment& segment) {
+        // Sequentially consistent, like the writer's increment in reserve(): either the writer sees
+        // the new current segment, or this load sees the writer.
+        while (segment.writers.load(std::memory_order_seq_cst) != 0) {
+            std::this_thread::yield();
+        }
+        std::size_t used = std::min({segment.offset.load(), segment.end.load(), segment.size});
+        ::munmap(segment.data, segment.size);
+        segment.data = nullptr;
+        if (::ftruncate(segment.fd, static_cast<off_t>(used)) != 0) {
+            // The tail stays zero-filled; the data itself is intact.
+        }
+        ::close(segment.fd);
+        segment.fd = -1;
+    }
+
+    /**
+     * @brief Frees closed segments that no writer can still reach.
+     * 
+     * A writer reaches a segment only through current, and is counted in entering from before it
+     * loads current until it is counted in the writers of that segment. Once entering has been
+     * seen at zero after a segment stopped being current, its writers count covers every thread
+     * that may still touch it.
+     */
+    void pruneSegments() {
+        if (entering.load(std::memory_order_seq_cst) != 0) {
+            return;
+        }
+        Segment* active = current.load(std::memory_order_relaxed);
+        auto unreachable = [active](const std::unique_ptr<Segment>& segment) {
+            return segment.get() != active && segment->data == nullptr
+                && segment->writers.load(std::memory_order_seq_cst) == 0;
+        };
+        segments.erase(std::remove_if(segments.begin(), segments.end(), unreachable), segments.end());
+    }
+
+    void roll(std::size_t fullIndex, std::size_t length) {
+        std::lock_guard<std::mutex> lock(rollMutex);
+        Segment* full = current.load(std::memory_order_acquire);
+        if (full->index != fullIndex) {
+            return;
+        }
+        segments.push_back(openSegment(std::max(segmentSize, length)));
+        current.store(segments.back().get(), std::memory_order_seq_cst);
+        closeSegment(*full);
+        pruneSegments();
+    }
+
+    /**
+     * @brief Reserves length bytes in the current segment, rolling segments as needed.
+     * 
+     * On return the caller is registered as a writer of segment and must call release().
+     */
+    char* reserve(std::size_t length, Segment*& segment) {
+        for (;;) {
+            entering.fetch_add(1, std::memory_order_seq_cst);
+            Segment* candidate = current.load(std::memory_order_seq_cst);
+            candidate->writers.fetch_add(1, std::memory_order_seq_cst);
+            entering.fetch_sub(1, std::memory_order_release);
+            if (current.load(std::memory_order_seq_cst) != candidate) {
+                candidate->writers.fetch_sub(1, std::memory_order_release);
+                continue;
+            }
+            std::size_t offset = candidate->offset.fetch_add(length, std::memory_order_relaxed);
+            if (offset + length <= candidate->size) {
+                segment = candidate;
+                return candidate->data + offset;
+            }
+            std::size_t end = candidate->end.load(std::memory_order_relaxed);
+            while (offset < end && !candidate->end.compare_exchange_weak(end, offset, std::memory_order_relaxed)) {
+            }
+            std::size_t index = candidate->index;
+            candidate->writers.fetch_sub(1, std::memory_order_release);
+            roll(index, length);
+        }
+    }
+
+    static void release(Segment* segment) {
+        segment->writers.fetch_sub(1, std::memory_order_release);
+    }
+
+    void writeLine(std::string_view prefix, std::string_view message) {
+        std::size_t length = prefix.size() + message.size() + 1;
+        Segment* segment = nullptr;
+        char* out = reserve(length, segment);
+        std::memcpy(out, prefix.data(), prefix.size());
+        std::memcpy(out + prefix.size(), message.data(), message.size());
+        out[length - 1] = '\n';
+        release(segment);
+    }
+
+public:
+    /**
+     * @brief Constructs a MmapFileOutput object that writes segments named after filename.
+     * 
+     * Segment numbering starts at the first index for which no file exists yet, so earlier
+     * segments are never overwritten.
+     * 
+     * @param filename The base name of the segment files.
+     * @param segmentSize The size of each preallocated segment in bytes.
+     * @throws std::runtime_error if the first segment cannot be created or mapped.
+     */
+    MmapFileOutput(const std::string& filename, std::size_t segmentSize = DefaultSegmentSize)
+        : filename(filename), segmentSize(std::max<std::size_t>(segmentSize, 1)) {
+        struct stat info;
+        while (::stat((filename + "." + std::to_string(nextIndex)).c_str(), &info) == 0) {
+            ++nextIndex;
+        }
+        segments.push_back(openSegment(this->segmentSize));
+        current.store(segments.back().get(), std::memory_order_release);
+    }
+
+    /**
+     * @brief Unmaps the current segment and truncates it to the bytes written.
+     */
+    ~MmapFileOutput() override {
+        closeSegment(*current.load());
+    }
+
+    /**
+     * @brief Copies the specified message into the current segment.
+     * 
+     * @param message The log message to be outputted.
+     */
+    void output(const std::string& message) override {
+        writeLine(std::string_view(), message);
+    }
+
+    /**
+     * @brief Copies the specified record into the current segment.
+     * 
+     * @param record The log record to be outputted.
+     */
+    void write(const LogRecord& record) override {
+        static thread_local std::string scratch;
+        writeLine(record.prefix(), record.messageText(scratch));
+    }
+
+    /**
+     * @brief Asks the kernel to start writing back the current segment, without waiting.
+     */
+    void flush() override {
+        Segment* segment = nullptr;
+        reserve(0, segment);
+        ::msync(segment->data, segment->size, MS_ASYNC);
+        release(segment);
+    }
+
+    /**
+     * @brief Returns the path of the segment that is currently being written.
+     */
+    std::string currentSegmentPath() const {
+        return current.load(std::memory_order_acquire)->path;
+    }
+};
+
+/**
+ * @brief Settings of a CompressedFileOutput.
+ */
+struct CompressionOptions {
+    std::size_t blockSize = 64 * 1024;              /**< Uncompressed bytes collected before a block is compressed. */
+    std::chrono::milliseconds flushInterval{1000};  /**< Longest a record waits before its block is compressed and written. */
+    int level = 3;                                   /**< zlib compression level, from 1 (fastest) to 9 (smallest). */
+};
+
+/**
+ * @brief The compression applied to rotated log files.
+ */
+enum class RotationCompression {
+    None,
+    Gzip,       /**< Compress each file after rotation. Requires building with CPPLOGGER_HAVE_ZLIB and linking zlib. */
+    GzipStream  /**< Write every file through a CompressedFileOutput, so rotated files are already compressed. */
+};
+
+/**
+ * @brief Controls when a RotatingFileOutput starts a new file and how many old ones it keeps.
+ */
+struct RotationPolicy {
+    std::size_t maxFileSize = 0;                            /**< Rotate once the file reaches this many bytes; 0 disables. */
+    std::chrono::seconds interval{0};                       /**< Rotate at every multiple of this wall-clock interval since the epoch (UTC); 0 disables. */
+    std::size_t maxFiles = 5;                               /**< Number of rotated files to keep. */
+    RotationCompression compression = RotationCompression::None; /**< Compression applied to rotated files. */
+    CompressionOptions streamOptions;                       /**< Block size, flush interval and level of GzipStream files. */
+};
+
+/**
+ * @brief Names and retention of the files produced by rotation.
+ * 
+ * The active file keeps the base name; rotated files are "<base>.1" (newest) up to
+ * "<base>.<maxFiles>" (oldest), with a suffix such as ".gz" once they are compressed.
+ */
+class RotatedFileSet {
+private:
+    std::string base;
+    std::size_t maxFiles;
+    std::string suffix;
+
+public:
+    /**
+     * @brief Constructs a RotatedFileSet for the specified base name.
+     * 
+     * @param base The name of the active file.
+     * @param maxFiles The number of rotated files to keep. At least one is always kept.
+     * @param suffix The suffix of rotated files, for example ".gz".
+     */
+    RotatedFileSet(std::string base, std::size_t maxFiles, std::string suffix = "")
+        : base(std::move(base)), maxFiles(std::max<std::size_t>(maxFiles, 1)), suffix(std::move(suffix)) {}
+
+    /**
+     * @brief Returns the name of the active file.
+     */
+    const std::string& activePath() const {
+        return base;
+    }
+
+    /**
+     * @brief Returns the name of a rotated file before its suffix is applied.
+     * 
+     * @param index The rotation index, starting at 1 for the newest file.
+     */
+    std::string rotatedPath(std::size_t index) const {
+        return base + "." + std::to_string(index);
+    }
+
+    /**
+     * @brief Returns the final name of a rotated file, including the suffix.
+     * 
+     * @param index The rotation index, starting at 1 for the newest file.
+     */
+    std::string finalPath(std::size_t index) const {
+        return rotatedPath(index) + suffix;
+    }
+
+    /**
+     * @brief Deletes the oldest rotated file and moves every other one up by one index, which
+     * frees index 1 for the file being rotated.
+     * 
+     * A file whose compression failed keeps the name without the suffix and is moved under
+     * that name, so the next rotation does not overwrite it.
+     */
+    void shift() const {
+        std::remove(finalPath(maxFiles).c_str());
+        if (!suffix.empty()) {
+            std::remove(rotatedPath(maxFiles).c_str());
+        }
+        for (std::size_t index = maxFiles - 1; index >= 1; --index) {
+            std::rename(finalPath(index).c_str(), finalPath(index + 1).c_str());
+            if (!suffix.empty()) {
+                std::rename(rotatedPath(index).c_str(), rotatedPath(index + 1).c_str());
+            }
+        }
+    }
+
+    /**
+     * @brief Moves the active file to index 1, after shift() made room for it.
+     * 
+     * @param compressed True if the active file is already compressed and takes the final name
+     *        right away. Default is false.
+     */
+    void rotateActive(bool compressed = false) const {
+        std::rename(base.c_str(), (compressed ? finalPath(1) : rotatedPath(1)).c_str());
+    }
+};
+
+/**
+ * @brief Compresses a file into a gzip file and removes the original.
+ * 
+ * If compression fails, the original is kept and a partly written gzip file is removed.
+ * 
+ * @param source The file to compress.
+ * @param destination The gzip file to create.
+ * @return true if the file was compressed, false if compression failed or is not built in.
+ */
+inline bool gzipFile(const std::string& source, const std::string& destination) {
+#if defined(CPPLOGGER_HAVE_ZLIB)
+    std::ifstream input(source, std::ios::binary);
+    gzFile output = gzopen(destination.c_str(), "wb");
+    if (!input || output == nullptr) {
+        if (output != nullptr) {
+            gzclose(output);
+        }
+        return false;
+    }
+    std::vector<char> chunk(64 * 1024);
+    bool ok = true;
+    while (ok && input) {
+        input.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        auto count = static_cast<unsigned>(input.gcount());
+        ok = count == 0 || gzwrite(output, chunk.data(), count) == static_cast<int>(count);
+    }
+    ok = gzclose(output) == Z_OK && ok;
+    std::remove((ok ? source : destination).c_str());
+    return ok;
+#else
+    (void) source;
+    (void) destination;
+    return false;
+#endif
+}
+
+/**
+ * @brief A file output strategy that writes records as one streaming gzip member.
+ * 
+ * write() appends the record to the current block under a short lock. Once the block reaches
+ * the block size, or the flush interval has passed since its first record, a background
+ * thread deflates it and ends it with a sync flush point before writing it out. Everything up
+ * to the last completed block can therefore be decompressed at any time, and a crash loses at
+ * most the block being collected. Blocks are recycled, so steady-state logging does not
+ * allocate. The member is finished on destruction; appending to an existing file adds a new
+ * member, which gzip tools read as one stream.
+ * 
+ * Combine it with rotation through RotationCompression::GzipStream, so rotated files come out
+ * compressed without a separate compress-after-rotate pass. zstd and lz4 are not supported;
+ * the output requires building with CPPLOGGER_HAVE_ZLIB and linking zlib.
+ */
+class CompressedFileOutput : public IOutputStrategy {
+private:
+    CompressionOptions options;
+    int fd = -1;
+    std::mutex mutex;
+    std::condition_variable workCondition;
+    std::condition_variable doneCondition;
+    std::string block;                  /**< The block write() appends to. */
+    std::chrono::steady_clock::time_point blockStarted;
+    std::deque<std::string> queued;     /**< Full blocks waiting for the compressor. */
+    std::vector<std::string> spare;     /**< Compressed blocks, kept for reuse. */
+    std::uint64_t submitted = 0;        /**< Blocks handed to the compressor. */
+    std::uint64_t completed = 0;        /**< Blocks the compressor has written. */
+    bool stopping = false;
+    std::thread worker;
+#if defined(CPPLOGGER_HAVE_ZLIB)
+    z_stream stream{};
+    std::vector<unsigned char> compressed;
+#endif
+
+    void submitBlock() {
+        if (block.empty()) {
+            return;
+        }
+        std::string next;
+        if (!spare.empty()) {
+            next = std::move(spare.back());
+            spare.pop_back();
+        }
+        next.clear();
+        next.reserve(options.blockSize);
+        queued.push_back(std::move(block));
+        block = std::move(next);
+        ++submitted;
+        workCondition.notify_one();
+    }
+
+    void deflateBlock(const std::string& data, bool finish) {
+#if defined(CPPLOGGER_HAVE_ZLIB)
+        int mode = finish ? Z_FINISH : Z_SYNC_FLUSH;
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+        stream.avail_in = static_cast<uInt>(data.size());
+        do {
+            stream.next_out = compressed.data();
+            stream.avail_out = static_cast<uInt>(compressed.size());
+            ::deflate(&stream, mode);
+            writeAll(fd, reinterpret_cast<const char*>(compressed.data()), compressed.size() - stream.avail_out);
+        } while (stream.avail_out == 0);
+#else
+        (void) data;
+        (void) finish;
+#endif
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            workCondition.wait_for(lock, options.flushInterval, [this] { return stopping || !queued.empty(); });
+            if (queued.empty() && !block.empty() && std::chrono::steady_clock::now() - blockStarted >= options.flushInterval) {
+                submitBlock();
+            }
+            if (queued.empty()) {
+                if (stopping) {
+                    return;
+                }
+                continue;
+            }
+            std::string data = std::move(queued.front());
+            queued.pop_front();
+            lock.unlock();
+            deflateBlock(data, false);
+            lock.lock();
+            spare.push_back(std::move(data));
+            ++completed;
+            doneCondition.notify_all();
+        }
+    }
+
+public:
+    /**
+     * @brief Opens the file for appending, starts a gzip member and starts the compressor thread.
+     * 
+     * @param filename The name of the file to output log messages to.
+     * @param options The block size, flush interval and compression level.
+     * @throws std::runtime_error if the file cannot be opened or gzip support is not built in.
+     */
+    CompressedFileOutput(const std::string& filename, CompressionOptions options = CompressionOptions())
+        : options(options) {
+#if defined(CPPLOGGER_HAVE_ZLIB)
+        this->options.blockSize = std::max<std::size_t>(this->options.blockSize, 1);
+        fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Unable to open file");
+        }
+        // Window bits 15 + 16 selects the gzip wrapper
+        if (::deflateInit2(&stream, options.level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            ::close(fd);
+            throw std::runtime_error("Unable to start gzip compression");
+        }
+        compressed.resize(::deflateBound(&stream, static_cast<uLong>(this->options.blockSize)) + 64);
+        block.reserve(this->options.blockSize);
+        worker = std::thread([this] { run(); });
+#else
+        (void) filename;
+        throw std::runtime_error("Gzip compression is not available");
+#endif
+    }
+
+    /**
+     * @brief Compresses every pending record and finishes the gzip member before closing the file.
+     */
+    ~CompressedFileOutput() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            submitBlock();
+            stopping = true;
+        }
+        workCondition.notify_one();
+        worker.join();
+#if defined(CPPLOGGER_HAVE_ZLIB)
+        deflateBlock(std::string(), true);
+        ::deflateEnd(&stream);
+#endif
+        ::close(fd);
+    }
+
+    CompressedFileOutput(const CompressedFileOutput&) = delete;
+    CompressedFileOutput& operator=(const CompressedFileOutput&) = delete;
+
+    /**
+     * @brief Appends the specified message to the current block.
+     * 
+     * @param message The log message to be outputted.
+     */
+    void output(const std::string& message) override {
+        write(LogRecord(LogLevel::Info, message));
+    }
+
+    /**
+     * @brief Appends the record to the current block, handing the block over once it is full.
+     * 
+     * @param record The log record to be outputted.
+     */
+    void write(const LogRecord& record) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (block.empty()) {
+            blockStarted = std::chrono::steady_clock::now();
+        }
+        record.appendTo(block);
+        block.push_back('\n');
+        if (block.size() >= options.blockSize) {
+            submitBlock();
+        }
+    }
+
+    /**
+     * @brief Blocks until every record so far is compressed and written up to a sync flush point.
+     */
+    void flush() override {
+        std::unique_lock<std::mutex> lock(mutex);
+        submitBlock();
+        std::uint64_t target = submitted;
+        doneCondition.wait(lock, [this, target] { return completed >= target; });
+    }
+};
+
+/**
+ * @brief A file output strategy that rotates its file by size and wall-clock interval.
+ * 
+ * Records go to an output strategy opened on the base file name (a FileOutput unless another
+ * opener is given). When the file grows past the size limit or an interval boundary passes,
+ * the logging thread only asks a background thread to rotate: that thread shifts the rotated
+ * files, renames the active file to "<base>.1", deletes files beyond the retention limit and
+ * opens the next file. The logging thread keeps writing to the old file, which follows the
+ * rename, until the new one is published, and then swaps it in. The old strategy is closed
+ * and, if requested, compressed on the background thread as well, so output() never blocks
+ * on renaming, opening or compressing files. With RotationCompression::GzipStream every file
+ * is written through a CompressedFileOutput instead and needs no compression after rotation;
+ * rotated files are named "<base>.N.gz" as with Gzip, and the size limit counts uncompressed
+ * bytes. The uncompressed size of an existing active file is not known, so appending to one
+ * counts from zero.
+ * 
+ * The next file is opened under the temporary name "<base>.next" before anything is renamed.
+ * If that fails, for example because the disk is full, the logging thread keeps writing to the
+ * current file and rotation is tried again at the next size limit or interval boundary.
+ * 
+ * Like FileOutput, output() and write() must be called from one thread at a time.
+ */
+class RotatingFileOutput : public IOutputStrategy {
+public:
+    /**
+     * @brief Opens the output strategy for a file name.
+     */
+    using FileOpener = std::function<std::unique_ptr<IOutputStrategy>(const std::string&)>;
+
+private:
+    RotationPolicy policy;
+    RotatedFileSet files;
+    FileOpener openFile;
+    std::unique_ptr<IOutputStrategy> active;
+    std::atomic<IOutputStrategy*> pending{nullptr}; /**< The next file, published by the worker. */
+    std::atomic<bool> rotationFailed{false};        /**< Set by the worker when the next file could not be opened. */
+    std::size_t bytesWritten = 0;
+    std::size_t sizeLimit = 0;                      /**< bytesWritten at which the next rotation is requested. */
+    std::chrono::system_clock::time_point nextBoundary;
+    bool rotationRequested = false;
+    std::string scratch;
+
+    struct Task {
+        std::unique_ptr<IOutputStrategy> retired; /**< The file to close, or null to rotate. */
+    };
+
+    std::mutex taskMutex;
+    std::condition_variable taskCondition;
+    std::deque<Task> tasks;
+    bool stopping = false;
+    std::thread worker;
+
+    std::chrono::system_clock::time_point boundaryAfter(std::chrono::system_clock::time_point time) const {
+        if (policy.interval.count() <= 0) {
+            return std::chrono::system_clock::time_point::max();
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch());
+        return std::chrono::system_clock::time_point((elapsed / policy.interval + 1) * policy.interval);
+    }
+
+    void submit(Task task) {
+        {
+            std::lock_guard<std::mutex> lock(taskMutex);
+            tasks.push_back(std::move(task));
+        }
+        taskCondition.notify_one();
+    }
+
+    /**
+     * @brief Opens the next file under a temporary name and only then moves the files along, so
+     * a failed open leaves every file where it was.
+     */
+    void rotate() {
+        std::string opening = files.activePath() + ".next";
+        std::remove(opening.c_str());
+        std::unique_ptr<IOutputStrategy> next;
+        try {
+            next = openFile(opening);
+        } catch (...) {
+            std::remove(opening.c_str());
+            rotationFailed.store(true, std::memory_order_relaxed);
+            return;
+        }
+        files.shift();
+        files.rotateActive(policy.compression == RotationCompression::GzipStream);
+        std::rename(opening.c_str(), files.activePath().c_str());
+        pending.store(next.release(), std::memory_order_release);
+    }
+
+    void retire(std::unique_ptr<IOutputStrategy> retired) {
+        retired.reset();
+        if (policy.compression == RotationCompression::Gzip) {
+            // On failure the file stays "<base>.1", which RotatedFileSet::shift() also moves
+            gzipFile(files.rotatedPath(1), files.finalPath(1));
+        }
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(taskMutex);
+        for (;;) {
+            taskCondition.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;
+            }
+            Task task = std::move(tasks.front());
+            tasks.pop_front();
+            lock.unlock();
+            if (task.retired) {
+                retire(std::move(task.retired));
+            } else {
+                rotate();
+            }
+            lock.lock();
+        }
+    }
+
+    /**
+     * @brief Swaps in a file published by the worker and hands the old one back for closing.
+     */
+    void adoptPendingFile() {
+        if (pending.load(std::memory_order_relaxed) == nullptr) {
+            return;
+        }
+        std::unique_ptr<IOutputStrategy> next(pending.exchange(nullptr, std::memory_order_acquire));
+        std::swap(active, next);
+        bytesWritten = 0;
+        sizeLimit = policy.maxFileSize;
+        rotationRequested = false;
+        submit(Task{std::move(next)});
+    }
+
+    void afterWrite(std::size_t bytes) {
+        bytesWritten += bytes;
+        if (rotationRequested) {
+            if (rotationFailed.load(std::memory_order_relaxed)) {
+                // Keep writing to this file and try again at the next boundary
+                rotationFailed.store(false, std::memory_order_relaxed);
+                rotationRequested = false;
+                sizeLimit = bytesWritten + policy.maxFileSize;
+            }
+            return;
+        }
+        bool sizeDue = policy.maxFileSize > 0 && bytesWritten >= sizeLimit;
+        bool timeDue = policy.interval.count() > 0 && std::chrono::system_clock::now() >= nextBoundary;
+        if (sizeDue || timeDue) {
+            rotationRequested = true;
+            nextBoundary = boundaryAfter(std::chrono::system_clock::now());
+            submit(Task{});
+        }
+    }
+
+public:
+    /**
+     * @brief Constructs a RotatingFileOutput object for the specified file and policy.
+     * 
+     * @param filename The name of the active log file.
+     * @param policy The size, interval and retention settings.
+     * @param openFile Opens the output strategy for each new file. Default opens a FileOutput.
+     * @throws std::runtime_error if the first file cannot be opened, or if gzip compression is
+     *         requested but not built in.
+     */
+    RotatingFileOutput(const std::string& filename, RotationPolicy policy, FileOpener openFile = nullptr)
+        : policy(policy),
+          files(filename, policy.maxFiles, policy.compression != RotationCompression::None ? ".gz" : ""),
+          openFile(openFile ? std::move(openFile) : FileOpener([policy](const std::string& name) -> std::unique_ptr<IOutputStrategy> {
+              if (policy.compression == RotationCompression::GzipStream) {
+                  return std::make_unique<CompressedFileOutput>(name, policy.streamOptions);
+              }
+              return std::make_unique<FileOutput>(name);
+          })) {
+#if !defined(CPPLOGGER_HAVE_ZLIB)
+        if (policy.compression != RotationCompression::None) {
+            throw std::runtime_error("Gzip compression is not available");
+        }
+#endif
+        active = this->openFile(filename);
+        if (policy.compression != RotationCompression::GzipStream) {
+            std::ifstream existing(filename, std::ios::binary | std::ios::ate);
+            bytesWritten = existing ? static_cast<std::size_t>(existing.tellg()) : 0;
+        }
+        sizeLimit = policy.maxFileSize;
+        nextBoundary = boundaryAfter(std::chrono::system_clock::now());
+        worker = std::thread([this] { run(); });
+    }
+
+    /**
+     * @brief Finishes any pending rotation and compression work, then closes the active file.
+     */
+    ~RotatingFileOutput() override {
+        {
+            std::lock_guard<std::mutex> lock(taskMutex);
+            stopping = true;
+        }
+        taskCondition.notify_one();
+        worker.join();
+
+        // A rotation that finished after the last write still has to retire the old file
+        std::unique_ptr<IOutputStrategy> next(pending.exchange(nullptr));
+        if (next) {
+            std::swap(active, next);
+            retire(std::move(next));
+        }
+    }
+
+    /**
+     * @brief Outputs the specified message to the active file.
+     * 
+     * @param message The log message to be outputted.
+     */
+    void output(const std::string& message) override {
+        adoptPendingFile();
+        active->output(message);
+        afterWrite(message.size() + 1);
+    }
+
+    /**
+     * @brief Outputs the specified record to the active file.
+     * 
+     * @param record The log record to be outputted.
+     */
+    void write(const LogRecord& record) override {
+        adoptPendingFile();
+        if (record.isDeferred()) {
+            // Format once here, so the size is exact and the active file does not format again
+            LogRecord resolved = record;
+            resolved.message = record.messageText(scratch);
+            resolved.defer(nullptr, nullptr);
+            active->write(resolved);
+        } else {
+            active->write(record);
+        }
+        afterWrite(record.prefix().size() + (record.isDeferred() ? scratch.size() : record.message.size()) + 1);
+    }
+
+    /**
+     * @brief Flushes the active file.
+     */
+    void flush() override {
+        active->flush();
+    }
+};
+
+/**
+ * @brief Settings of a NetworkService.
+ */
+struct NetworkOptions {
+    std::size_t queueCapacity = 8192;                      /**< Records that can wait for the sender thread. */
+    OverflowPolicy overflowPolicy = OverflowPolicy::DropNewest; /**< What send() does when the queue is full. */
+    std::chrono::microseconds blockTimeout{1000};          /**< How long BlockWithTimeout waits for space. */
+    std::size_t maxBatch = 64;                             /**< Records handed to the kernel per system call. */
+    std::chrono::milliseconds initialBackoff{100};         /**< First delay before reconnecting. */
+    std::chrono::milliseconds maxBackoff{30000};           /**< Upper bound of the doubling reconnect delay. */
+    std::chrono::milliseconds shutdownTimeout{1000};       /**< How long destruction keeps sending queued records. */
+    int facility = 1;                                      /**< Syslog facility; 1 is user-level messages. */
+};
+
+/**
+ * @brief Represents a network service for sending messages.
+ * 
+ * Messages are sent as syslog records ("<PRI>message") to the URL's host and port (default
+ * 514): over UDP for "syslog://" and "udp://" URLs, and over TCP with newline framing for
+ * "syslog+tcp://" and "tcp://" URLs. IPv6 hosts are written in brackets.
+ * 
+ * send() only puts the record into a bounded lock-free queue; a background thread owns the
+ * non-blocking socket and sends records in batches, with one sendmmsg() per batch of datagrams
+ * or one vectored send per batch of stream records. If the collector is unreachable the thread
+ * reconnects with exponential backoff while the queue absorbs new records, and once it is full
+ * the OverflowPolicy decides whether send() drops the record, waits, evicts the oldest record
+ * or sheds by level. With the default DropNewest policy a slow or dead collector never stalls
+ * the caller.
+ */
+class NetworkService {
+public:
+    /**
+     * @brief The transport protocol of a network service.
+     */
+    enum class Transport {
+        Udp,
+        Tcp
+    };
+
+private:
+    struct OutboundRecord {
+        std::string data;
+    };
+
+    NetworkOptions options;
+    Transport transport = Transport::Udp;
+    std::string host;
+    std::string port = "514";
+    LockFreeRingBuffer<OutboundRecord> queue;
+    std::atomic<std::size_t> dropped{0};
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> workerWaiting{false};
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    int socketFd = -1;
+    std::thread worker;
+
+    void parseUrl(const std::string& serviceUrl) {
+        std::size_t schemeEnd = serviceUrl.find("://");
+        if (schemeEnd == std::string::npos) {
+            throw std::invalid_argument("Invalid network service URL: " + serviceUrl);
+        }
+        std::string scheme = serviceUrl.substr(0, schemeEnd);
+        if (scheme == "syslog" || scheme == "udp") {
+            transport = Transport::Udp;
+        } else if (scheme == "syslog+tcp" || scheme == "tcp") {
+            transport = Transport::Tcp;
+        } else {
+            throw std::invalid_argument("Unsupported network service URL: " + serviceUrl);
+        }
+
+        std::string authority = serviceUrl.substr(schemeEnd + 3);
+        authority = authority.substr(0, authority.find('/'));
+        std::size_t portStart = std::string::npos;
+        if (!authority.empty() && authority.front() == '[') {
+            std::size_t close = authority.find(']');
+            if (close == std::string::npos) {
+                throw std::invalid_argument("Invalid network service URL: " + serviceUrl);
+            }
+            host = authority.substr(1, close - 1);
+            if (close + 1 < authority.size() && authority[close + 1] == ':') {
+                portStart = close + 2;
+            }
+        } else {
+            std::size_t colon = authority.rfind(':');
+            host = authority.substr(0, colon);
+            if (colon != std::string::npos) {
+                portStart = colon + 1;
+            }
+        }
+        if (portStart != std::string::npos) {
+            port = authority.substr(portStart);
+        }
+        if (host.empty() || port.empty()) {
+            throw std::invalid_argument("Invalid network service URL: " + serviceUrl);
+        }
+    }
+
+    static int severity(LogLevel level) {
+        switch (level) {
+            case LogLevel::Fatal: return 2;
+            case LogLevel::Error: return 3;
+            case LogLevel::Warning: return 4;
+            case LogLevel::Info: return 6;
+            default: return 7;
+        }
+    }
+
+    void appendHeader(std::string& data, LogLevel level) const {
+        data.push_back('<');
+        appendFormatted(data, options.facility * 8 + severity(level));
+        data.push_back('>');
+    }
+
+    void enqueue(OutboundRecord& record, LogLevel level) {
+        if (transport == Transport::Tcp) {
+            record.data.push_back('\n');
+        }
+        EnqueueResult result = enqueueWithPolicy(queue, record, level, options.overflowPolicy, options.blockTimeout,
+                                                 [this] { wakeWorker(); });
+        std::size_t discarded = result.evicted + (result.queued ? 0 : 1);
+        if (discarded > 0) {
+            dropped.fetch_add(discarded, std::memory_order_relaxed);
+        }
+    }
+
+    void wakeWorker() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (workerWaiting.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            wakeCondition.notify_one();
+        }
+    }
+
+    void sleepFor(std::chrono::milliseconds duration) {
+        workerWaiting.store(true, std::memory_order_seq_cst);
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeCondition.wait_for(lock, duration, [this] {
+                return queue.size() > 0 || stopping.load(std::memory_order_acquire);
+            });
+        }
+        workerWaiting.store(false, std::memory_order_relaxed);
+    }
+
+    void closeSocket() {
+        if (socketFd >= 0) {
+            ::close(socketFd);
+            socketFd = -1;
+        }
+    }
+
+    bool waitWritable(int timeoutMs) const {
+        pollfd descriptor{socketFd, POLLOUT, 0};
+        return ::poll(&descriptor, 1, timeoutMs) > 0 && (descriptor.revents & (POLLERR | POLLHUP)) == 0;
+    }
+
+    bool connectSocket() {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = transport == Transport::Udp ? SOCK_DGRAM : SOCK_STREAM;
+        addrinfo* addresses = nullptr;
+        if (::getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses) != 0) {
+            return false;
+        }
+        for (addrinfo* address = addresses; address != nullptr && socketFd < 0; address = address->ai_next) {
+            socketFd = ::socket(address->ai_family, address->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, address->ai_protocol);
+            if (socketFd < 0) {
+                continue;
+            }
+            if (::connect(socketFd, address->ai_addr, address->ai_addrlen) == 0) {
+                break;
+            }
+            int error = 0;
+            socklen_t length = sizeof(error);
+            if (errno == EINPROGRESS && waitWritable(1000)
+                && ::getsockopt(socketFd, SOL_SOCKET, SO_ERROR, &error, &length) == 0 && error == 0) {
+                break;
+            }
+            closeSocket();
+        }
+        ::freeaddrinfo(addresses);
+        return socketFd >= 0;
+    }
+
+    /**
+     * @brief Sends a batch of datagrams; sent records are removed from the front of the batch.
+     * 
+     * @return false if the socket failed and has to be reopened.
+     */
+    bool sendDatagrams(std::vector<std::string>& batch) {
+        std::vector<iovec> vectors(batch.size());
+        std::vector<mmsghdr> messages(batch.size());
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            vectors[i].iov_base = batch[i].data();
+            vectors[i].iov_len = batch[i].size();
+            messages[i] = mmsghdr{};
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+        int sent = ::sendmmsg(socketFd, messages.data(), static_cast<unsigned>(messages.size()), MSG_DONTWAIT);
+        if (sent > 0) {
+            batch.erase(batch.begin(), batch.begin() + sent);
+            return true;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            waitWritable(100);
+            return true;
+        }
+        if (errno == ECONNREFUSED || errno == EINTR) {
+            // An earlier datagram was refused by the collector; the batch itself can be retried
+            return true;
+        }
+        dropped.fetch_add(batch.size(), std::memory_order_relaxed);
+        batch.clear();
+        return false;
+    }
+
+    /**
+     * @brief Sends as much of a batch of stream records as the socket accepts.
+     * 
+     * @param offset The number of bytes of the first record that were already sent.
+     * @return false if the connection failed and has to be reopened.
+     */
+    bool sendStream(std::vector<std::string>& batch, std::size_t& offset) {
+        std::vector<iovec> vectors(batch.size());
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            std::size_t skip = i == 0 ? offset : 0;
+            vectors[i].iov_base = batch[i].data() + skip;
+            vectors[i].iov_len = batch[i].size() - skip;
+        }
+        msghdr message{};
+        message.msg_iov = vectors.data();
+        message.msg_iovlen = vectors.size();
+        ssize_t sent = ::sendmsg(socketFd, &message, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                waitWritable(100);
+                return true;
+            }
+            offset = 0;
+            return false;
+        }
+        auto remaining = static_cast<std::size_t>(sent);
+        std::size_t complete = 0;
+        while (complete < batch.size() && remaining >= batch[complete].size() - offset) {
+            remaining -= batch[complete].size() - offset;
+            offset = 0;
+            ++complete;
+        }
+        offset += remaining;
+        batch.erase(batch.begin(), batch.begin() + complete);
+        return true;
+    }
+
+    void run() {
+        std::vector<std::string> batch;
+        batch.reserve(options.maxBatch);
+        std::size_t offset = 0;
+        auto backoff = options.initialBackoff;
+        auto shutdownDeadline = std::chrono::steady_clock::time_point::max();
+
+        for (;;) {
+            OutboundRecord record;
+            while (batch.size() < options.maxBatch && queue.tryPop(record)) {
+                batch.push_back(std::move(record.data));
+            }
+            if (stopping.load(std::memory_order_acquire) && shutdownDeadline == std::chrono::steady_clock::time_point::max()) {
+                shutdownDeadline = std::chrono::steady_clock::now() + options.shutdownTimeout;
+            }
+            if (batch.empty()) {
+                if (stopping.load(std::memory_order_acquire)) {
+                    break;
+                }
+                sleepFor(std::chrono::milliseconds(100));
+                continue;
+            }
+            if (std::chrono::steady_clock::now() >= shutdownDeadline) {
+                dropped.fetch_add(batch.size() + queue.size(), std::memory_order_relaxed);
+                break;
+            }
+
+            if (socketFd < 0 && !connectSocket()) {
+                sleepFor(stopping.load() ? std::chrono::milliseconds(10) : backoff);
+                backoff = std::min(backoff * 2, options.maxBackoff);
+                continue;
+            }
+            backoff = options.initialBackoff;
+
+            bool healthy = transport == Transport::Udp ? sendDatagrams(batch) : sendStream(batch, offset);
+            if (!healthy) {
+                closeSocket();
+            }
+        }
+        closeSocket();
+    }
+
+public:
+    /**
+     * @brief Constructs a NetworkService object with the specified service URL.
+     * 
+     * Name resolution and connecting happen on the background thread, so construction never
+     * waits for the network.
+     * 
+     * @param serviceUrl The URL of the network service.
+     * @param options The queue, batching and reconnect settings.
+     * @throws std::invalid_argument if the URL cannot be parsed or uses an unsupported scheme.
+     */
+    NetworkService(const std::string& serviceUrl, NetworkOptions options = NetworkOptions())
+        : options(options), queue(options.queueCapacity) {
+        this->options.maxBatch = std::max<std::size_t>(this->options.maxBatch, 1);
+        parseUrl(serviceUrl);
+        worker = std::thread([this] { run(); });
+    }
+
+    NetworkService(const NetworkService&) = delete;
+    NetworkService& operator=(const NetworkService&) = delete;
+
+    /**
+     * @brief Sends what is still queued, for at most the shutdown timeout, and closes the socket.
+     */
+    ~NetworkService() {
+        stopping.store(true, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            wakeCondition.notify_one();
+        }
+        worker.join();
+    }
+
+    /**
+     * @brief Sends a message through the network service.
+     * 
+     * @param message The message to be sent, with informational severity.
+     */
+    void send(const std::string& message) {
+        send(LogLevel::Info, message);
+    }
+
+    /**
+     * @brief Sends a message with the severity of the specified log level.
+     * 
+     * @param level The log level that determines the syslog severity.
+     * @param message The message to be sent.
+     */
+    void send(LogLevel level, std::string_view message) {
+        OutboundRecord record;
+        record.data.reserve(message.size() + 8);
+        appendHeader(record.data, level);
+        record.data.append(message);
+        enqueue(record, level);
+    }
+
+    /**
+     * @brief Sends a serialized log record with the severity of its level.
+     * 
+     * @param record The record to be sent.
+     */
+    void send(const LogRecord& record) {
+        OutboundRecord outbound;
+        outbound.data.reserve(record.size() + 8);
+        appendHeader(outbound.data, record.level);
+        record.appendTo(outbound.data);
+        enqueue(outbound, record.level);
+    }
+
+    /**
+     * @brief Returns the number of records dropped because the queue was full or sending failed.
+     */
+    std::size_t droppedCount() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the number of records waiting for the sender thread.
+     */
+    std::size_t queueDepth() const {
+        return queue.size();
+    }
+
+    /**
+     * @brief Returns the transport selected by the URL scheme.
+     */
+    Transport getTransport() const {
+        return transport;
+    }
+};
+
+/**
+ * @brief A class that represents an output strategy for sending log messages to a network service.
+ * 
+ * This class inherits from the IOutputStrategy interface and uses a NetworkService object to send messages to a network service.
+ */
+class NetworkOutput : public IOutputStrategy {
+private:
+    NetworkService networkService; /**< The NetworkService object used to send messages to a network service. */
+public:
+    /**
+     * @brief Constructs a NetworkOutput object with the specified service URL.
+     * 
+     * @param serviceUrl The URL of the network service.
+     * @param options The queue, batching and reconnect settings.
+     */
+    NetworkOutput(const std::string& serviceUrl, NetworkOptions options = NetworkOptions())
+        : networkService(serviceUrl, options) {}
+
+    /**
+     * @brief Sends the specified message to the network service.
+     * 
+     * @param message The log message to be sent.
+     */
+    void output(const std::string& message) override {
+        networkService.send(message);
+    }
+
+    /**
+     * @brief Sends the specified record to the network service with the severity of its level.
+     * 
+     * @param record The log record to be sent.
+     */
+    void write(const LogRecord& record) override {
+        networkService.send(record);
+    }
+
+    /**
+     * @brief Returns the number of records the network service has dropped.
+     */
+    std::size_t droppedCount() const {
+        return networkService.droppedCount();
+    }
+
+    /**
+     * @brief Returns the telemetry of this strategy, including the drops and queue of the network service.
+     */
+    TelemetrySnapshot stats() const override {
+        TelemetrySnapshot stats = telemetry.snapshot();
+        stats.recordsDropped = networkService.droppedCount();
+        stats.queueDepth = networkService.queueDepth();
+        return stats;
+    }
+};
+
+/**
+ * @brief Settings of a SharedMemoryOutput.
+ */
+struct SharedMemoryOptions {
+    std::size_t capacity = 1024 * 1024;                         /**< Bytes of the ring, rounded up to a power of two. */
+    OverflowPolicy overflowPolicy = OverflowPolicy::DropNewest; /**< What write() does when the ring is full. */
+    std::chrono::microseconds blockTimeout{1000};               /**< How long BlockWithTimeout waits for space. */
+};
+
+/**
+ * @brief The layout of a shared-memory log ring, shared by SharedMemoryOutput and SharedMemoryCollector.
+ * 
+ * A segment starts with a Header and is followed by the ring. Producers claim space by
+ * advancing head with a compare-and-swap, write a Slot and its text, and publish the slot by
+ * storing its size last. The collector reads published slots from tail, zeroes what it
+ * consumed, so unpublished slots always read as size 0, and then advances tail. A slot that
+ * would cross the end of the ring is preceded by a padding slot that fills the rest of it.
+ */
+namespace shared_memory_ring {
+
+constexpr std::uint64_t Magic = 0x314D4853474C5043; /**< "CPLGSHM1", stored once the segment is ready. */
+constexpr std::uint32_t PaddingFlag = 0x80000000u;   /**< Marks a slot that only skips to the start of the ring. */
+constexpr const char* Directory = "/dev/shm";        /**< Where Linux lists POSIX shared-memory objects. */
+
+/**
+ * @brief The control block at the start of a segment.
+ */
+struct Header {
+    std::atomic<std::uint64_t> magic;
+    std::uint64_t capacity;                     /**< Bytes of the ring, a power of two. */
+    std::int32_t pid;                           /**< The producer process. */
+    std::atomic<std::uint32_t> closed;          /**< Set once the producer will not write again. */
+    alignas(64) std::atomic<std::uint64_t> head;    /**< Bytes claimed by producers. */
+    alignas(64) std::atomic<std::uint64_t> tail;    /**< Bytes consumed by the collector. */
+    alignas(64) std::atomic<std::uint64_t> dropped; /**< Records the producer discarded. */
+};
+
+/**
+ * @brief The fixed part of a record in the ring, followed by the prefix and message text.
+ */
+struct Slot {
+    std::atomic<std::uint32_t> size; /**< Bytes of the slot including padding; 0 until published. */
+    std::uint8_t level;
+    std::uint8_t padding;            /**< Bytes after the text that only align the next slot. */
+    std::uint16_t prefixLength;
+    std::int64_t time;               /**< Nanoseconds since the epoch. */
+};
+
+constexpr std::size_t DataOffset = (sizeof(Header) + 63) / 64 * 64; /**< Where the ring starts in the segment. */
+
+inline std::size_t slotSize(std::size_t textLength) {
+    return (sizeof(Slot) + textLength + 7) / 8 * 8;
+}
+
+} // namespace shared_memory_ring
+
+/**
+ * @brief An output strategy that publishes records into a ring in a named shared-memory segment.
+ * 
+ * Each SharedMemoryOutput creates its own segment, "/<prefix>.<pid>.<n>", and a collector
+ * process drains the rings of every producer on the host, through a SharedMemoryCollector,
+ * into one set of sinks. Writing a record is a compare-and-swap to claim space in the ring
+ * and a memcpy, with no lock and no system call, and any number of threads can write at
+ * once. The ring is never waited on by default: when it is full, the record is dropped and
+ * counted, unless the overflow policy says to wait. OverwriteOldest is treated as DropNewest,
+ * since the oldest records belong to the collector. Only the prefix and message text are
+ * transported, not structured fields.
+ * 
+ * The segment is left for the collector on destruction, which removes it once it is drained.
+ * Segments of producers that exit without a collector running stay in /dev/shm until one does.
+ */
+class SharedMemoryOutput : public IOutputStrategy {
+private:
+    SharedMemoryOptions options;
+    std::string segmentName;
+    int fd = -1;
+    void* mapping = nullptr;
+    std::size_t mappingSize = 0;
+    shared_memory_ring::Header* header = nullptr;
+    char* ring = nullptr;
+    std::uint64_t mask = 0;
+
+    static std::size_t roundUpToPowerOfTwo(std::size_t value) {
+        std::size_t result = 4096;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    /**
+     * @brief Closes a segment left behind by an earlier process that had the same pid.
+     * 
+     * That process cannot still be writing, since this one has its pid now. A segment that
+     * never became ready is removed; a ready one is marked closed, so the collector drains and
+     * then removes it.
+     */
+    static void retireStale(const std::string& name) {
+        int staleFd = ::shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+        if (staleFd < 0) {
+            return;
+        }
+        struct stat status{};
+        void* staleMapping = MAP_FAILED;
+        if (::fstat(staleFd, &status) == 0 && static_cast<std::size_t>(status.st_size) > shared_memory_ring::DataOffset) {
+            staleMapping = ::mmap(nullptr, sizeof(shared_memory_ring::Header), PROT_READ | PROT_WRITE, MAP_SHARED, staleFd, 0);
+        }
+        ::close(staleFd);
+        if (staleMapping == MAP_FAILED) {
+            ::shm_unlink(name.c_str());
+            return;
+        }
+        auto* staleHeader = static_cast<shared_memory_ring::Header*>(staleMapping);
+        if (staleHeader->magic.load(std::memory_order_acquire) == shared_memory_ring::Magic) {
+            staleHeader->closed.store(1, std::memory_order_release);
+        } else {
+            ::shm_unlink(name.c_str());
+        }
+        ::munmap(staleMapping, sizeof(shared_memory_ring::Header));
+    }
+
+    bool claim(LogLevel level, std::uint64_t length, std::uint64_t& position, std::uint64_t& total) {
+        std::uint64_t capacity = mask + 1;
+        std::chrono::steady_clock::time_point deadline{};
+        position = header->head.load(std::memory_order_relaxed);
+        for (;;) {
+            std::uint64_t offset = position & mask;
+            total = length + (offset + length > capacity ? capacity - offset : 0);
+            std::uint64_t used = position - header->tail.load(std::memory_order_acquire);
+            if (options.overflowPolicy == OverflowPolicy::ShedByLevel && shedsEarly(level, used, capacity)) {
+                return false;
+            }
+            if (used + total > capacity) {
+                bool waits = options.overflowPolicy == OverflowPolicy::Block ||
+                             options.overflowPolicy == OverflowPolicy::BlockWithTimeout ||
+                             (options.overflowPolicy == OverflowPolicy::ShedByLevel && level <= LogLevel::Error);
+                if (!waits) {
+                    return false;
+                }
+                if (options.overflowPolicy == OverflowPolicy::BlockWithTimeout) {
+                    auto now = std::chrono::steady_clock::now();
+                    if (deadline == std::chrono::steady_clock::time_point{}) {
+                        deadline = now + options.blockTimeout;
+                    } else if (now >= deadline) {
+                        return false;
+                    }
+                }
+                std::this_thread::yield();
+                position = header->head.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (header->head.compare_exchange_weak(position, position + total, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+    }
+
+    void publish(LogLevel level, std::chrono::system_clock::time_point time, std::string_view prefix, std::string_view message) {
+        using shared_memory_ring::Slot;
+        if (prefix.size() > 0xFFFF) {
+            prefix = std::string_view();
+        }
+        std::uint64_t length = shared_memory_ring::slotSize(prefix.size() + message.size());
+        std::uint64_t position = 0;
+        std::uint64_t total = 0;
+        if (length > (mask + 1) / 4 || !claim(level, length, position, total)) {
+            header->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        std::uint64_t offset = position & mask;
+        if (total != length) {
+            auto* padding = reinterpret_cast<Slot*>(ring + offset);
+            padding->size.store(static_cast<std::uint32_t>(total - length) | shared_memory_ring::PaddingFlag, std::memory_order_release);
+            offset = 0;
+        }
+        auto* slot = reinterpret_cast<Slot*>(ring + offset);
+        slot->level = static_cast<std::uint8_t>(level);
+        slot->padding = static_cast<std::uint8_t>(length - sizeof(Slot) - prefix.size() - message.size());
+        slot->prefixLength = static_cast<std::uint16_t>(prefix.size());
+        if (time == std::chrono::system_clock::time_point{}) {
+            time = std::chrono::system_clock::now();
+        }
+        slot->time = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+        char* text = ring + offset + sizeof(Slot);
+        std::memcpy(text, prefix.data(), prefix.size());
+        std::memcpy(text + prefix.size(), message.data(), message.size());
+        slot->size.store(static_cast<std::uint32_t>(length), std::memory_order_release);
+    }
+
+public:
+    /**
+     * @brief Creates the shared-memory segment and its ring.
+     * 
+     * A segment of the same name left behind by an earlier process with the same pid is handed
+     * to the collector, and the next free name is used instead.
+     * 
+     * @param prefix The name the collector looks for; it must not contain '/'.
+     * @param options The size of the ring and what write() does when it is full.
+     * @throws std::runtime_error if the segment cannot be created.
+     */
+    SharedMemoryOutput(const std::string& prefix = "cpplogger", SharedMemoryOptions options = SharedMemoryOptions())
+        : options(options) {
+        static std::atomic<unsigned> instances{0};
+        for (;;) {
+            segmentName = "/" + prefix + "." + std::to_string(::getpid()) + "." + std::to_string(instances.fetch_add(1));
+            fd = ::shm_open(segmentName.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+            if (fd >= 0) {
+                break;
+            }
+            if (errno != EEXIST) {
+                throw std::runtime_error("Unable to create shared memory segment " + segmentName);
+            }
+            retireStale(segmentName);
+        }
+        std::size_t capacity = roundUpToPowerOfTwo(options.capacity);
+        mappingSize = shared_memory_ring::DataOffset + capacity;
+        if (::ftruncate(fd, static_cast<off_t>(mappingSize)) != 0) {
+            ::close(fd);
+            ::shm_unlink(segmentName.c_str());
+            throw std::runtime_error("Unable to size shared memory segment " + segmentName);
+        }
+        mapping = ::mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED) {
+            ::close(fd);
+            ::shm_unlink(segmentName.c_str());
+            throw std::runtime_error("Unable to map shared memory segment " + segmentName);
+        }
+        header = static_cast<shared_memory_ring::Header*>(mapping);
+        ring = static_cast<char*>(mapping) + shared_memory_ring::DataOffset;
+        mask = capacity - 1;
+        header->capacity = capacity;
+        header->pid = static_cast<std::int32_t>(::getpid());
+        header->magic.store(shared_memory_ring::Magic, std::memory_order_release);
+    }
+
+    /**
+     * @brief Marks the segment closed, so the collector removes it once it is drained.
+     */
+    ~SharedMemoryOutput() override {
+        header->closed.store(1, std::memory_order_release);
+        ::munmap(mapping, mappingSize);
+        ::close(fd);
+    }
+
+    SharedMemoryOutput(const SharedMemoryOutput&) = delete;
+    SharedMemoryOutput& operator=(const SharedMemoryOutput&) = delete;
+
+    /**
+     * @brief Publishes the specified message as an Info record.
+     * 
+     * @param message The log message to be outputted.
+     */
+    void output(const std::string& message) override {
+        publish(LogLevel::Info, std::chrono::system_clock::time_point{}, std::string_view(), message);
+    }
+
+    /**
+     * @brief Publishes the record into the ring.
+     * 
+     * @param record The log record to be outputted.
+     */
+    void write(const LogRecord& record) override {
+        static thread_local std::string scratch;
+        publish(record.level, record.time, record.prefix(), record.messageText(scratch));
+    }
+
+    /**
+     * @brief Returns the name of the shared-memory segment, for example "/cpplogger.1234.0".
+     */
+    const std::string& name() const {
+        return segmentName;
+    }
+
+    /**
+     * @brief Returns the number of records dropped because the ring was full or a record was too large.
+     */
+    std::uint64_t droppedCount() const {
+        return header->dropped.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the telemetry of this strategy, including drops and the bytes waiting in the ring.
+     */
+    TelemetrySnapshot stats() const override {
+        TelemetrySnapshot stats = telemetry.snapshot();
+        stats.recordsDropped = droppedCount();
+        stats.queueDepth = header->head.load(std::memory_order_relaxed) - header->tail.load(std::memory_order_relaxed);
+        return stats;
+    }
+};
+
+/**
+ * @brief Drains the rings of every SharedMemoryOutput with a prefix into one output strategy.
+ * 
+ * poll() looks for new segments in /dev/shm, writes every published record of every ring to
+ * the output, from the calling thread, and flushes it when anything was written. A segment is
+ * unmapped and removed once it is drained and its producer has closed it or exited. Records
+ * keep the level, timestamp and prefix they had in the producer.
+ * 
+ * Segments are not trusted: every slot is checked against the ring before it is read. A slot
+ * that fails the checks makes the whole segment corrupt, and it is removed. A slot that a
+ * producer claimed but never published, because the process died in between, is counted as
+ * dropped once the producer is gone, and reading resumes at the next valid slot after it.
+ */
+class SharedMemoryCollector {
+private:
+    struct Segment {
+        std::string name;
+        void* mapping = nullptr;
+        std::size_t size = 0;
+        shared_memory_ring::Header* header = nullptr;
+        char* ring = nullptr;
+        bool corrupt = false;
+    };
+
+    enum class SlotState {
+        Unpublished,
+        Record,
+        Padding,
+        Corrupt
+    };
+
+    std::string prefix;
+    std::unique_ptr<IOutputStrategy> output;
+    std::vector<Segment> segments;
+    std::uint64_t collected = 0;
+    std::uint64_t retiredDrops = 0; /**< Drops of the segments already removed. */
+
+    bool known(const std::string& name) const {
+        for (const Segment& segment : segments) {
+            if (segment.name == name) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void attach(const std::string& name) {
+        int fd = ::shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+        if (fd < 0) {
+            return;
+        }
+        struct stat status{};
+        if (::fstat(fd, &status) != 0 || static_cast<std::size_t>(status.st_size) <= shared_memory_ring::DataOffset) {
+            ::close(fd); // Not sized yet; try again on the next poll
+            return;
+        }
+        Segment segment;
+        segment.name = name;
+        segment.size = static_cast<std::size_t>(status.st_size);
+        segment.mapping = ::mmap(nullptr, segment.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (segment.mapping == MAP_FAILED) {
+            return;
+        }
+        segment.header = static_cast<shared_memory_ring::Header*>(segment.mapping);
+        segment.ring = static_cast<char*>(segment.mapping) + shared_memory_ring::DataOffset;
+        std::uint64_t capacity = segment.header->capacity;
+        if (segment.header->magic.load(std::memory_order_acquire) != shared_memory_ring::Magic ||
+            capacity == 0 || (capacity & (capacity - 1)) != 0 || shared_memory_ring::DataOffset + capacity != segment.size) {
+            ::munmap(segment.mapping, segment.size);
+            return;
+        }
+        segments.push_back(segment);
+    }
+
+    void discover() {
+        DIR* directory = ::opendir(shared_memory_ring::Directory);
+        if (directory == nullptr) {
+            return;
+        }
+        std::string match = prefix + ".";
+        while (dirent* entry = ::readdir(directory)) {
+            std::string name = std::string("/") + entry->d_name;
+            if (std::string_view(entry->d_name).rfind(match, 0) == 0 && !known(name)) {
+                attach(name);
+            }
+        }
+        ::closedir(directory);
+    }
+
+    /**
+     * @brief Checks the slot at position against the ring, and returns its length through length.
+     */
+    static SlotState inspect(const Segment& segment, std::uint64_t position, std::uint64_t head, std::uint32_t& length) {
+        using shared_memory_ring::Slot;
+        std::uint64_t capacity = segment.header->capacity;
+        std::uint64_t offset = position & (capacity - 1);
+        std::uint64_t available = head - position;
+        auto* slot = reinterpret_cast<const Slot*>(segment.ring + offset);
+        std::uint32_t size = slot->size.load(std::memory_order_acquire);
+        if (size == 0) {
+            return SlotState::Unpublished;
+        }
+        length = size & ~shared_memory_ring::PaddingFlag;
+        if ((size & shared_memory_ring::PaddingFlag) != 0) {
+            return length == capacity - offset && length <= available ? SlotState::Padding : SlotState::Corrupt;
+        }
+        if (length % 8 != 0 || length < sizeof(Slot) || length > available || offset + length > capacity) {
+            return SlotState::Corrupt;
+        }
+        std::size_t textLength = length - sizeof(Slot);
+        if (slot->padding >= 8 || slot->padding > textLength || slot->prefixLength > textLength - slot->padding ||
+            slot->level > static_cast<int>(LogLevel::Noise)) {
+            return SlotState::Corrupt;
+        }
+        return SlotState::Record;
+    }
+
+    /**
+     * @brief Returns the position of the next valid slot after an abandoned one, or head if none.
+     */
+    static std::uint64_t resynchronize(const Segment& segment, std::uint64_t position, std::uint64_t head) {
+        for (position += 8; position < head; position += 8) {
+            std::uint32_t length = 0;
+            SlotState state = inspect(segment, position, head, length);
+            if (state == SlotState::Record || state == SlotState::Padding) {
+                return position;
+            }
+        }
+        return head;
+    }
+
+    static bool producerGone(const shared_memory_ring::Header& header) {
+        return header.closed.load(std::memory_order_acquire) != 0 || (::kill(header.pid, 0) != 0 && errno == ESRCH);
+    }
+
+    std::size_t drain(Segment& segment) {
+        using shared_memory_ring::Slot;
+        shared_memory_ring::Header& header = *segment.header;
+        std::uint64_t mask = header.capacity - 1;
+        std::uint64_t start = header.tail.load(std::memory_order_relaxed);
+        std::uint64_t tail = start;
+        std::uint64_t head = header.head.load(std::memory_order_acquire);
+        if (head < tail || head - tail > header.capacity) {
+            segment.corrupt = true;
+            return 0;
+        }
+        std::size_t count = 0;
+        while (tail < head) {
+            std::uint64_t offset = tail & mask;
+            std::uint32_t length = 0;
+            SlotState state = inspect(segment, tail, head, length);
+            if (state == SlotState::Unpublished) {
+                if (!producerGone(header)) {
+                    break; // Claimed but not published yet
+                }
+                header.dropped.fetch_add(1, std::memory_order_relaxed);
+                tail = resynchronize(segment, tail, head);
+                continue;
+            }
+            if (state == SlotState::Corrupt) {
+                segment.corrupt = true;
+                break;
+            }
+            if (state == SlotState::Record) {
+                auto* slot = reinterpret_cast<const Slot*>(segment.ring + offset);
+                const char* text = segment.ring + offset + sizeof(Slot);
+                std::size_t textLength = length - sizeof(Slot) - slot->padding;
+                std::string_view prefixText(text, slot->prefixLength);
+                std::string_view message(text + slot->prefixLength, textLength - slot->prefixLength);
+                LogRecord record(static_cast<LogLevel>(slot->level), message);
+                record.time = std::chrono::system_clock::time_point(
+                    std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(slot->time)));
+                if (!prefixText.empty()) {
+                    record.prepend(prefixText);
+                }
+                output->measuredWrite(record);
+                ++count;
+            }
+            tail += length;
+        }
+        if (tail != start && !segment.corrupt) {
+            // Zero the consumed bytes, so producers reusing them start from unpublished slots
+            for (std::uint64_t position = start; position < tail;) {
+                std::uint64_t offset = position & mask;
+                std::uint64_t chunk = std::min<std::uint64_t>(tail - position, header.capacity - offset);
+                std::memset(segment.ring + offset, 0, chunk);
+                position += chunk;
+            }
+            header.tail.store(tail, std::memory_order_release);
+        }
+        return count;
+    }
+
+    static bool finished(const shared_memory_ring::Header& header) {
+        if (header.tail.load(std::memory_order_acquire) != header.head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        return producerGone(header);
+    }
+
+public:
+    /**
+     * @brief Constructs a collector for the segments with the specified prefix.
+     * 
+     * @param prefix The prefix the producers were created with.
+     * @param output The output strategy every record is written to.
+     */
+    SharedMemoryCollector(std::string prefix, std::unique_ptr<IOutputStrategy> output)
+        : prefix(std::move(prefix)), output(std::move(output)) {}
+
+    /**
+     * @brief Unmaps every segment, leaving undrained ones for the next collector.
+     */
+    ~SharedMemoryCollector() {
+        for (Segment& segment : segments) {
+            ::munmap(segment.mapping, segment.size);
+        }
+    }
+
+    SharedMemoryCollector(const SharedMemoryCollector&) = delete;
+    SharedMemoryCollector& operator=(const SharedMemoryCollector&) = delete;
+
+    /**
+     * @brief Attaches new segments and writes every published record to the output.
+     * 
+     * @return The number of records written.
+     */
+    std::size_t poll() {
+        discover();
+        std::size_t count = 0;
+        for (auto it = segments.begin(); it != segments.end();) {
+            count += drain(*it);
+            if (it->corrupt || finished(*it->header)) {
+                retiredDrops += it->header->dropped.load(std::memory_order_relaxed);
+                ::munmap(it->mapping, it->size);
+                ::shm_unlink(it->name.c_str());
+                it = segments.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        if (count > 0) {
+            output->measuredFlush();
+        }
+        collected += count;
+        return count;
+    }
+
+    /**
+     * @brief Returns the number of segments currently attached.
+     */
+    std::size_t segmentCount() const {
+        return segments.size();
+    }
+
+    /**
+     * @brief Returns the number of records written to the output so far.
+     */
+    std::uint64_t collectedCount() const {
+        return collected;
+    }
+
+    /**
+     * @brief Returns the number of records the producers of every segment seen so far have dropped.
+     */
+    std::uint64_t droppedCount() const {
+        std::uint64_t total = retiredDrops;
+        for (const Segment& segment : segments) {
+            total += segment.header->dropped.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+};
+
+// Composite Output Strategy
+/**
+ * @brief A class that represents a multi-output strategy for logging.
+ * 
+ * This class inherits from the IOutputStrategy interface and allows multiple output strategies to be used simultaneously.
+ * When the `output` function is called, it forwards the log message to all the registered output strategies.
+ * FanOutOutput does the same with a queue and worker per output, so a slow output cannot delay the others.
+ */
+class MultiOutput : public IOutputStrategy {
+private:
+    std::vector<std::unique_ptr<IOutputStrategy>> outputs; /**< The vector of output strategies. */
+public:
+    /**
+     * @brief Constructs a MultiOutput object with the given output strategies.
+     * 
+     * @param outputs The vector of output strategies.
+     */
+    MultiOutput(std::vector<std::unique_ptr<IOutputStrategy>> outputs) : outputs(std::move(outputs)) {}
+
+    /**
+     * @brief Outputs the log message to all the registered output strategies.
+     * 
+     * @param message The log message to be outputted.
+     */
+    void output(const std::string& message) override {
+        for (auto& output : outputs) {
+            output->output(message);
+        }
+    }
+
+    /**
+     * @brief Outputs the log record to all the registered output strategies.
+     * 
+     * @param record The log record to be outputted.
+     */
+    void write(const LogRecord& record) override {
+        for (auto& output : outputs) {
+            output->measuredWrite(record);
+        }
+    }
+
+    /**
+     * @brief Flushes all the registered output strategies.
+     */
+    void flush() override {
+        for (auto& output : outputs) {
+            output->measuredFlush();
+        }
+    }
+
+    /**
+     * @brief Returns a snapshot of the telemetry of one of the registered output strategies.
+     * 
+     * @param index The index of the output strategy, in construction order.
+     */
+    TelemetrySnapshot outputStats(std::size_t index) const {
+        return outputs.at(index)->stats();
+    }
+};
+
+/**
+ * @brief A child sink of a FanOutOutput and how records are delivered to it.
+ */
+struct SinkConfig {
+    std::unique_ptr<IOutputStrategy> output;              /**< The sink. */
+    OverflowPolicy overflowPolicy = OverflowPolicy::Block; /**< What happens when the sink's queue is full. */
+    std::size_t queueCapacity = 8192;                     /**< Records that can wait for the sink. */
+    std::chrono::microseconds blockTimeout{1000};         /**< How long BlockWithTimeout waits for space. */
+};
+
+/**
+ * @brief A multi-output strategy that delivers to every sink from the sink's own thread.
+ * 
+ * Where MultiOutput writes to its outputs one after another on the calling thread, this class
+ * gives every sink a bounded queue and a worker thread. A record is serialized once into a
+ * reference-counted RecordPool slab that all queues share, so fanning out costs no
+ * allocation once the pool has warmed up, no matter how many sinks there are. A slow sink only
+ * fills its own queue: its OverflowPolicy decides whether the caller then waits, gives up after
+ * a timeout, evicts the oldest queued record or sheds by level, and every record dropped that
+ * way is dropped for that sink alone and counted in its stats; the other sinks carry on. Each
+ * sink is flushed by its worker whenever its queue runs empty, and every queued record is
+ * delivered before destruction completes.
+ * 
+ * flush() never waits for a sink, since loggers call it every time their own queue runs empty
+ * and a wedged sink would otherwise stall them and, through them, every other sink. Callers that
+ * need a barrier use waitDrained().
+ */
+class FanOutOutput : public IOutputStrategy {
+private:
+    using RecordPointer = PooledRecord;
+
+    class Sink {
+    public:
+        Sink(SinkConfig config)
+            : output(std::move(config.output)), overflowPolicy(config.overflowPolicy),
+              blockTimeout(config.blockTimeout), queue(config.queueCapacity) {
+            worker = std::thread([this] { run(); });
+        }
+
+        ~Sink() {
+            stopping.store(true, std::memory_order_release);
+            {
+                std::lock_guard<std::mutex> lock(wakeMutex);
+                wakeCondition.notify_one();
+            }
+            worker.join();
+        }
+
+        void push(const RecordPointer& record, LogLevel level) {
+            RecordPointer queued = record;
+            EnqueueResult result = enqueueWithPolicy(queue, queued, level, overflowPolicy, blockTimeout,
+                                                     [this] { wakeWorker(); });
+            if (result.evicted > 0) {
+                processed.fetch_add(result.evicted, std::memory_order_release);
+            }
+            std::size_t discarded = result.evicted + (result.queued ? 0 : 1);
+            if (discarded > 0) {
+                dropped.fetch_add(discarded, std::memory_order_relaxed);
+            }
+        }
+
+        void requestFlush() {
+            wakeWorker();
+        }
+
+        void waitDrained() {
+            std::size_t target = queue.pushedCount();
+            flushWaiters.fetch_add(1, std::memory_order_acq_rel);
+            {
+                std::unique_lock<std::mutex> lock(wakeMutex);
+                wakeCondition.notify_one();
+                drainedCondition.wait(lock, [this, target] {
+                    return flushedThrough.load(std::memory_order_acquire) >= target;
+                });
+            }
+            flushWaiters.fetch_sub(1, std::memory_order_acq_rel);
+        }
+
+        std::size_t droppedCount() const {
+            return dropped.load(std::memory_order_relaxed);
+        }
+
+        std::size_t depth() const {
+            return queue.size();
+        }
+
+        std::uint64_t peakDepthSeen() const {
+            return peakDepth.load(std::memory_order_relaxed);
+        }
+
+        TelemetrySnapshot childStats() const {
+            return output->stats();
+        }
+
+    private:
+        std::unique_ptr<IOutputStrategy> output;
+        OverflowPolicy overflowPolicy;
+        std::chrono::microseconds blockTimeout;
+        LockFreeRingBuffer<RecordPointer> queue;
+        std::atomic<bool> stopping{false};
+        std::atomic<bool> workerWaiting{false};
+        std::atomic<int> flushWaiters{0};
+        std::atomic<std::size_t> processed{0};
+        std::atomic<std::size_t> flushedThrough{0}; /**< Value of processed at the last flush of the sink. */
+        std::atomic<std::size_t> dropped{0};
+        std::atomic<std::uint64_t> peakDepth{0};
+        std::mutex wakeMutex;
+        std::condition_variable wakeCondition;
+        std::condition_variable drainedCondition;
+        std::thread worker;
+
+        void wakeWorker() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (workerWaiting.load(std::memory_order_relaxed)) {
+                std::lock_guard<std::mutex> lock(wakeMutex);
+                wakeCondition.notify_one();
+            }
+        }
+
+        bool drain() {
+            RecordPointer record;
+            bool drainedAny = false;
+            updatePeak(peakDepth, queue.size());
+            while (queue.tryPop(record)) {
+                LogRecord delivered = record.materialize();
+                output->measuredWrite(delivered);
+                record.reset();
+                processed.fetch_add(1, std::memory_order_release);
+                drainedAny = true;
+            }
+            return drainedAny;
+        }
+
+        void flushSink() {
+            std::size_t through = processed.load(std::memory_order_acquire);
+            output->measuredFlush();
+            flushedThrough.store(through, std::memory_order_release);
+        }
+
+        void run() {
+            for (;;) {
+                if (drain()) {
+                    if (flushWaiters.load(std::memory_order_acquire) > 0) {
+                        // A waiter is not kept waiting for the queue to run empty under load
+                        flushSink();
+                        std::lock_guard<std::mutex> lock(wakeMutex);
+                        drainedCondition.notify_all();
+                    }
+                    continue;
+                }
+                if (stopping.load(std::memory_order_acquire) && processed.load() == queue.pushedCount()) {
+                    break;
+                }
+
+                flushSink();
+                workerWaiting.store(true, std::memory_order_seq_cst);
+                {
+                    std::unique_lock<std::mutex> lock(wakeMutex);
+                    drainedCondition.notify_all();
+                    wakeCondition.wait_for(lock, std::chrono::milliseconds(100), [this] {
+                        return queue.size() > 0 || stopping.load(std::memory_order_acquire);
+                    });
+                }
+                workerWaiting.store(false, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    RecordPool pool; /**< Declared before the sinks, so it outlives their queued records. */
+    std::vector<std::unique_ptr<Sink>> sinks;
+
+public:
+    /**
+     * @brief Constructs a FanOutOutput and starts a worker for each sink.
+     * 
+     * @param configs The sinks and their delivery settings.
+     */
+    FanOutOutput(std::vector<SinkConfig> configs) {
+        for (SinkConfig& config : configs) {
+            sinks.push_back(std::make_unique<Sink>(std::move(config)));
+        }
+    }
+
+    /**
+     * @brief Queues the log message for every sink, with informational level.
+     * 
+     * @param message The log message to be outputted.
+     */
+    void output(const std::string& message) override {
+        write(LogRecord(LogLevel::Info, message));
+    }
+
+    /**
+     * @brief Serializes the record once and queues it for every sink.
+     * 
+     * @param record The log record to be outputted.
+     */
+    void write(const LogRecord& record) override {
+        RecordPointer pointer(record, pool);
+        for (auto& sink : sinks) {
+            sink->push(pointer, record.level);
+        }
+    }
+
+    /**
+     * @brief Wakes the sink workers so each writes out and flushes its queue, without waiting.
+     */
+    void flush() override {
+        for (auto& sink : sinks) {
+            sink->requestFlush();
+        }
+    }
+
+    /**
+     * @brief Blocks until every sink has written and flushed the records queued before the call.
+     * 
+     * Unlike flush(), this waits for the slowest sink.
+     */
+    void waitDrained() {
+        for (auto& sink : sinks) {
+            sink->waitDrained();
+        }
+    }
+
+    /**
+     * @brief Returns the number of records dropped for a sink because its queue was full.
+     * 
+     * @param sink The index of the sink, in construction order.
+     */
+    std::size_t droppedCount(std::size_t sink) const {
+        return sinks.at(sink)->droppedCount();
+    }
+
+    /**
+     * @brief Returns a snapshot of the telemetry of one sink, including its queue and drops.
+     * 
+     * @param sink The index of the sink, in construction order.
+     */
+    TelemetrySnapshot sinkStats(std::size_t sink) const {
+        const Sink& selected = *sinks.at(sink);
+        TelemetrySnapshot stats = selected.childStats();
+        stats.recordsDropped += selected.droppedCount();
+        stats.queueDepth = selected.depth();
+        stats.peakQueueDepth = selected.peakDepthSeen();
+        return stats;
+    }
+
+    /**
+     * @brief Returns the telemetry of the fan-out: records in, drops and queue depth summed over
+     * all sinks, and the deepest peak of any sink.
+     */
+    TelemetrySnapshot stats() const override {
+        TelemetrySnapshot stats = telemetry.snapshot();
+        for (const auto& sink : sinks) {
+            stats.recordsDropped += sink->droppedCount();
+            stats.queueDepth += sink->depth();
+            stats.peakQueueDepth = std::max(stats.peakQueueDepth, sink->peakDepthSeen());
+        }
+        return stats;
+    }
+};
+
+/**
+ * @brief The base class for logger decorators.
+ * 
+ * This class is derived from the ILogger interface and provides a common base for all logger decorators.
+ * Logger decorators can be used to add additional functionality to an existing logger.
+ */
+class ILoggerDecorator : public ILogger {
+protected:
+    std::unique_ptr<ILogger> logger;
+public:
+    /**
+     * @brief Constructs an ILoggerDecorator object with the specified logger.
+     * 
+     * @param logger The logger to be decorated.
+     */
+    ILoggerDecorator(std::unique_ptr<ILogger> logger) : logger(std::move(logger)) {
+        this->logger->parent = this;
+        refreshEnabledLevel();
+    }
+
+    /**
+     * @brief Default destructor.
+     */
+    virtual ~ILoggerDecorator() = default;
+
+protected:
+    /**
+     * @brief Forwards to the cached enabled level of the decorated logger.
+     */
+    int computeEnabledLevel() const override {
+        return logger->enabledLevel.load(std::memory_order_relaxed);
+    }
+};
+
+// Level Logger Decorator class
+/**
+ * @brief Decorator class that adds log level information to the log message.
+ */
+class LogLevelDecorator : public ILoggerDecorator {
+public:
+    /**
+     * @brief Constructs a LogLevelDecorator object with the specified logger.
+     * @param logger The logger to be decorated.
+     */
+    LogLevelDecorator(std::unique_ptr<ILogger> logger) : ILoggerDecorator(std::move(logger)) {}
+
+    /**
+     * @brief Logs the record with its log level prepended.
+     * @param record The log record.
+     */
+    void logRecord(LogRecord& record) override {
+        // Add log level to message
+        const char tag[] = {'[', static_cast<char>('0' + static_cast<int>(record.level)), ']', ' '};
+        record.prepend(std::string_view(tag, sizeof(tag)));
+        logger->logRecord(record);
+    }
+};
+
+// Level Filter Logger Decorator class
+/**
+ * @brief Decorator class that filters log messages based on the minimum log level.
+ * 
+ * The LevelFilterDecorator class is a concrete implementation of the ILoggerDecorator interface.
+ * It decorates an ILogger object and filters log messages based on the minimum log level specified.
+ * Log messages with a level lower than or equal to the minimum log level will be passed to the decorated logger.
+ */
+class LevelFilterDecorator : public ILoggerDecorator {
+private:
+    std::atomic<int> minLevel; /**< The minimum log level for filtering log messages. */
+    StripedCounter filtered;   /**< Records that reached logRecord() and were rejected. */
+public:
+    /**
+     * @brief Constructs a LevelFilterDecorator object with the specified logger and minimum log level.
+     * 
+     * @param logger The logger to be decorated.
+     * @param minLevel The minimum log level for filtering log messages. Default is LogLevel::Info.
+     */
+    LevelFilterDecorator(std::unique_ptr<ILogger> logger, LogLevel minLevel = LogLevel::Info) 
+        : ILoggerDecorator(std::move(logger)), minLevel(static_cast<int>(minLevel)) {
+        refreshEnabledLevel();
+    }
+
+    /**
+     * @brief Logs a message with the specified log level, if it meets the minimum log level requirement.
+     * 
+     * This function checks if the specified log level is lower than or equal to the minimum log level.
+     * If it is, the log message is passed to the decorated logger for logging.
+     * 
+     * @param record The log record to be logged.
+     */
+    void logRecord(LogRecord& record) override {
+        if (static_cast<int>(record.level) <= minLevel.load(std::memory_order_relaxed) || record.bypassFilters) {
+            logger->logRecord(record);
+        } else {
+            filtered.add();
+        }
+    }
+
+    /**
+     * @brief Returns the number of records filtered out by level.
+     * 
+     * This counts the records this decorator rejected and those that log() discarded up front,
+     * on this decorator or one wrapping it, because no layer below would accept their level.
+     * Calls skipped by the isEnabled() check of the CPPLOGGER_LOG macros are not counted, so
+     * that path stays free of any write.
+     */
+    std::uint64_t filteredCount() const {
+        return filtered.load() + disabledCountThroughParents();
+    }
+
+    /**
+     * @brief Sets the minimum log level for filtering log messages.
+     * 
+     * Safe to call while other threads are logging. The new level is published to the cached
+     * enabled level of every decorator wrapping this one.
+     * 
+     * @param newMinLevel The new minimum log level to be set.
+     */
+    void setMinLevel(LogLevel newMinLevel) {
+        std::lock_guard<std::mutex> lock(levelChangeMutex());
+        minLevel.store(static_cast<int>(newMinLevel), std::memory_order_relaxed);
+        refreshEnabledLevel();
+    }
+
+    /**
+     * @brief Returns the minimum log level for filtering log messages.
+     */
+    LogLevel getMinLevel() const {
+        return static_cast<LogLevel>(minLevel.load(std::memory_order_relaxed));
+    }
+
+protected:
+    int computeEnabledLevel() const override {
+        return std::min(minLevel.load(std::memory_order_relaxed), ILoggerDecorator::computeEnabledLevel());
+    }
+};
+
+// Log categories
+/**
+ * @brief A handle to a named category of a CategoryRegistry, such as "net.http".
+ * 
+ * The handle points straight at the category's slot in the registry's level array, so
+ * isEnabled() is one relaxed load and compare. Handles are cheap to copy and stay valid for
+ * the lifetime of the registry.
+ */
+class Category {
+public:
+    /**
+     * @brief Returns true if records at the specified level pass the category's effective level.
+     * 
+     * @param level The log level to check.
+     */
+    bool isEnabled(LogLevel level) const {
+        return static_cast<int>(level) <= slot->load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the effective level of the category.
+     */
+    LogLevel level() const {
+        return static_cast<LogLevel>(slot->load(std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief Returns the integer id the category was given at registration.
+     */
+    std::uint32_t id() const {
+        return index;
+    }
+
+    /**
+     * @brief Returns the dotted name of the category.
+     */
+    const std::string& name() const {
+        return *label;
+    }
+
+private:
+    friend class CategoryRegistry;
+    friend class CategoryDecorator;
+
+    Category(const std::atomic<int>* slot, std::uint32_t index, const std::string* label)
+        : slot(slot), index(index), label(label) {}
+
+    const std::atomic<int>* slot;
+    std::uint32_t index;
+    const std::string* label;
+};
+
+/**
+ * @brief A registry of hierarchical, dot-separated log categories.
+ * 
+ * Registering "net.http" also registers "net", and every category inherits the level of its
+ * parent until a level is set on it; the root category, named "", starts at Info. Names are
+ * resolved to ids once, at registration, and the effective levels live in one flat,
+ * cache-aligned array, so checking a level never looks at a name or takes a lock. Setting or
+ * clearing a level recomputes the whole array in one pass, since parents are always
+ * registered before their children, and then notifies the listeners, which is how
+ * CategoryDecorator refreshes its cached enabled level.
+ * 
+ * The registry must outlive its handles and decorators. global() returns the one the
+ * configuration factory uses.
+ */
+class CategoryRegistry {
+public:
+    static constexpr std::size_t MaxCategories = 512; /**< Categories a registry can hold, including the root. */
+
+    /**
+     * @brief Constructs a registry that holds only the root category.
+     * 
+     * @param rootLevel The level of the root category, which categories without a level inherit.
+     */
+    explicit CategoryRegistry(LogLevel rootLevel = LogLevel::Info) {
+        names.emplace_back();
+        parents.push_back(0);
+        explicitLevels.push_back(static_cast<int>(rootLevel));
+        levels[0].store(static_cast<int>(rootLevel), std::memory_order_relaxed);
+    }
+
+    CategoryRegistry(const CategoryRegistry&) = delete;
+    CategoryRegistry& operator=(const CategoryRegistry&) = delete;
+
+    /**
+     * @brief Returns the process-wide registry.
+     */
+    static CategoryRegistry& global() {
+        static CategoryRegistry registry;
+        return registry;
+    }
+
+    /**
+     * @brief Returns the handle of a category, registering it and its ancestors if needed.
+     * 
+     * @param name The dotted name, for example "storage.wal".
+     * @throws std::length_error if the registry is full.
+     */
+    Category get(std::string_view name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return handle(resolve(name));
+    }
+
+    /**
+     * @brief Sets the level of a category and of every descendant that has no level of its own.
+     * 
+     * @param name The dotted name; it is registered if needed.
+     * @param level The new level.
+     */
+    void setLevel(std::string_view name, LogLevel level) {
+        std::lock_guard<std::mutex> lock(mutex);
+        explicitLevels[resolve(name)] = static_cast<int>(level);
+        publish();
+    }
+
+    /**
+     * @brief Makes a category inherit its parent's level again. The root category keeps its level.
+     * 
+     * @param name The dotted name.
+     */
+    void clearLevel(std::string_view name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::uint32_t index = resolve(name);
+        if (index != 0) {
+            explicitLevels[index] = Inherit;
+            publish();
+        }
+    }
+
+    /**
+     * @brief Returns the effective level of a category.
+     * 
+     * @param name The dotted name; it is registered if needed.
+     */
+    LogLevel level(std::string_view name) {
+        return get(name).level();
+    }
+
+    /**
+     * @brief Returns the number of registered categories, including the root.
+     */
+    std::size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return names.size();
+    }
+
+    /**
+     * @brief Registers a function called after every level change.
+     * 
+     * The function is called with the registry's lock held, so it must not call back into the
+     * registry.
+     * 
+     * @param listener The function.
+     * @return A token for unsubscribe().
+     */
+    std::uint64_t subscribe(std::function<void()> listener) {
+        std::lock_guard<std::mutex> lock(mutex);
+        listeners.emplace_back(++lastToken, std::move(listener));
+        return lastToken;
+    }
+
+    /**
+     * @brief Removes a listener. It is not called again once this returns.
+     * 
+     * @param token The token subscribe() returned.
+     */
+    void unsubscribe(std::uint64_t token) {
+        std::lock_guard<std::mutex> lock(mutex);
+        listeners.erase(std::remove_if(listeners.begin(), listeners.end(),
+                                       [token](const auto& listener) { return listener.first == token; }),
+                        listeners.end());
+    }
+
+private:
+    static constexpr int Inherit = -1;
+
+    alignas(64) std::atomic<int> levels[MaxCategories]; /**< Effective level per category id. */
+    mutable std::mutex mutex;
+    std::deque<std::string> names; /**< Deque, so handles can keep pointers to the names. */
+    std::vector<std::uint32_t> parents;
+    std::vector<int> explicitLevels;
+    std::vector<std::pair<std::uint64_t, std::function<void()>>> listeners;
+    std::uint64_t lastToken = 0;
+
+    Category handle(std::uint32_t index) const {
+        return Category(&levels[index], index, &names[index]);
+    }
+
+    std::uint32_t resolve(std::string_view name) {
+        for (std::uint32_t i = 0; i < names.size(); ++i) {
+            if (names[i] == name) {
+                return i;
+            }
+        }
+        std::size_t dot = name.rfind('.');
+        std::uint32_t parent = dot == std::string_view::npos ? 0 : resolve(name.substr(0, dot));
+        if (names.size() == MaxCategories) {
+            throw std::length_error("Too many log categories");
+        }
+        auto index = static_cast<std::uint32_t>(names.size());
+        names.emplace_back(name);
+        parents.push_back(parent);
+        explicitLevels.push_back(Inherit);
+        levels[index].store(levels[parent].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return index;
+    }
+
+    void publish() {
+        for (std::size_t i = 0; i < names.size(); ++i) {
+            int level = explicitLevels[i] != Inherit ? explicitLevels[i] : levels[parents[i]].load(std::memory_order_relaxed);
+            levels[i].store(level, std::memory_order_relaxed);
+        }
+        for (const auto& listener : listeners) {
+            listener.second();
+        }
+    }
+};
+
+// Category Logger Decorator class
+/**
+ * @brief Decorator class that passes only records enabled for its category, tagged with its name.
+ * 
+ * Records below the category's effective level are dropped, and the others get "[name] "
+ * prepended. The decorator listens to its registry, so when the level of the category or of
+ * one of its ancestors changes, the cached enabled level of the chain follows and log() keeps
+ * rejecting disabled records with a single load.
+ */
+class CategoryDecorator : public ILoggerDecorator {
+private:
+    CategoryRegistry& registry;
+    Category category;
+    std::string tag;
+    std::uint64_t subscription;
+
+public:
+    /**
+     * @brief Constructs a CategoryDecorator for a category of the specified registry.
+     * 
+     * @param logger The logger to be decorated.
+     * @param registry The registry the category belongs to. It must outlive the decorator.
+     * @param category The category handle.
+     */
+    CategoryDecorator(std::unique_ptr<ILogger> logger, CategoryRegistry& registry, Category category)
+        : ILoggerDecorator(std::move(logger)), registry(registry), category(category),
+          tag("[" + category.name() + "] ") {
+        subscription = registry.subscribe([this] {
+            std::lock_guard<std::mutex> lock(levelChangeMutex());
+            refreshEnabledLevel();
+        });
+        refreshEnabledLevel();
+    }
+
+    /**
+     * @brief Constructs a CategoryDecorator for a category of the global registry.
+     * 
+     * @param logger The logger to be decorated.
+     * @param name The dotted category name.
+     */
+    CategoryDecorator(std::unique_ptr<ILogger> logger, std::string_view name)
+        : CategoryDecorator(std::move(logger), CategoryRegistry::global(), CategoryRegistry::global().get(name)) {}
+
+    ~CategoryDecorator() override {
+        registry.unsubscribe(subscription);
+    }
+
+    /**
+     * @brief Logs the record with the category name prepended if the category enables its level.
+     * 
+     * @param record The log record.
+     */
+    void logRecord(LogRecord& record) override {
+        if (!category.isEnabled(record.level) && !record.bypassFilters) {
+            return;
+        }
+        record.prepend(tag);
+        logger->logRecord(record);
+    }
+
+    /**
+     * @brief Returns the category handle.
+     */
+    const Category& getCategory() const {
+        return category;
+    }
+
+protected:
+    int computeEnabledLevel() const override {
+        return std::min(category.slot->load(std::memory_order_relaxed), ILoggerDecorator::computeEnabledLevel());
+    }
+};
+
+// Decorator timer
+/**
+ * @brief Runs the housekeeping of a decorator on a background thread.
+ * 
+ * Decorators that report on a schedule, such as a rate limit summary at the end of its window,
+ * cannot wait for the next record to come along. A DecoratorTimer calls a task from its own
+ * thread, each time after the delay the task returned. Callers of the decorator never wait for
+ * the timer: records the task logs reach the chain below from the timer thread, alongside those
+ * of the callers, so that chain must accept records from more than one thread, as it must for
+ * any decorator that is shared between threads.
+ */
+class DecoratorTimer {
+public:
+    /**
+     * @brief The task; it returns how long to wait before running it again.
+     */
+    using Task = std::function<std::chrono::nanoseconds()>;
+
+    DecoratorTimer() = default;
+    DecoratorTimer(const DecoratorTimer&) = delete;
+    DecoratorTimer& operator=(const DecoratorTimer&) = delete;
+
+    /**
+     * @brief Stops the timer thread, waiting for a running task to finish.
+     */
+    ~DecoratorTimer() {
+        stop();
+    }
+
+    /**
+     * @brief Starts the timer thread.
+     * 
+     * @param timerTask The task to run.
+     * @param firstDelay How long to wait before running it the first time.
+     */
+    void start(Task timerTask, std::chrono::nanoseconds firstDelay) {
+        task = std::move(timerTask);
+        worker = std::thread([this, firstDelay] { run(firstDelay); });
+    }
+
+    /**
+     * @brief Stops the timer thread; the task does not run again afterwards.
+     */
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            condition.notify_one();
+        }
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+private:
+    Task task;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping = false; /**< Guarded by mutex. */
+    std::thread worker;
+
+    void run(std::chrono::nanoseconds delay) {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!condition.wait_for(lock, delay, [this] { return stopping; })) {
+            lock.unlock();
+            delay = std::max(task(), std::chrono::nanoseconds(std::chrono::milliseconds(1)));
+            lock.lock();
+        }
+    }
+};
+
+// Rate Limit Logger Decorator class
+/**
+ * @brief What a RateLimitDecorator keeps a separate token bucket for.
+ */
+enum class RateLimitKey {
+    Level,   /**< One bucket per log level. */
+    CallSite /**< One bucket per call site of the CPPLOGGER_LOG macros; see RateLimitDecorator. */
+};
+
+/**
+ * @brief Settings of a RateLimitDecorator.
+ */
+struct RateLimitPolicy {
+    RateLimitKey key = RateLimitKey::CallSite;           /**< What gets its own bucket. */
+    double recordsPerSecond = 100;                       /**< Sustained rate each bucket lets through. */
+    std::size_t burst = 100;                             /**< Records a bucket lets through at once after being idle. */
+    LogLevel exemptLevel = LogLevel::Fatal;              /**< This level and more severe ones are never limited. */
+    LogLevel sampledLevel = LogLevel::Debug;             /**< This level and more verbose ones are sampled. */
+    std::uint32_t sampleEvery = 1;                       /**< Keep about one in this many sampled records; 1 keeps all. */
+    std::chrono::milliseconds summaryInterval{1000};     /**< How often suppressed records are reported. */
+};
+
+/**
+ * @brief Decorator class that limits the rate of log records and samples verbose levels.
+ * 
+ * Every bucket is a lock-free token bucket kept as a single atomic "theoretical arrival time"
+ * (the generic cell rate algorithm): a record passes if admitting it does not push that time
+ * further than the burst allows ahead of now, which is one load and one compare-and-swap.
+ * Buckets are a fixed table indexed by a hash of the key, so unrelated call sites can
+ * occasionally share one. For RateLimitKey::CallSite the key is LogRecord::site, which the
+ * CPPLOGGER_LOG macros set. Records without a site are keyed by the address of their format
+ * string if they are formatted calls, since that is a string literal of the call site, and by
+ * their level otherwise: the address of a plain message says nothing about where it came from.
+ * 
+ * Records at or below the sampled level are additionally kept with probability 1/sampleEvery,
+ * using a per-thread random generator. Records rejected by a bucket are counted, and at the end
+ * of every summary interval the decorator logs a Warning record for every bucket that rejected
+ * any, so a flood is still visible: 'suppressed N messages like "<text>"' quotes the first
+ * record a call site bucket rejected in the interval, and a level bucket, which has its own
+ * slots apart from the hashed ones, reports "suppressed N messages at level L". A DecoratorTimer does this if
+ * no record arrives to do it, from its own thread, so the decorated logger must accept records
+ * from more than one thread. A last summary is logged on destruction.
+ */
+class RateLimitDecorator : public ILoggerDecorator {
+public:
+    static constexpr std::size_t BucketCount = 128; /**< Size of the hashed part of the bucket table. */
+
+private:
+    static constexpr std::size_t LevelBucketCount = 6; /**< One bucket per LogLevel, after the hashed ones. */
+
+    struct alignas(64) Bucket {
+        std::atomic<std::int64_t> arrival{0};    /**< Theoretical arrival time in steady-clock nanoseconds. */
+        std::atomic<std::uint64_t> suppressed{0}; /**< Records rejected since the last summary. */
+        std::atomic_flag busy = ATOMIC_FLAG_INIT; /**< Guards sample. */
+        std::string sample;                       /**< The first record rejected since the last summary. */
+
+        void lock() {
+            while (busy.test_and_set(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+        }
+
+        void unlock() {
+            busy.clear(std::memory_order_release);
+        }
+    };
+
+    RateLimitPolicy policy;
+    std::int64_t interval;   /**< Nanoseconds between records at the sustained rate. */
+    std::int64_t tolerance;  /**< How far ahead of now the arrival time may run. */
+    Bucket buckets[BucketCount + LevelBucketCount];
+    std::atomic<std::int64_t> nextSummary;
+    StripedCounter suppressedTotal;
+    StripedCounter sampledOut;
+    DecoratorTimer timer;
+
+    static std::int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    std::size_t bucketIndex(const LogRecord& record) const {
+        const void* site = record.site;
+        if (site == nullptr && record.isDeferred()) {
+            site = record.message.data();
+        }
+        if (policy.key == RateLimitKey::Level || site == nullptr) {
+            return BucketCount + static_cast<std::size_t>(record.level) % LevelBucketCount;
+        }
+        auto address = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(site));
+        return static_cast<std::size_t>((address * 0x9E3779B97F4A7C15ull) >> 57) % BucketCount;
+    }
+
+    bool sampled() const {
+        static thread_local std::uint64_t state = 0x2545F4914F6CDD1Dull ^ reinterpret_cast<std::uintptr_t>(&state);
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state % policy.sampleEvery == 0;
+    }
+
+    bool admit(Bucket& bucket, std::int64_t time) {
+        std::int64_t arrival = bucket.arrival.load(std::memory_order_relaxed);
+        for (;;) {
+            std::int64_t next = std::max(arrival, time) + interval;
+            if (next - time > tolerance) {
+                return false;
+            }
+            if (bucket.arrival.compare_exchange_weak(arrival, next, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+    }
+
+    void summarize() {
+        for (std::size_t index = 0; index < BucketCount + LevelBucketCount; ++index) {
+            Bucket& bucket = buckets[index];
+            std::uint64_t count = bucket.suppressed.exchange(0, std::memory_order_relaxed);
+            if (count == 0) {
+                continue;
+            }
+            std::string text = "suppressed ";
+            appendFormatted(text, count);
+            text.append(count == 1 ? " message" : " messages");
+            if (index >= BucketCount) {
+                text.append(" at level ");
+                appendFormatted(text, index - BucketCount);
+            } else {
+                text.append(" like \"");
+                bucket.lock();
+                text.append(bucket.sample);
+                bucket.unlock();
+                text.push_back('"');
+            }
+            LogRecord summary(LogLevel::Warning, text);
+            logger->logRecord(summary);
+        }
+    }
+
+    /**
+     * @brief Counts a rejected record, keeping the text of the first one of the interval.
+     */
+    void suppress(Bucket& bucket, const LogRecord& record) {
+        suppressedTotal.add();
+        bool first = bucket.suppressed.fetch_add(1, std::memory_order_relaxed) == 0;
+        if (first && &bucket < buckets + BucketCount) {
+            static thread_local std::string scratch;
+            std::string_view message = record.messageText(scratch);
+            bucket.lock();
+            bucket.sample.assign(message);
+            bucket.unlock();
+        }
+    }
+
+    void summarizeIfDue(std::int64_t time) {
+        std::int64_t due = nextSummary.load(std::memory_order_relaxed);
+        if (time < due) {
+            return;
+        }
+        auto step = std::chrono::duration_cast<std::chrono::nanoseconds>(policy.summaryInterval).count();
+        if (nextSummary.compare_exchange_strong(due, time + step, std::memory_order_relaxed)) {
+            summarize();
+        }
+    }
+
+public:
+    /**
+     * @brief Constructs a RateLimitDecorator object with the specified logger and policy.
+     * 
+     * @param logger The logger to be decorated.
+     * @param policy The rates, sampling and summary interval.
+     */
+    RateLimitDecorator(std::unique_ptr<ILogger> logger, RateLimitPolicy policy = RateLimitPolicy())
+        : ILoggerDecorator(std::move(logger)), policy(policy) {
+        this->policy.sampleEvery = std::max<std::uint32_t>(this->policy.sampleEvery, 1);
+        double rate = std::max(this->policy.recordsPerSecond, 1e-9);
+        interval = static_cast<std::int64_t>(1e9 / rate);
+        tolerance = interval * static_cast<std::int64_t>(std::max<std::size_t>(this->policy.burst, 1));
+        auto step = std::chrono::duration_cast<std::chrono::nanoseconds>(this->policy.summaryInterval);
+        nextSummary.store(now() + step.count(), std::memory_order_relaxed);
+        timer.start([this] {
+            std::int64_t time = now();
+            summarizeIfDue(time);
+            return std::chrono::nanoseconds(nextSummary.load(std::memory_order_relaxed) - time);
+        }, step);
+    }
+
+    /**
+     * @brief Logs a summary of the records suppressed since the last one.
+     */
+    ~RateLimitDecorator() override {
+        timer.stop();
+        summarize();
+    }
+
+    /**
+     * @brief Passes the record on if sampling keeps it and its bucket has a token left.
+     * 
+     * @param record The record to be logged.
+     */
+    void logRecord(LogRecord& record) override {
+        int level = static_cast<int>(record.level);
+        if (level <= static_cast<int>(policy.exemptLevel) || record.bypassFilters) {
+            logger->logRecord(record);
+            return;
+        }
+        if (level >= static_cast<int>(policy.sampledLevel) && policy.sampleEvery > 1 && !sampled()) {
+            sampledOut.add();
+            return;
+        }
+
+        std::int64_t time = now();
+        summarizeIfDue(time);
+        Bucket& bucket = buckets[bucketIndex(record)];
+        if (!admit(bucket, time)) {
+            suppress(bucket, record);
+            return;
+        }
+        logger->logRecord(record);
+    }
+
+    /**
+     * @brief Returns the number of records rejected by a token bucket.
+     */
+    std::uint64_t suppressedCount() const {
+        return suppressedTotal.load();
+    }
+
+    /**
+     * @brief Returns the number of records dropped by sampling.
+     */
+    std::uint64_t sampledOutCount() const {
+        return sampledOut.load();
+    }
+};
+
+// Duplicate Suppression Logger Decorator class
+/**
+ * @brief Settings of a DuplicateSuppressionDecorator.
+ */
+struct DuplicateSuppressionPolicy {
+    std::chrono::milliseconds maxHold{1000}; /**< Longest a run of repeats is held before it is reported. */
+};
+
+/**
+ * @brief Decorator class that collapses repeated messages into a single "repeated" record.
+ * 
+ * Every message is hashed, together with its level, into a small table of cache-line aligned
+ * slots. A slot remembers the last message that hashed to it; when the same message arrives
+ * again it is only counted. When a different message takes over the slot, or the run has been
+ * held longer than maxHold, the decorator logs 'message repeated N times: "<text>"' at the level
+ * of the repeated message, so a retry loop costs one record per run instead of one per attempt.
+ * The report quotes the message because it usually arrives after other messages, which hash
+ * to different slots and do not end the run.
+ * A DecoratorTimer reports a run that is followed by silence once it has been held for maxHold,
+ * from its own thread, so the decorated logger must accept records from more than one thread;
+ * held runs are also reported on destruction. Only the message text and level are
+ * compared, so prefixes added by decorators wrapping this one, such as timestamps, do not break
+ * up a run.
+ * 
+ * Each slot has its own spinlock that is held only to compare and count, never while logging,
+ * so threads only contend when they log messages that hash to the same slot. The timer reads
+ * the time a slot's held run is due without the lock and only locks slots that are due. A repeat does not
+ * allocate: the comparison runs against the copy kept in the slot, whose buffer is reused.
+ */
+class DuplicateSuppressionDecorator : public ILoggerDecorator {
+public:
+    static constexpr std::size_t SlotCount = 64; /**< Size of the recent-message table. */
+
+private:
+    struct alignas(64) Slot {
+        std::atomic_flag busy = ATOMIC_FLAG_INIT;
+        std::uint64_t hash = 0;
+        bool used = false;
+        LogLevel level = LogLevel::Info;
+        std::uint64_t repeats = 0;
+        std::int64_t runStart = 0; /**< When the slot last reported or took a new message, in steady-clock nanoseconds. */
+        std::atomic<std::int64_t> dueAt{0}; /**< When held repeats must be reported; 0 while none are held. */
+        std::string text;
+
+        void lock() {
+            while (busy.test_and_set(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+        }
+
+        void unlock() {
+            busy.clear(std::memory_order_release);
+        }
+    };
+
+    DuplicateSuppressionPolicy policy;
+    Slot slots[SlotCount];
+    std::atomic<std::int64_t> nextScan;
+    StripedCounter suppressed;
+    DecoratorTimer timer;
+
+    static std::int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    std::int64_t holdNanoseconds() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(policy.maxHold).count();
+    }
+
+    static std::uint64_t hashOf(LogLevel level, std::string_view text) {
+        std::uint64_t hash = 14695981039346656037ull ^ static_cast<std::uint64_t>(level);
+        for (char c : text) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    static void describeRun(std::string& out, std::uint64_t repeats, std::string_view text) {
+        out.assign("message repeated ");
+        appendFormatted(out, repeats);
+        out.append(repeats == 1 ? " time: \"" : " times: \"");
+        out.append(text);
+        out.push_back('"');
+    }
+
+    void report(LogLevel level, std::string_view summaryText) {
+        LogRecord summary(level, summaryText);
+        logger->logRecord(summary);
+    }
+
+    /**
+     * @brief Reports every run held longer than maxHold.
+     * 
+     * @return How long until the next held run reaches maxHold, or maxHold if none is held.
+     */
+    std::int64_t reportHeld(std::int64_t time) {
+        std::string summary;
+        std::int64_t next = holdNanoseconds();
+        for (Slot& slot : slots) {
+            std::int64_t due = slot.dueAt.load(std::memory_order_relaxed);
+            if (due == 0) {
+                continue;
+            }
+            if (due > time) {
+                next = std::min(next, due - time);
+                continue;
+            }
+            slot.lock();
+            std::uint64_t repeats = 0;
+            LogLevel level = slot.level;
+            if (slot.repeats > 0) {
+                std::int64_t remaining = slot.runStart + holdNanoseconds() - time;
+                if (remaining <= 0) {
+                    repeats = slot.repeats;
+                    describeRun(summary, repeats, slot.text);
+                    slot.repeats = 0;
+                    slot.runStart = time;
+                    slot.dueAt.store(0, std::memory_order_relaxed);
+                } else {
+                    next = std::min(next, remaining);
+                }
+            }
+            slot.unlock();
+            if (repeats > 0) {
+                report(level, summary);
+            }
+        }
+        return next;
+    }
+
+    /**
+     * @brief Reports every run held longer than maxHold, at most once per maxHold.
+     */
+    void scanIfDue(std::int64_t time) {
+        std::int64_t due = nextScan.load(std::memory_order_relaxed);
+        if (time < due || !nextScan.compare_exchange_strong(due, time + holdNanoseconds(), std::memory_order_relaxed)) {
+            return;
+        }
+        reportHeld(time);
+    }
+
+public:
+    /**
+     * @brief Constructs a DuplicateSuppressionDecorator object with the specified logger and policy.
+     * 
+     * @param logger The logger to be decorated.
+     * @param policy How long runs of repeats may be held.
+     */
+    DuplicateSuppressionDecorator(std::unique_ptr<ILogger> logger, DuplicateSuppressionPolicy policy = DuplicateSuppressionPolicy())
+        : ILoggerDecorator(std::move(logger)), policy(policy), nextScan(now() + holdNanoseconds()) {
+        for (Slot& slot : slots) {
+            slot.text.reserve(256);
+        }
+        timer.start([this] { return std::chrono::nanoseconds(reportHeld(now())); }, policy.maxHold);
+    }
+
+    /**
+     * @brief Reports every run that is still held.
+     */
+    ~DuplicateSuppressionDecorator() override {
+        timer.stop();
+        std::string summary;
+        for (Slot& slot : slots) {
+            if (slot.repeats > 0) {
+                describeRun(summary, slot.repeats, slot.text);
+                report(slot.level, summary);
+            }
+        }
+    }
+
+    /**
+     * @brief Passes the record on unless it repeats the last message of its slot.
+     * 
+     * @param record The record to be logged.
+     */
+    void logRecord(LogRecord& record) override {
+        if (record.bypassFilters) {
+            logger->logRecord(record);
+            return;
+        }
+        static thread_local std::string scratch;
+        std::string_view message = record.messageText(scratch);
+        std::uint64_t hash = hashOf(record.level, message);
+        std::int64_t time = now();
+        scanIfDue(time);
+
+        Slot& slot = slots[hash % SlotCount];
+        slot.lock();
+        bool repeated = slot.used && slot.hash == hash && slot.level == record.level && slot.text == message;
+        if (repeated) {
+            if (slot.repeats++ == 0) {
+                slot.dueAt.store(slot.runStart + holdNanoseconds(), std::memory_order_relaxed);
+            }
+            slot.unlock();
+            suppressed.add();
+            return;
+        }
+        std::uint64_t endedRun = slot.repeats;
+        LogLevel endedLevel = slot.level;
+        std::string summary; // Only allocates when a run ended
+        if (endedRun > 0) {
+            describeRun(summary, endedRun, slot.text);
+        }
+        slot.used = true;
+        slot.hash = hash;
+        slot.level = record.level;
+        slot.repeats = 0;
+        slot.runStart = time;
+        slot.dueAt.store(0, std::memory_order_relaxed);
+        slot.text.assign(message);
+        slot.unlock();
+
+        if (endedRun > 0) {
+            report(endedLevel, summary);
+        }
+        logger->logRecord(record);
+    }
+
+    /**
+     * @brief Returns the number of records collapsed into "message repeated" records.
+     */
+    std::uint64_t suppressedCount() const {
+        return suppressed.load();
+    }
+};
+
+// Timestamp formatting
+/**
+ * @brief The fractional-second precision of a formatted timestamp.
+ */
+enum class TimestampPrecision {
+    Seconds,
+    Milliseconds,
+    Microseconds
+};
+
+/**
+ * @brief The time zone a timestamp is rendered in.
+ */
+enum class TimeZone {
+    Local,
+    Utc
+};
+
+/**
+ * @brief Formats time points as "%F %T" timestamps with optional fractional seconds.
+ * 
+ * Breaking a time point down into calendar fields is the expensive part of formatting, so each
+ * thread keeps the rendered "YYYY-MM-DD HH:MM:SS" text of the last second it formatted and only
+ * recomputes it when the second changes. The fractional part is appended with plain digit
+ * arithmetic. The calendar conversion uses the reentrant localtime_r/gmtime_r, so formatting
+ * is safe from any number of threads and never touches streams or locales.
+ */
+class TimestampFormatter {
+public:
+    static constexpr std::size_t SecondsLength = 19; /**< Length of "YYYY-MM-DD HH:MM:SS". */
+    static constexpr std::size_t MaxLength = 26;     /**< Length of the longest timestamp, with microseconds. */
+
+    /**
+     * @brief Constructs a TimestampFormatter with the specified precision and time zone.
+     * 
+     * @param precision The fractional-second precision to append.
+     * @param zone The time zone to render timestamps in.
+     */
+    TimestampFormatter(TimestampPrecision precision = TimestampPrecision::Seconds, TimeZone zone = TimeZone::Local)
+        : precision(precision), zone(zone) {}
+
+    /**
+     * @brief Formats a time point into the specified buffer.
+     * 
+     * @param time The time point to format.
+     * @param out The buffer to write to. It must have room for at least MaxLength characters.
+     * @return The number of characters written. The output is not null-terminated.
+     */
+    std::size_t format(std::chrono::system_clock::time_point time, char* out) const {
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+        std::int64_t seconds = micros / 1000000;
+        std::int64_t fraction = micros % 1000000;
+        if (fraction < 0) {
+            fraction += 1000000;
+            --seconds;
+        }
+
+        const char* cached = cachedSeconds(static_cast<std::time_t>(seconds));
+        std::copy(cached, cached + SecondsLength, out);
+        std::size_t length = SecondsLength;
+
+        int digits = precision == TimestampPrecision::Milliseconds ? 3
+                   : precision == TimestampPrecision::Microseconds ? 6 : 0;
+        if (digits == 3) {
+            fraction /= 1000;
+        }
+        if (digits > 0) {
+            out[length++] = '.';
+            for (int i = digits - 1; i >= 0; --i) {
+                out[length + i] = static_cast<char>('0' + fraction % 10);
+                fraction /= 10;
+            }
+            length += digits;
+        }
+        return length;
+    }
+
+    /**
+     * @brief Formats a time point into a new string.
+     * 
+     * @param time The time point to format.
+     * @return The formatted timestamp.
+     */
+    std::string format(std::chrono::system_clock::time_point time) const {
+        char buffer[MaxLength];
+        return std::string(buffer, format(time, buffer));
+    }
+
+private:
+    TimestampPrecision precision;
+    TimeZone zone;
+
+    struct SecondCache {
+        std::time_t second = 0;
+        bool valid = false;
+        char text[SecondsLength + 1];
+    };
+
+    const char* cachedSeconds(std::time_t second) const {
+        static thread_local SecondCache caches[2];
+        SecondCache& cache = caches[zone == TimeZone::Utc ? 1 : 0];
+        if (!cache.valid || cache.second != second) {
+            std::tm calendar{};
+#if defined(_WIN32)
+            if (zone == TimeZone::Utc) {
+                gmtime_s(&calendar, &second);
+            } else {
+                localtime_s(&calendar, &second);
+            }
+#else
+            if (zone == TimeZone::Utc) {
+                gmtime_r(&second, &calendar);
+            } else {
+                localtime_r(&second, &calendar);
+            }
+#endif
+            std::strftime(cache.text, sizeof(cache.text), "%F %T", &calendar);
+            cache.second = second;
+            cache.valid = true;
+        }
+        return cache.text;
+    }
+};
+
+// Timestamp Logger Decorator class
+/**
+ * @brief Decorator class that adds a timestamp to log messages.
+ * 
+ * This class inherits from the ILoggerDecorator interface and wraps an existing ILogger object.
+ * It adds a timestamp to the log messages before forwarding them to the wrapped logger.
+ * Timestamps are rendered by a TimestampFormatter, which reformats the date and time at most
+ * once per second per thread.
+ */
+class TimestampDecorator : public ILoggerDecorator {
+private:
+    TimestampFormatter formatter;
+public:
+    /**
+     * @brief Constructs a TimestampDecorator object with the specified logger.
+     * 
+     * @param logger The logger object to be wrapped.
+     * @param precision The fractional-second precision of the timestamp. Default is whole seconds.
+     * @param zone The time zone of the timestamp. Default is local time.
+     */
+    TimestampDecorator(std::unique_ptr<ILogger> logger,
+                       TimestampPrecision precision = TimestampPrecision::Seconds,
+                       TimeZone zone = TimeZone::Local)
+        : ILoggerDecorator(std::move(logger)), formatter(precision, zone) {}
+
+    /**
+     * @brief Stamps the record with the current time, unless it already carries one, and
+     * prepends the formatted timestamp to it.
+     * 
+     * @param record The record to be logged.
+     */
+    void logRecord(LogRecord& record) override {
+        if (!record.hasTime()) {
+            record.time = std::chrono::system_clock::now();
+        }
+
+        // Add timestamp to message
+        char timestamp[TimestampFormatter::MaxLength + 3];
+        timestamp[0] = '[';
+        std::size_t length = 1 + formatter.format(record.time, timestamp + 1);
+        timestamp[length++] = ']';
+        timestamp[length++] = ' ';
+        record.prepend(std::string_view(timestamp, length));
+        logger->logRecord(record);
+    }
+};
+
+// Logging context
+/**
+ * @brief Key-value context that code running on a thread attaches to every record it logs.
+ * 
+ * push() adds a field to the context of the calling thread and returns a Scope that removes it
+ * again, so nested scopes (a request, then a shard within it) stack naturally. The serialized
+ * prefix, "[key=value key=value] ", and the matching LogField array are rebuilt only when the
+ * context changes, not per record; ContextDecorator then attaches the cached result to each
+ * record without formatting or allocating anything.
+ * 
+ * The context belongs to the thread that pushed it. A Scope must be destroyed on that thread.
+ */
+class LogContext {
+public:
+    /**
+     * @brief Removes the fields pushed with it, and any pushed after them, when destroyed.
+     */
+    class Scope {
+    public:
+        Scope(Scope&& other) noexcept : depth(other.depth) {
+            other.depth = NotActive;
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        Scope& operator=(Scope&&) = delete;
+
+        ~Scope() {
+            if (depth != NotActive) {
+                truncate(depth);
+            }
+        }
+
+    private:
+        friend class LogContext;
+
+        static constexpr std::size_t NotActive = static_cast<std::size_t>(-1);
+
+        explicit Scope(std::size_t depth) : depth(depth) {}
+
+        std::size_t depth;
+    };
+
+    /**
+     * @brief Adds a field to the context of the calling thread.
+     * 
+     * @param key The name of the field.
+     * @param value The value, formatted once with the rules of formatMessage().
+     * @return A scope that removes the field when it is destroyed.
+     */
+    template <typename T>
+    [[nodiscard]] static Scope push(std::string_view key, const T& value) {
+        State& current = state();
+        std::size_t depth = current.entries.size();
+        current.entries.emplace_back();
+        Entry& entry = current.entries.back();
+        entry.key.assign(key);
+        appendFormatted(entry.value, value);
+        current.dirty = true;
+        return Scope(depth);
+    }
+
+    /**
+     * @brief Returns the serialized context of the calling thread, or an empty view if it has none.
+     * 
+     * The view stays valid until the context of the thread changes.
+     */
+    static std::string_view prefix() {
+        return current().prefix;
+    }
+
+    /**
+     * @brief Returns the context of the calling thread as string fields.
+     * 
+     * The view stays valid until the context of the thread changes.
+     */
+    static LogFields fields() {
+        const State& built = current();
+        return LogFields{built.fields.data(), built.fields.size()};
+    }
+
+    /**
+     * @brief Returns the number of fields in the context of the calling thread.
+     */
+    static std::size_t size() {
+        return state().entries.size();
+    }
+
+private:
+    struct Entry {
+        std::string key;
+        std::string value;
+    };
+
+    struct State {
+        std::vector<Entry> entries;
+        std::string prefix;
+        std::vector<LogField> fields;
+        bool dirty = false;
+    };
+
+    static State& state() {
+        static thread_local State current;
+        return current;
+    }
+
+    static const State& current() {
+        State& current = state();
+        if (current.dirty) {
+            current.prefix.clear();
+            current.fields.clear();
+            for (const Entry& entry : current.entries) {
+                current.prefix.append(current.prefix.empty() ? "[" : " ");
+                current.prefix.append(entry.key);
+                current.prefix.push_back('=');
+                current.prefix.append(entry.value);
+                current.fields.emplace_back(entry.key, entry.value);
+            }
+            if (!current.prefix.empty()) {
+                current.prefix.append("] ");
+            }
+            current.dirty = false;
+        }
+        return current;
+    }
+
+    static void truncate(std::size_t depth) {
+        State& current = state();
+        if (depth < current.entries.size()) {
+            current.entries.resize(depth);
+            current.dirty = true;
+        }
+    }
+};
+
+/**
+ * @brief Selects how ContextDecorator attaches the context to a record.
+ */
+enum class ContextPlacement {
+    Prefix, /**< Prepend the cached "[key=value ...] " text, for text outputs. */
+    Fields, /**< Add the context as structured fields, for outputs such as JsonOutput. */
+    Both    /**< Do both. */
+};
+
+// Context Logger Decorator class
+/**
+ * @brief Decorator class that attaches the LogContext of the logging thread to each record.
+ * 
+ * The context is read on the thread that calls log(), so the decorator must sit above any
+ * logger that hands records to another thread, such as AsyncLogger. Attaching the prefix is a
+ * copy into the headroom of the record. Context fields reference the cached array directly
+ * when the record has no fields of its own; otherwise both are combined in a buffer on the
+ * stack.
+ */
+class ContextDecorator : public ILoggerDecorator {
+private:
+    ContextPlacement placement;
+
+    static constexpr std::size_t InlineFields = 16; /**< Combined fields that fit without allocating. */
+
+    void logWithFields(LogRecord& record, LogFields context) {
+        LogFields own = record.fields;
+        std::size_t total = own.size() + context.size();
+        LogField inlineFields[InlineFields];
+        std::vector<LogField> heapFields;
+        LogField* combined = inlineFields;
+        if (total > InlineFields) {
+            heapFields.resize(total);
+            combined = heapFields.data();
+        }
+        std::copy(context.begin(), context.end(), combined);
+        std::copy(own.begin(), own.end(), combined + context.size());
+        record.fields = LogFields{combined, total};
+        logger->logRecord(record);
+        record.fields = own;
+    }
+
+public:
+    /**
+     * @brief Constructs a ContextDecorator object with the specified logger.
+     * 
+     * @param logger The logger object to be wrapped.
+     * @param placement How the context is attached to records. Default is a text prefix.
+     */
+    ContextDecorator(std::unique_ptr<ILogger> logger, ContextPlacement placement = ContextPlacement::Prefix)
+        : ILoggerDecorator(std::move(logger)), placement(placement) {}
+
+    /**
+     * @brief Attaches the context of the calling thread to the record and passes it on.
+     * 
+     * @param record The record to be logged.
+     */
+    void logRecord(LogRecord& record) override {
+        if (LogContext::size() == 0) {
+            logger->logRecord(record);
+            return;
+        }
+        if (placement != ContextPlacement::Fields) {
+            record.prepend(LogContext::prefix());
+        }
+        if (placement == ContextPlacement::Prefix) {
+            logger->logRecord(record);
+        } else if (record.fields.empty()) {
+            record.fields = LogContext::fields();
+            logger->logRecord(record);
+            record.fields = LogFields();
+        } else {
+            logWithFields(record, LogContext::fields());
+        }
+    }
+};
+
+// Flight Recorder Logger Decorator class
+/**
+ * @brief Configures a FlightRecorderDecorator.
+ */
+struct FlightRecorderOptions {
+    std::size_t capacity = 1024;            /**< Records kept per thread; the oldest are overwritten. */
+    LogLevel triggerLevel = LogLevel::Fatal; /**< Records at this level or more severe replay the recording first. */
+};
+
+/**
+ * @brief Decorator class that keeps the records the loggers below it would discard, and
+ * replays them when something goes wrong.
+ * 
+ * Placed in front of a LevelFilterDecorator, the recorder accepts every level. Records the
+ * wrapped chain is enabled for pass straight through; the others are copied into a ring of the
+ * last FlightRecorderOptions::capacity records of the logging thread, overwriting the oldest.
+ * Each ring belongs to one thread and is guarded by a spinlock that only a dump ever contends
+ * for, so recording costs a copy into reused storage and no I/O.
+ * 
+ * The recording is replayed through the wrapped chain, oldest record first across all
+ * threads, with LogRecord::bypassFilters set so that the filters let it through: before a
+ * record at the trigger level (Fatal by default) is written, when dump() is called, or on the
+ * next record after a signal installed with dumpOnSignal() arrives. Replayed records are
+ * removed from the rings.
+ */
+class FlightRecorderDecorator : public ILoggerDecorator {
+private:
+    struct Ring {
+        std::atomic<bool> busy{false};
+        std::vector<StoredRecord> slots;
+        std::size_t next = 0;
+        std::size_t count = 0;
+
+        void lock() {
+            while (busy.exchange(true, std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+        }
+
+        void unlock() {
+            busy.store(false, std::memory_order_release);
+        }
+    };
+
+    FlightRecorderOptions options;
+    PerThread<Ring> rings;
+    std::mutex dumpMutex;
+    StripedCounter recorded;
+    std::atomic<std::uint64_t> replayed{0};
+    std::atomic<std::uint64_t> handledSignals;
+
+    static std::atomic<std::uint64_t>& signalCount() {
+        static std::atomic<std::uint64_t> count{0};
+        return count;
+    }
+
+    static void onSignal(int) {
+        signalCount().fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void capture(const LogRecord& record) {
+        Ring& ring = rings.local();
+        ring.lock();
+        if (ring.slots.empty()) {
+            ring.slots.resize(options.capacity);
+        }
+        StoredRecord& slot = ring.slots[ring.next];
+        slot.assign(record);
+        if (!record.hasTime()) {
+            slot.time = std::chrono::system_clock::now();
+        }
+        ring.next = (ring.next + 1) % options.capacity;
+        ring.count = std::min(ring.count + 1, options.capacity);
+        ring.unlock();
+        recorded.add();
+    }
+
+protected:
+    /**
+     * @brief Accepts every level, since the recorder keeps what the chain below would discard.
+     */
+    int computeEnabledLevel() const override {
+        return static_cast<int>(LogLevel::Noise);
+    }
+
+public:
+    /**
+     * @brief Constructs a FlightRecorderDecorator object with the specified logger and options.
+     * 
+     * @param logger The logger to be decorated, usually a LevelFilterDecorator.
+     * @param options The per-thread capacity and the trigger level.
+     */
+    FlightRecorderDecorator(std::unique_ptr<ILogger> logger, FlightRecorderOptions options = FlightRecorderOptions())
+        : ILoggerDecorator(std::move(logger)), options(options), handledSignals(signalCount().load()) {
+        this->options.capacity = std::max<std::size_t>(this->options.capacity, 1);
+        refreshEnabledLevel();
+    }
+
+    /**
+     * @brief Replays the recording if the record is severe enough, then passes the record on or
+     * records it.
+     * 
+     * @param record The record to be logged.
+     */
+    void logRecord(LogRecord& record) override {
+        std::uint64_t signals = signalCount().load(std::memory_order_relaxed);
+        if (signals != handledSignals.load(std::memory_order_relaxed)) {
+            handledSignals.store(signals, std::memory_order_relaxed);
+            dump();
+        }
+        if (static_cast<int>(record.level) <= static_cast<int>(options.triggerLevel)) {
+            dump();
+            logger->logRecord(record);
+        } else if (record.bypassFilters || logger->isEnabled(record.level)) {
+            logger->logRecord(record);
+        } else {
+            capture(record);
+        }
+    }
+
+    /**
+     * @brief Replays every recorded record through the wrapped logger and empties the rings.
+     * 
+     * A Warning announcing the number of records precedes them.
+     * 
+     * @return The number of records replayed.
+     */
+    std::size_t dump() {
+        std::lock_guard<std::mutex> lock(dumpMutex);
+        std::vector<StoredRecord> collected;
+        rings.forEach([&collected](Ring& ring) {
+            ring.lock();
+            std::size_t capacity = ring.slots.size();
+            for (std::size_t i = 0; i < ring.count; ++i) {
+                collected.push_back(std::move(ring.slots[(ring.next + capacity - ring.count + i) % capacity]));
+            }
+            ring.count = 0;
+            ring.unlock();
+        });
+        if (collected.empty()) {
+            return 0;
+        }
+        std::stable_sort(collected.begin(), collected.end(), [](const StoredRecord& a, const StoredRecord& b) {
+            return a.time < b.time;
+        });
+
+        char text[64];
+        int length = std::snprintf(text, sizeof(text), "flight recorder: replaying %zu records", collected.size());
+        LogRecord announcement(LogLevel::Warning, std::string_view(text, static_cast<std::size_t>(length)));
+        announcement.bypassFilters = true;
+        logger->logRecord(announcement);
+        for (const StoredRecord& stored : collected) {
+            LogRecord replay = stored.materialize();
+            replay.bypassFilters = true;
+            logger->logRecord(replay);
+        }
+        replayed.fetch_add(collected.size(), std::memory_order_relaxed);
+        return collected.size();
+    }
+
+    /**
+     * @brief Makes the specified signal, for example SIGUSR1, replay the recording of every
+     * FlightRecorderDecorator.
+     * 
+     * The handler only counts the signal, which is async-signal-safe; each recorder replays on
+     * the next record logged through it, or when dump() is called.
+     * 
+     * @param signal The signal number.
+     */
+    static void dumpOnSignal(int signal) {
+        std::signal(signal, &FlightRecorderDecorator::onSignal);
+    }
+
+    /**
+     * @brief Returns the number of records copied into the rings so far.
+     */
+    std::uint64_t recordedCount() const {
+        return recorded.load();
+    }
+
+    /**
+     * @brief Returns the number of records replayed so far.
+     */
+    std::uint64_t replayedCount() const {
+        return replayed.load(std::memory_order_relaxed);
+    }
+};
+
+// JSON encoding
+namespace json_encoding {
+
+/**
+ * @brief Returns true if a byte must be escaped inside a JSON string.
+ */
+inline bool needsEscape(char c) {
+    return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+}
+
+/**
+ * @brief Returns the position of the first byte at or after from that must be escaped, or size.
+ * 
+ * The scan looks at 32 bytes per step with AVX2 and 16 with SSE2, and at one byte at a time
+ * only for the tail, or everywhere when neither instruction set is available at compile time.
+ * 
+ * @param data The text to scan.
+ * @param size The length of the text.
+ * @param from Where to start scanning.
+ */
+inline std::size_t findEscape(const char* data, std::size_t size, std::size_t from) {
+    std::size_t i = from;
+#if defined(__AVX2__)
+    const __m256i quote32 = _mm256_set1_epi8('"');
+    const __m256i backslash32 = _mm256_set1_epi8('\\');
+    const __m256i control32 = _mm256_set1_epi8(0x1F);
+    for (; i + 32 <= size; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i special = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote32), _mm256_cmpeq_epi8(chunk, backslash32)),
+            _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, control32), chunk));
+        auto mask = static_cast<unsigned>(_mm256_movemask_epi8(special));
+        if (mask != 0) {
+            return i + static_cast<std::size_t>(__builtin_ctz(mask));
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i quote16 = _mm_set1_epi8('"');
+    const __m128i backslash16 = _mm_set1_epi8('\\');
+    const __m128i control16 = _mm_set1_epi8(0x1F);
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote16), _mm_cmpeq_epi8(chunk, backslash16)),
+            _mm_cmpeq_epi8(_mm_min_epu8(chunk, control16), chunk));
+        auto mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+        if (mask != 0) {
+            return i + static_cast<std::size_t>(__builtin_ctz(mask));
+        }
+    }
+#endif
+    for (; i < size; ++i) {
+        if (needsEscape(data[i])) {
+            return i;
+        }
+    }
+    return size;
+}
+
+/**
+ * @brief Appends text to a string with the escapes a JSON string needs, without the quotes.
+ * 
+ * Runs of bytes that need no escaping are copied in one append. Bytes outside ASCII are
+ * copied as they are, so UTF-8 text stays UTF-8.
+ * 
+ * @param out The string to append to.
+ * @param text The text to escape.
+ */
+inline void appendEscaped(std::string& out, std::string_view text) {
+    static constexpr char hex[] = "0123456789abcdef";
+    std::size_t start = 0;
+    for (;;) {
+        std::size_t next = findEscape(text.data(), text.size(), start);
+        out.append(text.data() + start, next - start);
+        if (next == text.size()) {
+            return;
+        }
+        char c = text[next];
+        switch (c) {
+            case '"': out.append("\\\""); break;
+            case '\\': out.append("\\\\"); break;
+            case '\b': out.append("\\b"); break;
+            case '\f': out.append("\\f"); break;
+            case '\n': out.append("\\n"); break;
+            case '\r': out.append("\\r"); break;
+            case '\t': out.append("\\t"); break;
+            default: {
+                const char escape[] = {'\\', 'u', '0', '0', hex[(c >> 4) & 0xF], hex[c & 0xF]};
+                out.append(escape, sizeof(escape));
+            }
+        }
+        start = next + 1;
+    }
+}
+
+/**
+ * @brief Appends text as a quoted JSON string.
+ */
+inline void appendString(std::string& out, std::string_view text) {
+    out.push_back('"');
+    appendEscaped(out, text);
+    out.push_back('"');
+}
+
+/**
+ * @brief Appends the value of a field as a JSON value. Non-finite numbers become null.
+ */
+inline void appendValue(std::string& out, const LogField& field) {
+    char buffer[32];
+    std::to_chars_result result{buffer, std::errc()};
+    switch (field.type) {
+        case LogField::Type::String:
+            appendString(out, field.stringValue);
+            return;
+        case LogField::Type::Bool:
+            out.append(field.boolValue ? "true" : "false");
+            return;
+        case LogField::Type::Char:
+            appendString(out, std::string_view(&field.charValue, 1));
+            return;
+        case LogField::Type::Int:
+            result = std::to_chars(buffer, buffer + sizeof(buffer), field.intValue);
+            break;
+        case LogField::Type::UInt:
+            result = std::to_chars(buffer, buffer + sizeof(buffer), field.uintValue);
+            break;
+        case LogField::Type::Double:
+            if (field.doubleValue != field.doubleValue || field.doubleValue - field.doubleValue != 0.0) {
+                out.append("null");
+                return;
+            }
+            result = std::to_chars(buffer, buffer + sizeof(buffer), field.doubleValue);
+            break;
+    }
+    out.append(buffer, result.ptr);
+}
+
+} // namespace json_encoding
+
+// JSON Output Strategy
+/**
+ * @brief An output strategy that writes every record as one line of JSON to another strategy.
+ * 
+ * Each record becomes an object with "time" (UTC, ISO 8601 with microseconds), "level",
+ * "message" and, when decorators prepended text, "prefix", followed by the structured fields
+ * of the record as keys of their own. Records that were not stamped get the current time.
+ * The line is built in a reused buffer and handed to the wrapped strategy, which decides
+ * where it goes and how it is buffered, for example a BufferedFileOutput or a ConsoleOutput.
+ * Downstream tools can then read the fields directly instead of parsing decorated text.
+ */
+class JsonOutput : public IOutputStrategy {
+private:
+    std::unique_ptr<IOutputStrategy> destination;
+    TimestampFormatter formatter{TimestampPrecision::Microseconds, TimeZone::Utc};
+    std::string line;
+    std::string scratch; /**< Holds the formatted text of deferred messages. */
+
+    static std::string_view levelName(LogLevel level) {
+        static constexpr std::string_view names[] = {"fatal", "error", "warning", "info", "debug", "noise"};
+        return names[static_cast<int>(level)];
+    }
+
+public:
+    /**
+     * @brief Constructs a JsonOutput object that writes to the specified strategy.
+     * 
+     * @param destination The strategy that receives the JSON lines.
+     */
+    JsonOutput(std::unique_ptr<IOutputStrategy> destination) : destination(std::move(destination)) {}
+
+    /**
+     * @brief Outputs the specified message as an Info record.
+     * 
+     * @param message The log message to be outputted.
+     */
+    void output(const std::string& message) override {
+        write(LogRecord(LogLevel::Info, message));
+    }
+
+    /**
+     * @brief Serializes the record as a JSON object and writes it to the wrapped strategy.
+     * 
+     * @param record The log record to be outputted.
+     */
+    void write(const LogRecord& record) override {
+        auto time = record.hasTime() ? record.time : std::chrono::system_clock::now();
+        char timestamp[TimestampFormatter::MaxLength];
+        std::size_t length = formatter.format(time, timestamp);
+        timestamp[10] = 'T';
+
+        line.clear();
+        line.append("{\"time\":\"");
+        line.append(timestamp, length);
+        line.append("Z\",\"level\":\"");
+        line.append(levelName(record.level));
+        line.push_back('"');
+        if (!record.prefix().empty()) {
+            line.append(",\"prefix\":");
+            json_encoding::appendString(line, record.prefix());
+        }
+        line.append(",\"message\":");
+        json_encoding::appendString(line, record.messageText(scratch));
+        for (const LogField& field : record.fields) {
+            line.push_back(',');
+            json_encoding::appendString(line, field.key);
+            line.push_back(':');
+            json_encoding::appendValue(line, field);
+        }
+        line.push_back('}');
+
+        LogRecord json(record.level, line);
+        json.time = time;
+        destination->measuredWrite(json);
+    }
+
+    /**
+     * @brief Flushes the wrapped strategy.
+     */
+    void flush() override {
+        destination->measuredFlush();
+    }
+};
+
+// Logger with output strategy
+/**
+ * @brief The Logger class is responsible for logging messages using a specified output strategy.
+ */
+class Logger : public ILogger {
+private:
+    std::unique_ptr<IOutputStrategy> outputStrategy;
+public:
+    /**
+     * @brief Constructs a Logger object with the specified output strategy.
+     * 
+     * @param outputStrategy The output strategy to be used for logging.
+     */
+    Logger(std::unique_ptr<IOutputStrategy> outputStrategy) : outputStrategy(std::move(outputStrategy)) {}
+
+    /**
+     * @brief Hands the record to the output strategy.
+     * 
+     * @param record The record to be logged.
+     */
+    void logRecord(LogRecord& record) override {
+        outputStrategy->measuredWrite(record);
+    }
+
+    /**
+     * @brief Returns a snapshot of the telemetry of the output strategy.
+     */
+    TelemetrySnapshot stats() const {
+        return outputStrategy->stats();
+    }
+};
+
+// Asynchronous logger
+/**
+ * @brief A logger that hands records to a background thread instead of writing them itself.
+ *
+ * log() copies the record into a RecordPool slab, queues it in a bounded LockFreeRingBuffer and
+ * returns, without calling malloc once the pool has warmed up; a single worker thread
+ * drains the ring and forwards every record to the output strategy, so the output strategy only
+ * ever sees one thread and needs no synchronization of its own. What happens when the ring is
+ * full follows the QueueOptions overflow policy; by default the calling thread waits for free
+ * space rather than dropping the record. Discarded records are counted in stats(). Whenever the
+ * ring runs empty the worker flushes the output strategy, so buffered strategies never sit on
+ * idle data.
+ *
+ * On destruction the worker drains every record that was queued before it stops, so nothing
+ * that was logged is lost at process exit. log() must not be called concurrently with the
+ * destructor.
+ */
+class AsyncLogger : public ILogger {
+public:
+    static constexpr std::size_t DefaultCapacity = 8192; /**< Default number of queued records. */
+
+private:
+    std::unique_ptr<IOutputStrategy> outputStrategy;
+    RecordPool pool; /**< Declared before the queue, so it outlives the queued records. */
+    LockFreeRingBuffer<PooledRecord> queue;
+    OverflowPolicy overflowPolicy;
+    std::chrono::microseconds blockTimeout;
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> workerWaiting{false};
+    std::atomic<int> flushWaiters{0};
+    std::atomic<std::size_t> processed{0}; /**< Records written by the worker or evicted by a producer. */
+    std::atomic<std::uint64_t> dropped{0}; /**< Records discarded by the overflow policy. */
+    std::atomic<std::uint64_t> peakDepth{0}; /**< Deepest queue the worker found. */
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable drainedCondition;
+    std::thread worker;
+
+    void wakeWorker() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (workerWaiting.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            wakeCondition.notify_one();
+        }
+    }
+
+    bool drain() {
+        PooledRecord record;
+        bool drainedAny = false;
+        updatePeak(peakDepth, queue.size());
+        while (queue.tryPop(record)) {
+            LogRecord queued = record.materialize();
+            outputStrategy->measuredWrite(queued);
+            record.reset();
+            processed.fetch_add(1, std::memory_order_release);
+            drainedAny = true;
+        }
+        return drainedAny;
+    }
+
+    void run() {
+        for (;;) {
+            if (drain()) {
+                if (flushWaiters.load(std::memory_order_acquire) > 0) {
+                    std::lock_guard<std::mutex> lock(wakeMutex);
+                    drainedCondition.notify_all();
+                }
+                continue;
+            }
+            if (stopping.load(std::memory_order_acquire) && processed.load() == queue.pushedCount()) {
+                break;
+            }
+
+            outputStrategy->measuredFlush();
+            workerWaiting.store(true, std::memory_order_seq_cst);
+            {
+                std::unique_lock<std::mutex> lock(wakeMutex);
+                drainedCondition.notify_all();
+                wakeCondition.wait_for(lock, std::chrono::milliseconds(100), [this] {
+                    return queue.size() > 0 || stopping.load(std::memory_order_acquire);
+                });
+            }
+            workerWaiting.store(false, std::memory_order_relaxed);
+        }
+    }
+
+public:
+    /**
+     * @brief Constructs an AsyncLogger and starts its background worker.
+     *
+     * @param outputStrategy The output strategy records are drained into.
+     * @param capacity The number of records that can be queued before log() starts waiting.
+     */
+    AsyncLogger(std::unique_ptr<IOutputStrategy> outputStrategy, std::size_t capacity = DefaultCapacity)
+        : AsyncLogger(std::move(outputStrategy), QueueOptions{capacity, OverflowPolicy::Block}) {
+    }
+
+    /**
+     * @brief Constructs an AsyncLogger with the specified queue size and overflow policy.
+     * 
+     * @param outputStrategy The output strategy records are drained into.
+     * @param options The capacity of the queue and what log() does when it is full.
+     */
+    AsyncLogger(std::unique_ptr<IOutputStrategy> outputStrategy, const QueueOptions& options)
+        : outputStrategy(std::move(outputStrategy)), queue(options.capacity),
+          overflowPolicy(options.overflowPolicy), blockTimeout(options.blockTimeout) {
+        worker = std::thread([this] { run(); });
+    }
+
+    /**
+     * @brief Writes every queued record, then stops and joins the background worker.
+     */
+    ~AsyncLogger() override {
+        stopping.store(true, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            wakeCondition.notify_one();
+        }
+        worker.join();
+    }
+
+    /**
+     * @brief Serializes the record and queues it for the background worker.
+     *
+     * @param record The record to be logged.
+     */
+    void logRecord(LogRecord& record) override {
+        PooledRecord queued(record, pool);
+        EnqueueResult result = enqueueWithPolicy(queue, queued, record.level, overflowPolicy, blockTimeout,
+                                                 [this] { wakeWorker(); });
+        if (result.evicted > 0) {
+            processed.fetch_add(result.evicted, std::memory_order_release);
+        }
+        std::size_t discarded = result.evicted + (result.queued ? 0 : 1);
+        if (discarded > 0) {
+            dropped.fetch_add(discarded, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Returns the number of records the overflow policy discarded.
+     */
+    std::uint64_t droppedCount() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Blocks until every record queued before the call has been written.
+     */
+    void flush() {
+        std::size_t target = queue.pushedCount();
+        flushWaiters.fetch_add(1, std::memory_order_acq_rel);
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeCondition.notify_one();
+            drainedCondition.wait(lock, [this, target] {
+                return processed.load(std::memory_order_acquire) >= target;
+            });
+        }
+        flushWaiters.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    /**
+     * @brief Returns a snapshot of the telemetry of the logger and its output strategy.
+     * 
+     * Records in counts what log() queued and records dropped what the overflow policy
+     * discarded; bytes and latencies come from the output strategy.
+     */
+    TelemetrySnapshot stats() const {
+        TelemetrySnapshot stats = outputStrategy->stats();
+        stats.recordsIn = queue.pushedCount();
+        stats.recordsDropped += droppedCount();
+        stats.queueDepth = queue.size();
+        stats.peakQueueDepth = std::max(peakDepth.load(std::memory_order_relaxed), stats.peakQueueDepth);
+        return stats;
+    }
+};
+
+// Sharded logger
+/**
+ * @brief The order in which a ShardedLogger publishes the records of different threads.
+ */
+enum class MergeOrder {
+    PerThread, /**< Each thread's records stay in order; a batch holds one thread's records after another's. */
+    Timestamp  /**< The records of a batch are sorted by timestamp across threads. */
+};
+
+/**
+ * @brief Settings of a ShardedLogger.
+ */
+struct ShardedLoggerOptions {
+    MergeOrder order = MergeOrder::PerThread;      /**< How records of different threads are ordered. */
+    std::chrono::milliseconds mergeInterval{10};   /**< How often the merger publishes a batch. */
+    std::size_t shardCapacity = 1024 * 1024;       /**< Bytes a thread buffers before it waits for the merger. */
+};
+
+/**
+ * @brief A thread-safe logger whose producers never share a lock or a cache line.
+ * 
+ * Every thread appends its records to its own shard: the text goes into one growing buffer and
+ * the level, timestamp and position into a small index, so a log call neither allocates (once
+ * the shard has warmed up) nor contends with other threads. The shard's lock is only ever taken
+ * by its own thread and, briefly, by the merger. A merger thread swaps every shard's buffers for
+ * empty ones each merge interval, or sooner when a shard is half full or flush() is called, and
+ * publishes the batch to the output strategy, from that single thread, followed by a flush.
+ * Swapped buffers are recycled, so steady-state logging does not allocate at all.
+ * 
+ * With MergeOrder::Timestamp the merger sorts each batch by time; records are stamped when they
+ * are logged unless they already carry a timestamp. Ordering across batches follows the merge
+ * rounds. Everything logged before destruction is published before the destructor returns.
+ */
+class ShardedLogger : public ILogger {
+private:
+    struct Entry {
+        LogLevel level;
+        std::chrono::system_clock::time_point time;
+        std::size_t offset;
+        std::size_t prefixLength;
+        std::size_t length;
+        LogFieldCopy fields;
+    };
+
+    struct Batch {
+        std::string text;
+        std::vector<Entry> entries;
+
+        void clear() {
+            text.clear();
+            entries.clear();
+        }
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        Batch batch;
+    };
+
+    struct Published {
+        const Batch* batch;
+        const Entry* entry;
+    };
+
+    std::unique_ptr<IOutputStrategy> outputStrategy;
+    ShardedLoggerOptions options;
+    PerThread<Shard> shards;
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> mergerWaiting{false};
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable mergedCondition;
+    std::uint64_t flushRequested = 0; /**< Flush requests so far, guarded by wakeMutex. */
+    std::uint64_t flushCompleted = 0; /**< Requests covered by a finished merge, guarded by wakeMutex. */
+    bool mergeRequested = false;      /**< A shard filled up, guarded by wakeMutex. */
+    StripedCounter recordsIn;
+    std::atomic<std::uint64_t> peakBatch{0}; /**< Most records published in one merge. */
+    std::thread merger;
+
+    void wakeMerger() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (mergerWaiting.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            mergeRequested = true;
+            wakeCondition.notify_one();
+        }
+    }
+
+    void publish(const std::vector<Batch>& batches, std::size_t count, std::vector<Published>& order) {
+        order.clear();
+        for (std::size_t i = 0; i < count; ++i) {
+            const Batch& batch = batches[i];
+            for (const Entry& entry : batch.entries) {
+                order.push_back(Published{&batch, &entry});
+            }
+        }
+        if (order.empty()) {
+            return;
+        }
+        if (options.order == MergeOrder::Timestamp) {
+            std::stable_sort(order.begin(), order.end(), [](const Published& a, const Published& b) {
+                return a.entry->time < b.entry->time;
+            });
+        }
+        updatePeak(peakBatch, order.size());
+        for (const Published& published : order) {
+            const Entry& entry = *published.entry;
+            std::string_view text = std::string_view(published.batch->text).substr(entry.offset, entry.length);
+            LogRecord record(entry.level, text.substr(entry.prefixLength));
+            record.time = entry.time;
+            record.prepend(text.substr(0, entry.prefixLength));
+            record.fields = entry.fields.view();
+            outputStrategy->measuredWrite(record);
+        }
+        outputStrategy->measuredFlush();
+    }
+
+    void mergeOnce(std::vector<Batch>& batches, std::vector<Published>& order) {
+        std::size_t used = 0;
+        shards.forEach([&batches, &used](Shard& shard) {
+            if (batches.size() <= used) {
+                batches.emplace_back();
+            }
+            Batch& collected = batches[used];
+            collected.clear();
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (!shard.batch.entries.empty()) {
+                // The shard continues in the emptied buffers of an earlier round
+                std::swap(collected, shard.batch);
+                ++used;
+            }
+        });
+        publish(batches, used, order);
+    }
+
+    void run() {
+        std::vector<Batch> batches;
+        std::vector<Published> order;
+        for (;;) {
+            std::uint64_t covered;
+            bool stop;
+            {
+                std::unique_lock<std::mutex> lock(wakeMutex);
+                mergerWaiting.store(true, std::memory_order_seq_cst);
+                wakeCondition.wait_for(lock, options.mergeInterval, [this] {
+                    return mergeRequested || flushRequested != flushCompleted || stopping.load(std::memory_order_acquire);
+                });
+                mergerWaiting.store(false, std::memory_order_relaxed);
+                mergeRequested = false;
+                covered = flushRequested;
+                stop = stopping.load(std::memory_order_acquire);
+            }
+
+            mergeOnce(batches, order);
+
+            {
+                std::lock_guard<std::mutex> lock(wakeMutex);
+                flushCompleted = covered;
+                mergedCondition.notify_all();
+            }
+            if (stop) {
+                break;
+            }
+        }
+    }
+
+public:
+    /**
+     * @brief Constructs a ShardedLogger and starts its merger thread.
+     * 
+     * @param outputStrategy The output strategy batches are published to.
+     * @param options The ordering, merge interval and shard capacity.
+     */
+    ShardedLogger(std::unique_ptr<IOutputStrategy> outputStrategy, ShardedLoggerOptions options = ShardedLoggerOptions())
+        : outputStrategy(std::move(outputStrategy)), options(options) {
+        merger = std::thread([this] { run(); });
+    }
+
+    /**
+     * @brief Publishes every buffered record, then stops and joins the merger.
+     */
+    ~ShardedLogger() override {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            stopping.store(true, std::memory_order_release);
+            wakeCondition.notify_one();
+        }
+        merger.join();
+    }
+
+    /**
+     * @brief Appends the record to the calling thread's shard.
+     * 
+     * @param record The record to be logged.
+     */
+    void logRecord(LogRecord& record) override {
+        if (options.order == MergeOrder::Timestamp && !record.hasTime()) {
+            record.time = std::chrono::system_clock::now();
+        }
+        recordsIn.add();
+        Shard& shard = shards.local();
+        bool halfFull;
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                Batch& batch = shard.batch;
+                if (batch.text.size() < options.shardCapacity || batch.entries.empty()) {
+                    std::size_t offset = batch.text.size();
+                    record.appendTo(batch.text);
+                    batch.entries.push_back(Entry{record.level, record.time, offset, record.prefix().size(),
+                                                  batch.text.size() - offset, LogFieldCopy()});
+                    batch.entries.back().fields.assign(record.fields);
+                    halfFull = batch.text.size() >= options.shardCapacity / 2;
+                    break;
+                }
+            }
+            // The shard is full: wait for the merger to take it
+            wakeMerger();
+            std::this_thread::yield();
+        }
+        if (halfFull) {
+            wakeMerger();
+        }
+    }
+
+    /**
+     * @brief Blocks until every record logged before the call has been published.
+     */
+    void flush() {
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        std::uint64_t request = ++flushRequested;
+        wakeCondition.notify_one();
+        mergedCondition.wait(lock, [this, request] {
+            return flushCompleted >= request;
+        });
+    }
+
+    /**
+     * @brief Returns a snapshot of the telemetry of the logger and its output strategy.
+     * 
+     * The peak queue depth is the largest batch published in one merge.
+     */
+    TelemetrySnapshot stats() const {
+        TelemetrySnapshot stats = outputStrategy->stats();
+        stats.recordsIn = recordsIn.load();
+        stats.peakQueueDepth = peakBatch.load(std::memory_order_relaxed);
+        return stats;
+    }
+};
+
+// Reloadable logger
+/**
+ * @brief A logger handle whose pipeline can be replaced while other threads are logging.
+ * 
+ * The current pipeline is published through an atomic pointer. logRecord() announces itself in
+ * a striped reader count for the current epoch, loads the pointer and calls the pipeline, so
+ * logging takes no lock and threads on different stripes share no cache line. reload() publishes
+ * the new pipeline, advances the epoch and, RCU style, waits only for the readers counted in the
+ * previous epoch, which are the only ones that can still hold the old pipeline. It then destroys
+ * the old pipeline, whose destructor drains what it queued; an AsyncLogger, for example, writes
+ * every queued record first. Threads that log during reload() go straight to the new pipeline,
+ * so only the caller of reload() ever waits.
+ * 
+ * The enabled level follows the current pipeline, including level changes made inside it.
+ */
+class ReloadableLogger : public ILogger {
+private:
+    std::atomic<ILogger*> current;
+    std::atomic<std::uint64_t> epoch{0};
+    StripedCounter entered[2]; /**< Readers that started, per epoch parity. */
+    StripedCounter exited[2];  /**< Readers that finished, per epoch parity. */
+    std::mutex reloadMutex;    /**< Serializes reload(); logging never takes it. */
+    std::atomic<std::uint64_t> reloads{0};
+
+    class ReadGuard {
+    public:
+        explicit ReadGuard(ReloadableLogger& owner) : owner(owner) {
+            for (;;) {
+                std::uint64_t seen = owner.epoch.load(std::memory_order_seq_cst);
+                parity = seen & 1;
+                owner.entered[parity].add(1, std::memory_order_seq_cst);
+                if (owner.epoch.load(std::memory_order_seq_cst) == seen) {
+                    return;
+                }
+                owner.exited[parity].add(1, std::memory_order_release);
+            }
+        }
+
+        ~ReadGuard() {
+            owner.exited[parity].add(1, std::memory_order_release);
+        }
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+    private:
+        ReloadableLogger& owner;
+        std::size_t parity = 0;
+    };
+
+    void waitForReaders(std::size_t parity) const {
+        for (;;) {
+            std::uint64_t finished = exited[parity].load(std::memory_order_seq_cst);
+            if (finished == entered[parity].load(std::memory_order_seq_cst)) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+public:
+    /**
+     * @brief Constructs a ReloadableLogger that starts with the specified pipeline.
+     * 
+     * @param pipeline The logger chain records are handed to until the next reload().
+     */
+    explicit ReloadableLogger(std::unique_ptr<ILogger> pipeline) : current(pipeline.release()) {
+        current.load()->parent = this;
+        refreshEnabledLevel();
+    }
+
+    /**
+     * @brief Destroys the current pipeline. log() must not be called concurrently with the destructor.
+     */
+    ~ReloadableLogger() override {
+        delete current.load();
+    }
+
+    ReloadableLogger(const ReloadableLogger&) = delete;
+    ReloadableLogger& operator=(const ReloadableLogger&) = delete;
+
+    /**
+     * @brief Hands the record to the current pipeline.
+     * 
+     * @param record The record to be logged.
+     */
+    void logRecord(LogRecord& record) override {
+        ReadGuard guard(*this);
+        current.load(std::memory_order_seq_cst)->logRecord(record);
+    }
+
+    /**
+     * @brief Replaces the pipeline, then retires the old one once no thread can be using it.
+     * 
+     * Safe to call while other threads are logging. Returns after the old pipeline has been
+     * destroyed, so everything logged through it has been handed to its outputs.
+     * 
+     * @param pipeline The new logger chain.
+     */
+    void reload(std::unique_ptr<ILogger> pipeline) {
+        std::lock_guard<std::mutex> lock(reloadMutex);
+        pipeline->parent = this;
+        std::unique_ptr<ILogger> retired;
+        {
+            std::lock_guard<std::mutex> levelLock(levelChangeMutex());
+            retired.reset(current.exchange(pipeline.release(), std::memory_order_seq_cst));
+            refreshEnabledLevel();
+        }
+        std::uint64_t previous = epoch.fetch_add(1, std::memory_order_seq_cst);
+        waitForReaders(previous & 1);
+        retired.reset();
+        reloads.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the number of completed reloads.
+     */
+    std::uint64_t reloadCount() const {
+        return reloads.load(std::memory_order_relaxed);
+    }
+
+protected:
+    /**
+     * @brief Forwards to the cached enabled level of the current pipeline.
+     */
+    int computeEnabledLevel() const override {
+        return current.load(std::memory_order_acquire)->enabledLevel.load(std::memory_order_relaxed);
+    }
+};
+
+// Statically composed pipelines
+/**
+ * @brief Pipeline stage that prepends the log level, like LogLevelDecorator.
+ * 
+ * A stage is any class with a process(LogRecord&) method that annotates the record and
+ * returns false to stop it. Stages that limit the level also provide enabledLevel().
+ */
+struct LevelStage {
+    bool process(LogRecord& record) {
+        const char tag[] = {'[', static_cast<char>('0' + static_cast<int>(record.level)), ']', ' '};
+        record.prepend(std::string_view(tag, sizeof(tag)));
+        return true;
+    }
+};
+
+/**
+ * @brief Pipeline stage that stamps and prepends the time, like TimestampDecorator.
+ */
+struct TimestampStage {
+    TimestampFormatter formatter; /**< Replace to change the precision or time zone. */
+
+    bool process(LogRecord& record) {
+        if (!record.hasTime()) {
+            record.time = std::chrono::system_clock::now();
+        }
+        char timestamp[TimestampFormatter::MaxLength + 3];
+        timestamp[0] = '[';
+        std::size_t length = 1 + formatter.format(record.time, timestamp + 1);
+        timestamp[length++] = ']';
+        timestamp[length++] = ' ';
+        record.prepend(std::string_view(timestamp, length));
+        return true;
+    }
+};
+
+/**
+ * @brief Pipeline stage that drops records more verbose than a minimum level, like LevelFilterDecorator.
+ */
+struct FilterStage {
+    std::atomic<int> minLevel{static_cast<int>(LogLevel::Info)}; /**< The most verbose level let through. */
+
+    bool process(LogRecord& record) {
+        return static_cast<int>(record.level) <= minLevel.load(std::memory_order_relaxed);
+    }
+
+    int enabledLevel() const {
+        return minLevel.load(std::memory_order_relaxed);
+    }
+
+    void setMinLevel(LogLevel level) {
+        minLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief Holds one part of a Pipeline; the sink part is built from the pipeline's arguments.
+ */
+template <std::size_t Index, typename Part>
+struct PipelinePart {
+    Part value;
+
+    template <typename... Arguments>
+    PipelinePart(std::false_type, Arguments&...) : value() {}
+
+    template <typename... Arguments>
+    PipelinePart(std::true_type, Arguments&... arguments) : value(arguments...) {}
+};
+
+template <typename Indices, typename... Parts>
+struct PipelineStorage;
+
+template <std::size_t... Indices, typename... Parts>
+struct PipelineStorage<std::index_sequence<Indices...>, Parts...> : PipelinePart<Indices, Parts>... {
+    template <typename... SinkArguments>
+    PipelineStorage(SinkArguments&... sinkArguments)
+        : PipelinePart<Indices, Parts>(std::integral_constant<bool, Indices + 1 == sizeof...(Parts)>(), sinkArguments...)... {}
+};
+
+/**
+ * @brief A logger composed at compile time from stages and a sink.
+ * 
+ * Pipeline<TimestampStage, LevelStage, FilterStage, FileOutput> behaves like a TimestampDecorator
+ * wrapping a LogLevelDecorator wrapping a LevelFilterDecorator over a Logger with a FileOutput:
+ * the stages run in order from left to right and the last type is the output strategy. All parts
+ * are members of the pipeline rather than separate heap objects, and since their types are known
+ * the compiler can inline the whole chain, sink call included, into the log call.
+ * 
+ * Pipelines are not ILoggers. Wrap one in a PipelineLogger where the virtual interface is needed.
+ * The CPPLOGGER_LOG macros accept pipelines directly.
+ * 
+ * @tparam Parts The stages, followed by the output strategy.
+ */
+template <typename... Parts>
+class Pipeline {
+    static_assert(sizeof...(Parts) >= 1, "a pipeline needs a sink");
+
+public:
+    static constexpr std::size_t StageCount = sizeof...(Parts) - 1; /**< Number of stages before the sink. */
+    using Sink = std::tuple_element_t<StageCount, std::tuple<Parts...>>; /**< The output strategy type. */
+
+    /**
+     * @brief Constructs the pipeline with default stages and a sink built from the arguments.
+     * 
+     * @param sinkArguments The arguments of the sink's constructor, such as a file name.
+     */
+    template <typename... SinkArguments>
+    explicit Pipeline(SinkArguments&&... sinkArguments) : parts(sinkArguments...) {}
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    /**
+     * @brief Returns true if a record at the specified level would get through every stage.
+     * 
+     * @param level The log level to check.
+     */
+    bool isEnabled(LogLevel level) const {
+        return static_cast<int>(level) <= enabledLevel();
+    }
+
+    /**
+     * @brief Returns the most verbose level every stage lets through, as an integer.
+     */
+    int enabledLevel() const {
+        return enabledLevel(std::make_index_sequence<StageCount>());
+    }
+
+    /**
+     * @brief Logs a message with the specified log level.
+     * 
+     * @param level The log level of the message.
+     * @param message The message to be logged.
+     */
+    void log(LogLevel level, std::string_view message) {
+        if (!isEnabled(level)) {
+            return;
+        }
+        LogRecord record(level, message);
+        logRecord(record);
+    }
+
+    /**
+     * @brief Logs a message with structured fields attached.
+     * 
+     * @param level The log level of the message.
+     * @param message The message to be logged.
+     * @param fields The fields, referenced for the duration of the call.
+     */
+    void log(LogLevel level, std::string_view message, std::initializer_list<LogField> fields) {
+        if (!isEnabled(level)) {
+            return;
+        }
+        LogRecord record(level, message);
+        record.fields = LogFields{fields.begin(), fields.size()};
+        logRecord(record);
+    }
+
+    /**
+     * @brief Logs a message built from a format string and arguments, formatted only by the sink.
+     * 
+     * @param level The log level of the message.
+     * @param format The format string, with "{}" placeholders.
+     * @param arg The first argument.
+     * @param args The remaining arguments.
+     */
+    template <typename Arg, typename... Args>
+    void log(LogLevel level, std::string_view format, const Arg& arg, const Args&... args) {
+        if (!isEnabled(level)) {
+            return;
+        }
+        std::tuple<const Arg&, const Args&...> arguments(arg, args...);
+        LogRecord record(level, format);
+        record.defer(&formatTuple<Arg, Args...>, &arguments);
+        logRecord(record);
+    }
+
+    /**
+     * @brief Logs a message from a known call site, as the CPPLOGGER_LOG macros do.
+     * 
+     * @param site The call site, stored in LogRecord::site.
+     * @param level The log level of the message.
+     * @param message The message to be logged.
+     */
+    void log(const LogSite& site, LogLevel level, std::string_view message) {
+        if (!isEnabled(level)) {
+            return;
+        }
+        LogRecord record(level, message);
+        record.site = &site;
+        logRecord(record);
+    }
+
+    /**
+     * @brief Logs a message with structured fields from a known call site.
+     * 
+     * @param site The call site, stored in LogRecord::site.
+     * @param level The log level of the message.
+     * @param message The message to be logged.
+     * @param fields The fields, referenced for the duration of the call.
+     */
+    void log(const LogSite& site, LogLevel level, std::string_view message, std::initializer_list<LogField> fields) {
+        if (!isEnabled(level)) {
+            return;
+        }
+        LogRecord record(level, message);
+        record.site = &site;
+        record.fields = LogFields{fields.begin(), fields.size()};
+        logRecord(record);
+    }
+
+    /**
+     * @brief Logs a message built from a format string and arguments from a known call site.
+     * 
+     * @param site The call site, stored in LogRecord::site.
+     * @param level The log level of the message.
+     * @param format The format string, with "{}" placeholders.
+     * @param arg The first argument.
+     * @param args The remaining arguments.
+     */
+    template <typename Arg, typename... Args>
+    void log(const LogSite& site, LogLevel level, std::string_view format, const Arg& arg, const Args&... args) {
+        if (!isEnabled(level)) {
+            return;
+        }
+        std::tuple<const Arg&, const Args&...> arguments(arg, args...);
+        LogRecord record(level, format);
+        record.site = &site;
+        record.defer(&formatTuple<Arg, Args...>, &arguments);
+        logRecord(record);
+    }
+
+    /**
+     * @brief Runs the record through the stages and, unless one stops it, writes it to the sink.
+     * 
+     * @param record The record to be logged.
+     */
+    void logRecord(LogRecord& record) {
+        if (process(record, std::make_index_sequence<StageCount>())) {
+            sinkPart().measuredWrite(record);
+        }
+    }
+
+    /**
+     * @brief Flushes the sink.
+     */
+    void flush() {
+        sinkPart().measuredFlush();
+    }
+
+    /**
+     * @brief Returns the stage at an index.
+     */
+    template <std::size_t Index>
+    auto& stage() {
+        static_assert(Index < StageCount, "stage index out of range");
+        return part<Index>();
+    }
+
+    /**
+     * @brief Returns the first stage of a type.
+     */
+    template <typename Stage>
+    Stage& stage() {
+        static_assert(indexOf<Stage>() < StageCount, "no stage of this type");
+        return part<indexOf<Stage>()>();
+    }
+
+    /**
+     * @brief Returns the sink.
+     */
+    Sink& sink() {
+        return sinkPart();
+    }
+
+    /**
+     * @brief Returns a snapshot of the telemetry of the sink.
+     */
+    TelemetrySnapshot stats() const {
+        return part<StageCount>().stats();
+    }
+
+private:
+    PipelineStorage<std::index_sequence_for<Parts...>, Parts...> parts;
+
+    template <std::size_t Index>
+    using PartType = std::tuple_element_t<Index, std::tuple<Parts...>>;
+
+    template <std::size_t Index>
+    PartType<Index>& part() {
+        return static_cast<PipelinePart<Index, PartType<Index>>&>(parts).value;
+    }
+
+    template <std::size_t Index>
+    const PartType<Index>& part() const {
+        return static_cast<const PipelinePart<Index, PartType<Index>>&>(parts).value;
+    }
+
+    template <typename Stage>
+    static constexpr std::size_t indexOf() {
+        constexpr bool matches[] = {std::is_same_v<Stage, Parts>...};
+        for (std::size_t i = 0; i < StageCount; ++i) {
+            if (matches[i]) {
+                return i;
+            }
+        }
+        return StageCount;
+    }
+
+    Sink& sinkPart() {
+        return part<StageCount>();
+    }
+
+    template <typename Stage>
+    static auto stageLevel(const Stage& stage, int) -> decltype(stage.enabledLevel()) {
+        return stage.enabledLevel();
+    }
+
+    template <typename Stage>
+    static int stageLevel(const Stage&, long) {
+        return static_cast<int>(LogLevel::Noise);
+    }
+
+    template <std::size_t... Indices>
+    int enabledLevel(std::index_sequence<Indices...>) const {
+        int level = static_cast<int>(LogLevel::Noise);
+        ((level = std::min(level, static_cast<int>(stageLevel(part<Indices>(), 0)))), ...);
+        return level;
+    }
+
+    template <std::size_t... Indices>
+    bool process(LogRecord& record, std::index_sequence<Indices...>) {
+        return (true && ... && part<Indices>().process(record));
+    }
+
+    template <typename... Args>
+    static void formatTuple(std::string& out, std::string_view format, const void* arguments) {
+        const auto& values = *static_cast<const std::tuple<const Args&...>*>(arguments);
+        std::apply([&out, format](const Args&... args) { formatMessage(out, format, args...); }, values);
+    }
+};
+
 /**
- * @brief The Logger class is responsible for logging messages using a specified output strategy.
+ * @brief Exposes a Pipeline through the virtual ILogger interface.
+ * 
+ * The pipeline itself stays fully inlined; only the entry into it is a virtual call. Change
+ * stage settings through configure() so the cached enabled level of the wrapper and of any
+ * decorator around it is refreshed.
+ * 
+ * @tparam PipelineType The wrapped pipeline.
  */
-class Logger : public ILogger {
+template <typename PipelineType>
+class PipelineLogger : public ILogger {
 private:
-    std::unique_ptr<IOutputStrategy> outputStrategy;
+    std::unique_ptr<PipelineType> pipelineInstance;
+
+public:
+    /**
+     * @brief Constructs a PipelineLogger that owns the specified pipeline.
+     * 
+     * @param pipeline The pipeline to wrap.
+     */
+    PipelineLogger(std::unique_ptr<PipelineType> pipeline) : pipelineInstance(std::move(pipeline)) {
+        refreshEnabledLevel();
+    }
+
+    /**
+     * @brief Runs the record through the pipeline.
+     * 
+     * @param record The record to be logged.
+     */
+    void logRecord(LogRecord& record) override {
+        pipelineInstance->logRecord(record);
+    }
+
+    /**
+     * @brief Returns the wrapped pipeline.
+     */
+    const PipelineType& pipeline() const {
+        return *pipelineInstance;
+    }
+
+    /**
+     * @brief Changes the pipeline and refreshes the cached enabled levels.
+     * 
+     * @param change Called as change(PipelineType&).
+     */
+    template <typename Function>
+    void configure(Function&& change) {
+        std::lock_guard<std::mutex> lock(levelChangeMutex());
+        change(*pipelineInstance);
+        refreshEnabledLevel();
+    }
+
+protected:
+    int computeEnabledLevel() const override {
+        return pipelineInstance->enabledLevel();
+    }
+};
+
+/**
+ * @brief Wraps a pipeline in a PipelineLogger.
+ * 
+ * @param pipeline The pipeline to wrap.
+ * @return The type-erased logger.
+ */
+template <typename PipelineType>
+std::unique_ptr<ILogger> makePipelineLogger(std::unique_ptr<PipelineType> pipeline) {
+    return std::make_unique<PipelineLogger<PipelineType>>(std::move(pipeline));
+}
+
+using ConsolePipelineWithLevel = Pipeline<LevelStage, ConsoleOutput>;                /**< Fused createConsoleLoggerWithLevel(). */
+using FilePipelineWithLevelFilter = Pipeline<FilterStage, FileOutput>;                /**< Fused createFileLoggerWithLevelFilter(). */
+using BufferedFilePipelineWithLevelFilter = Pipeline<FilterStage, BufferedFileOutput>; /**< Fused createFileLoggerWithLevelFilter() with a FlushPolicy. */
+using FilePipelineWithLevelAndTimestamp = Pipeline<TimestampStage, FileOutput>;       /**< Fused createFileLoggerWithLevelAndTimestamp(). */
+using BufferedFilePipelineWithLevelAndTimestamp = Pipeline<TimestampStage, BufferedFileOutput>; /**< Fused createFileLoggerWithLevelAndTimestamp() with a FlushPolicy. */
+
+// Binary log encoding
+/**
+ * @brief The type of an argument stored in a binary log, which decides its encoding.
+ */
+enum class BinaryArgumentType : std::uint8_t {
+    Bool,    /**< One byte, 0 or 1. */
+    Char,    /**< One byte. */
+    Int,     /**< A signed 64-bit integer. */
+    UInt,    /**< An unsigned 64-bit integer. */
+    Double,  /**< A 64-bit floating point number. */
+    Pointer, /**< A pointer value, written as an unsigned 64-bit integer and formatted in hex. */
+    String   /**< A 32-bit length followed by that many bytes. */
+};
+
+/**
+ * @brief Maps a C++ argument type to the BinaryArgumentType it is encoded as.
+ * 
+ * Only types with a fixed binary representation can be logged in binary: arithmetic types,
+ * enums, pointers and strings. Anything else has to be formatted by the caller.
+ */
+template <typename T>
+constexpr BinaryArgumentType binaryArgumentType() {
+    using Type = std::decay_t<T>;
+    if constexpr (std::is_same_v<Type, bool>) {
+        return BinaryArgumentType::Bool;
+    } else if constexpr (std::is_same_v<Type, char>) {
+        return BinaryArgumentType::Char;
+    } else if constexpr (std::is_integral_v<Type>) {
+        return std::is_signed_v<Type> ? BinaryArgumentType::Int : BinaryArgumentType::UInt;
+    } else if constexpr (std::is_floating_point_v<Type>) {
+        return BinaryArgumentType::Double;
+    } else if constexpr (std::is_same_v<Type, const char*> || std::is_same_v<Type, char*>
+                         || std::is_convertible_v<const Type&, std::string_view>) {
+        return BinaryArgumentType::String;
+    } else if constexpr (std::is_enum_v<Type>) {
+        return binaryArgumentType<std::underlying_type_t<Type>>();
+    } else if constexpr (std::is_pointer_v<Type>) {
+        return BinaryArgumentType::Pointer;
+    } else {
+        static_assert(std::is_pointer_v<Type>, "binary logging supports arithmetic, enum, pointer and string arguments");
+        return BinaryArgumentType::String;
+    }
+}
+
+/**
+ * @brief Encoding of single arguments into the payload of a binary record.
+ * 
+ * Arguments are stored back to back without type tags or a payload length; the decoder knows
+ * their types from the definition of the record's format id.
+ */
+namespace binary_encoding {
+
+/**
+ * @brief Returns the text of a string argument, as appendFormatted() would format it.
+ * 
+ * A null char pointer is "(null)" and a char array ends at its first null character or its
+ * extent. A single template handles both, since a non-template const char* overload would also
+ * be chosen for char arrays.
+ */
+template <typename T>
+std::string_view stringArgument(const T& value) {
+    if constexpr (std::is_array_v<T>) {
+        return std::string_view(value, static_cast<std::size_t>(std::find(value, value + std::extent_v<T>, '\0') - value));
+    } else if constexpr (std::is_same_v<T, const char*> || std::is_same_v<T, char*>) {
+        return value != nullptr ? std::string_view(value) : std::string_view("(null)");
+    } else {
+        return std::string_view(value);
+    }
+}
+
+/**
+ * @brief Returns the number of payload bytes an argument takes.
+ */
+template <typename T>
+std::size_t encodedSize(const T& value) {
+    constexpr BinaryArgumentType type = binaryArgumentType<T>();
+    if constexpr (type == BinaryArgumentType::String) {
+        return sizeof(std::uint32_t) + stringArgument(value).size();
+    } else if constexpr (type == BinaryArgumentType::Bool || type == BinaryArgumentType::Char) {
+        return 1;
+    } else {
+        return 8;
+    }
+}
+
+/**
+ * @brief Writes an argument at out and returns the position after it.
+ */
+template <typename T>
+char* encode(char* out, const T& value) {
+    constexpr BinaryArgumentType type = binaryArgumentType<T>();
+    using Type = std::decay_t<T>;
+    if constexpr (type == BinaryArgumentType::String) {
+        std::string_view text = stringArgument(value);
+        auto length = static_cast<std::uint32_t>(text.size());
+        std::memcpy(out, &length, sizeof(length));
+        std::memcpy(out + sizeof(length), text.data(), text.size());
+        return out + sizeof(length) + text.size();
+    } else if constexpr (type == BinaryArgumentType::Bool || type == BinaryArgumentType::Char) {
+        *out = static_cast<char>(value);
+        return out + 1;
+    } else if constexpr (type == BinaryArgumentType::Pointer) {
+        auto bits = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(value));
+        std::memcpy(out, &bits, sizeof(bits));
+        return out + sizeof(bits);
+    } else if constexpr (type == BinaryArgumentType::Double) {
+        auto number = static_cast<double>(value);
+        std::memcpy(out, &number, sizeof(number));
+        return out + sizeof(number);
+    } else if constexpr (type == BinaryArgumentType::Int) {
+        std::int64_t number;
+        if constexpr (std::is_enum_v<Type>) {
+            number = static_cast<std::int64_t>(static_cast<std::underlying_type_t<Type>>(value));
+        } else {
+            number = static_cast<std::int64_t>(value);
+        }
+        std::memcpy(out, &number, sizeof(number));
+        return out + sizeof(number);
+    } else {
+        std::uint64_t number;
+        if constexpr (std::is_enum_v<Type>) {
+            number = static_cast<std::uint64_t>(static_cast<std::underlying_type_t<Type>>(value));
+        } else {
+            number = static_cast<std::uint64_t>(value);
+        }
+        std::memcpy(out, &number, sizeof(number));
+        return out + sizeof(number);
+    }
+}
+
+constexpr char FileMagic[8] = {'C', 'P', 'L', 'O', 'G', 'B', 'I', 'N'}; /**< Starts every logging session in a file. */
+constexpr std::uint32_t FileVersion = 1;                                  /**< Follows the magic. */
+constexpr char DefinitionTag = 'F';                                       /**< Starts a format definition frame. */
+constexpr char RecordTag = 'R';                                           /**< Starts a record frame. */
+constexpr std::size_t RecordHeaderSize = 1 + 4 + 1 + 8;                   /**< Tag, id, level, timestamp; the arguments follow. */
+
+} // namespace binary_encoding
+
+/**
+ * @brief A call site of binary logging: caches the format id the site was registered under.
+ * 
+ * Declare one as a function-local static per call site (CPPLOGGER_BINARY_LOG does this). The
+ * first call registers the format string and argument types with the FormatRegistry; every
+ * later call only loads the cached id.
+ */
+struct BinaryFormatSite {
+    std::atomic<std::uint32_t> id{0}; /**< The registered format id, or 0 before the first call. */
+};
+
+/**
+ * @brief The process-wide table of format strings used for binary logging.
+ * 
+ * Ids are handed out in registration order starting at 1 and stay valid for the lifetime of
+ * the process. Registration takes a lock, but happens only once per call site.
+ */
+class FormatRegistry {
+public:
+    /**
+     * @brief A registered format string and the types of the arguments its call site passes.
+     */
+    struct Entry {
+        std::string format;
+        std::vector<BinaryArgumentType> argumentTypes;
+    };
+
+    /**
+     * @brief Returns the registry shared by all binary loggers.
+     */
+    static FormatRegistry& instance() {
+        static FormatRegistry registry;
+        return registry;
+    }
+
+    /**
+     * @brief Returns the id of a call site, registering it on first use.
+     * 
+     * @tparam Args The types of the arguments the call site passes.
+     * @param site The call site.
+     * @param format The format string of the call site.
+     */
+    template <typename... Args>
+    std::uint32_t idFor(BinaryFormatSite& site, std::string_view format) {
+        std::uint32_t id = site.id.load(std::memory_order_acquire);
+        if (id != 0) {
+            return id;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        id = site.id.load(std::memory_order_relaxed);
+        if (id == 0) {
+            entries.push_back(Entry{std::string(format), {binaryArgumentType<Args>()...}});
+            id = static_cast<std::uint32_t>(entries.size());
+            count.store(entries.size(), std::memory_order_release);
+            site.id.store(id, std::memory_order_release);
+        }
+        return id;
+    }
+
+    /**
+     * @brief Returns the number of registered formats, which is also the highest id.
+     */
+    std::size_t size() const {
+        return count.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Returns a copy of the entry registered under an id.
+     * 
+     * @param id A registered id, between 1 and size().
+     */
+    Entry entry(std::uint32_t id) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.at(id - 1);
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::deque<Entry> entries;
+    std::atomic<std::size_t> count{0};
+};
+
+/**
+ * @brief Settings of a BinaryLogger.
+ */
+struct BinaryLogOptions {
+    std::size_t bufferSize = 64 * 1024; /**< Bytes each thread buffers before writing them to the file. */
+};
+
+/**
+ * @brief A logger that writes records in a compact binary form and never formats text.
+ * 
+ * A binary record holds only the format id of its call site, the level, the timestamp in
+ * nanoseconds and the raw bytes of the arguments: no formatting, no conversion to text and no
+ * copy of the format string happens on the calling thread. Every thread appends its records to
+ * its own buffer, which is written to the file with a single write when it fills up and when
+ * flush() is called; the lock on a thread's buffer is only ever contended by flush(). The file
+ * also gets a definition frame for every format id before the first record that can use it,
+ * so it is self-describing; BinaryLogDecoder and the cpplogger_decode tool turn it back into
+ * the text a TimestampDecorator over a LogLevelDecorator would have produced.
+ * 
+ * Use logBinary(), or the CPPLOGGER_BINARY_LOG macro that declares the call site for you, on
+ * hot paths. Text records that reach logRecord(), for example from decorators wrapping this
+ * logger, are stored as a single string argument. Records of one thread keep their order in
+ * the file; records of different threads are only ordered per buffer written.
+ * 
+ * The file is written in host byte order.
+ */
+class BinaryLogger : public ILogger {
+private:
+    struct ThreadBuffer {
+        std::mutex mutex;
+        std::vector<char> data;
+        std::size_t used = 0;
+    };
+
+    int fd = -1;
+    BinaryLogOptions options;
+    PerThread<ThreadBuffer> buffers;
+    std::mutex fileMutex;
+    std::size_t definedFormats = 0; /**< Format ids already defined in this file, guarded by fileMutex. */
+
+    void writeAll(const char* data, std::size_t size) {
+        while (size > 0) {
+            ssize_t written = ::write(fd, data, size);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            data += written;
+            size -= static_cast<std::size_t>(written);
+        }
+    }
+
+    void defineNewFormats(std::string& frames) {
+        FormatRegistry& registry = FormatRegistry::instance();
+        std::size_t registered = registry.size();
+        for (; definedFormats < registered; ++definedFormats) {
+            auto id = static_cast<std::uint32_t>(definedFormats + 1);
+            FormatRegistry::Entry entry = registry.entry(id);
+            auto argumentCount = static_cast<std::uint8_t>(entry.argumentTypes.size());
+            auto length = static_cast<std::uint32_t>(entry.format.size());
+            frames.push_back(binary_encoding::DefinitionTag);
+            frames.append(reinterpret_cast<const char*>(&id), sizeof(id));
+            frames.push_back(static_cast<char>(argumentCount));
+            for (BinaryArgumentType type : entry.argumentTypes) {
+                frames.push_back(static_cast<char>(type));
+            }
+            frames.append(reinterpret_cast<const char*>(&length), sizeof(length));
+            frames.append(entry.format);
+        }
+    }
+
+    /**
+     * @brief Writes a thread's buffered records, preceded by any definitions they may need.
+     * The caller holds the buffer's lock.
+     */
+    void writeBuffer(ThreadBuffer& buffer) {
+        if (buffer.used == 0) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(fileMutex);
+        std::string definitions;
+        defineNewFormats(definitions);
+        writeAll(definitions.data(), definitions.size());
+        writeAll(buffer.data.data(), buffer.used);
+        buffer.used = 0;
+    }
+
+    static std::int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    template <typename... Args>
+    void append(std::uint32_t id, LogLevel level, std::int64_t timestamp, const Args&... args) {
+        std::size_t payloadSize = (std::size_t{0} + ... + binary_encoding::encodedSize(args));
+        std::size_t frameSize = binary_encoding::RecordHeaderSize + payloadSize;
+
+        ThreadBuffer& buffer = buffers.local();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        if (buffer.used + frameSize > buffer.data.size()) {
+            writeBuffer(buffer);
+            if (buffer.data.size() < std::max(options.bufferSize, frameSize)) {
+                buffer.data.resize(std::max(options.bufferSize, frameSize));
+            }
+        }
+
+        char* out = buffer.data.data() + buffer.used;
+        auto levelByte = static_cast<std::uint8_t>(level);
+        *out++ = binary_encoding::RecordTag;
+        std::memcpy(out, &id, sizeof(id));
+        out += sizeof(id);
+        *out++ = static_cast<char>(levelByte);
+        std::memcpy(out, &timestamp, sizeof(timestamp));
+        out += sizeof(timestamp);
+        ((out = binary_encoding::encode(out, args)), ...);
+        buffer.used += frameSize;
+    }
+
+public:
+    /**
+     * @brief Constructs a BinaryLogger that appends to the specified file.
+     * 
+     * Every logger starts a new session in the file, so several runs can append to the same file
+     * and still be decoded.
+     * 
+     * @param filename The name of the binary log file.
+     * @param options The buffer settings.
+     * @throws std::runtime_error if the file cannot be opened.
+     */
+    BinaryLogger(const std::string& filename, BinaryLogOptions options = BinaryLogOptions()) : options(options) {
+        fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Unable to open file");
+        }
+        char header[sizeof(binary_encoding::FileMagic) + sizeof(binary_encoding::FileVersion)];
+        std::memcpy(header, binary_encoding::FileMagic, sizeof(binary_encoding::FileMagic));
+        std::memcpy(header + sizeof(binary_encoding::FileMagic), &binary_encoding::FileVersion, sizeof(binary_encoding::FileVersion));
+        writeAll(header, sizeof(header));
+    }
+
+    BinaryLogger(const BinaryLogger&) = delete;
+    BinaryLogger& operator=(const BinaryLogger&) = delete;
+
+    /**
+     * @brief Writes every buffered record and closes the file.
+     */
+    ~BinaryLogger() override {
+        flush();
+        ::close(fd);
+    }
+
+    /**
+     * @brief Logs a record in binary form.
+     * 
+     * @param site The call site, usually a function-local static.
+     * @param level The log level of the record.
+     * @param format The format string, with "{}" placeholders. Only its first use at a call site is read.
+     * @param args The arguments, stored as raw bytes.
+     */
+    template <typename... Args>
+    void logBinary(BinaryFormatSite& site, LogLevel level, std::string_view format, const Args&... args) {
+        if (!isEnabled(level)) {
+            countDisabled();
+            return;
+        }
+        std::uint32_t id = FormatRegistry::instance().idFor<Args...>(site, format);
+        append(id, level, now(), args...);
+    }
+
+    /**
+     * @brief Logs a text record as a single string argument.
+     * 
+     * @param record The record to be logged.
+     */
+    void logRecord(LogRecord& record) override {
+        static BinaryFormatSite textSite;
+        std::uint32_t id = FormatRegistry::instance().idFor<std::string_view>(textSite, "{}");
+        std::int64_t timestamp = record.hasTime()
+            ? std::chrono::duration_cast<std::chrono::nanoseconds>(record.time.time_since_epoch()).count()
+            : now();
+        if (record.prefix().empty() && !record.isDeferred()) {
+            append(id, record.level, timestamp, record.message);
+        } else {
+            append(id, record.level, timestamp, std::string_view(record.str()));
+        }
+    }
+
+    /**
+     * @brief Writes the buffered records of every thread to the file.
+     */
+    void flush() {
+        buffers.forEach([this](ThreadBuffer& buffer) {
+            std::lock_guard<std::mutex> lock(buffer.mutex);
+            writeBuffer(buffer);
+        });
+    }
+};
+
+/**
+ * @brief How BinaryLogDecoder renders records.
+ */
+struct BinaryDecodeOptions {
+    bool showLevel = true;                                    /**< Start lines with "[N] " like LogLevelDecorator. */
+    bool showTimestamp = true;                                /**< Add "[timestamp] " like TimestampDecorator. */
+    TimestampPrecision precision = TimestampPrecision::Seconds; /**< Fractional digits of the timestamp. */
+    TimeZone zone = TimeZone::Local;                          /**< Time zone of the timestamp. */
+};
+
+/**
+ * @brief Turns binary logs written by BinaryLogger back into text lines.
+ * 
+ * Each record becomes "[level] [timestamp] message", the text a TimestampDecorator wrapping a
+ * LogLevelDecorator produces; the message is formatted from the stored arguments with the
+ * same rules as formatMessage().
+ */
+class BinaryLogDecoder {
+private:
+    struct Argument {
+        BinaryArgumentType type = BinaryArgumentType::Int;
+        std::uint64_t bits = 0;
+        std::string_view text;
+    };
+
+    BinaryDecodeOptions options;
+    TimestampFormatter formatter;
+    std::vector<FormatRegistry::Entry> formats; /**< Definitions of the current session, by id - 1. */
+
+    class Reader {
+    public:
+        Reader(std::string_view data) : data(data) {}
+
+        bool done() const {
+            return position >= data.size();
+        }
+
+        std::size_t offset() const {
+            return position;
+        }
+
+        template <typename T>
+        T read() {
+            T value;
+            std::memcpy(&value, take(sizeof(T)).data(), sizeof(T));
+            return value;
+        }
+
+        std::string_view take(std::size_t size) {
+            if (data.size() - position < size) {
+                throw std::runtime_error("Truncated binary log");
+            }
+            std::string_view bytes = data.substr(position, size);
+            position += size;
+            return bytes;
+        }
+
+    private:
+        std::string_view data;
+        std::size_t position = 0;
+    };
+
+    static void appendArgument(std::string& out, const Argument& argument) {
+        switch (argument.type) {
+            case BinaryArgumentType::Bool: appendFormatted(out, argument.bits != 0); break;
+            case BinaryArgumentType::Char: appendFormatted(out, static_cast<char>(argument.bits)); break;
+            case BinaryArgumentType::Int: appendFormatted(out, static_cast<std::int64_t>(argument.bits)); break;
+            case BinaryArgumentType::UInt: appendFormatted(out, argument.bits); break;
+            case BinaryArgumentType::Double: {
+                double number;
+                std::memcpy(&number, &argument.bits, sizeof(number));
+                appendFormatted(out, number);
+                break;
+            }
+            case BinaryArgumentType::Pointer:
+                appendFormatted(out, reinterpret_cast<const void*>(static_cast<std::uintptr_t>(argument.bits)));
+                break;
+            case BinaryArgumentType::String: out.append(argument.text); break;
+        }
+    }
+
+    void readDefinition(Reader& reader) {
+        auto id = reader.read<std::uint32_t>();
+        auto argumentCount = reader.read<std::uint8_t>();
+        FormatRegistry::Entry entry;
+        for (std::uint8_t i = 0; i < argumentCount; ++i) {
+            auto type = reader.read<std::uint8_t>();
+            if (type > static_cast<std::uint8_t>(BinaryArgumentType::String)) {
+                throw std::runtime_error("Unknown argument type in binary log");
+            }
+            entry.argumentTypes.push_back(static_cast<BinaryArgumentType>(type));
+        }
+        entry.format = std::string(reader.take(reader.read<std::uint32_t>()));
+        if (id == 0) {
+            throw std::runtime_error("Invalid format id in binary log");
+        }
+        if (formats.size() < id) {
+            formats.resize(id);
+        }
+        formats[id - 1] = std::move(entry);
+    }
+
+    void readRecord(Reader& reader, std::string& out) {
+        auto id = reader.read<std::uint32_t>();
+        auto level = reader.read<std::uint8_t>();
+        auto timestamp = reader.read<std::int64_t>();
+        if (id == 0 || id > formats.size()) {
+            throw std::runtime_error("Undefined format id in binary log");
+        }
+        const FormatRegistry::Entry& entry = formats[id - 1];
+
+        std::vector<Argument> arguments(entry.argumentTypes.size());
+        for (std::size_t i = 0; i < arguments.size(); ++i) {
+            Argument& argument = arguments[i];
+            argument.type = entry.argumentTypes[i];
+            switch (argument.type) {
+                case BinaryArgumentType::Bool:
+                case BinaryArgumentType::Char:
+                    argument.bits = reader.read<std::uint8_t>();
+                    break;
+                case BinaryArgumentType::String:
+                    argument.text = reader.take(reader.read<std::uint32_t>());
+                    break;
+                default:
+                    argument.bits = reader.read<std::uint64_t>();
+                    break;
+            }
+        }
+
+        if (options.showLevel) {
+            out.push_back('[');
+            out.push_back(static_cast<char>('0' + level));
+            out.append("] ");
+        }
+        if (options.showTimestamp) {
+            char text[TimestampFormatter::MaxLength];
+            auto time = std::chrono::system_clock::time_point(
+                std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(timestamp)));
+            out.push_back('[');
+            out.append(text, formatter.format(time, text));
+            out.append("] ");
+        }
+        formatPlaceholders(out, entry.format, arguments.size(), [&arguments](std::string& text, std::size_t index) {
+            appendArgument(text, arguments[index]);
+        });
+        out.push_back('\n');
+    }
+
+public:
+    /**
+     * @brief Constructs a decoder with the specified rendering options.
+     * 
+     * @param options How records are rendered.
+     */
+    BinaryLogDecoder(BinaryDecodeOptions options = BinaryDecodeOptions())
+        : options(options), formatter(options.precision, options.zone) {}
+
+    /**
+     * @brief Decodes the contents of a binary log file and appends one text line per record.
+     * 
+     * @param data The contents of the file.
+     * @param out The string to append to.
+     * @return The number of records decoded.
+     * @throws std::runtime_error if the data is not a valid binary log.
+     */
+    std::size_t decode(std::string_view data, std::string& out) {
+        if (data.substr(0, sizeof(binary_encoding::FileMagic)) != std::string_view(binary_encoding::FileMagic, sizeof(binary_encoding::FileMagic))) {
+            throw std::runtime_error("Not a binary log");
+        }
+        Reader reader(data);
+        std::size_t records = 0;
+        while (!reader.done()) {
+            char tag = reader.read<char>();
+            if (tag == binary_encoding::FileMagic[0]) {
+                std::string_view magic = reader.take(sizeof(binary_encoding::FileMagic) - 1);
+                if (magic != std::string_view(binary_encoding::FileMagic + 1, sizeof(binary_encoding::FileMagic) - 1)
+                    || reader.read<std::uint32_t>() != binary_encoding::FileVersion) {
+                    throw std::runtime_error("Not a binary log of a supported version");
+                }
+                formats.clear();
+            } else if (tag == binary_encoding::DefinitionTag) {
+                readDefinition(reader);
+            } else if (tag == binary_encoding::RecordTag) {
+                readRecord(reader, out);
+                ++records;
+            } else {
+                throw std::runtime_error("Corrupt binary log at offset " + std::to_string(reader.offset() - 1));
+            }
+        }
+        return records;
+    }
+};
+
+/**
+ * @brief Resolves the logger argument of CPPLOGGER_BINARY_LOG to a reference.
+ */
+inline BinaryLogger& binaryLoggerReference(BinaryLogger& logger) {
+    return logger;
+}
+
+inline BinaryLogger& binaryLoggerReference(BinaryLogger* logger) {
+    return *logger;
+}
+
+inline BinaryLogger& binaryLoggerReference(const std::unique_ptr<BinaryLogger>& logger) {
+    return *logger;
+}
+
+// Compile-time filtered logging macros
+/**
+ * @brief Resolves the logger argument of the CPPLOGGER_LOG macros to a reference.
+ * 
+ * The macros accept a logger reference, a raw pointer or a std::unique_ptr, to an ILogger or a Pipeline.
+ */
+inline ILogger& loggerReference(ILogger& logger) {
+    return logger;
+}
+
+inline ILogger& loggerReference(ILogger* logger) {
+    return *logger;
+}
+
+template <typename T>
+ILogger& loggerReference(const std::unique_ptr<T>& logger) {
+    return *logger;
+}
+
+template <typename... Parts>
+Pipeline<Parts...>& loggerReference(Pipeline<Parts...>& pipeline) {
+    return pipeline;
+}
+
+template <typename... Parts>
+Pipeline<Parts...>& loggerReference(const std::unique_ptr<Pipeline<Parts...>>& pipeline) {
+    return *pipeline;
+}
+
+/**
+ * @brief Logs a message unless its level is more verbose than a compile-time minimum level.
+ * 
+ * Both levels must be constant expressions. When the call is stripped, the whole statement is
+ * discarded at compile time, so the message expression is never evaluated. Calls that survive
+ * check ILogger::isEnabled() before evaluating the message, then go through the normal
+ * ILogger::log() path, with a LogSite that identifies the call site.
+ */
+#define CPPLOGGER_LOG_WITH_MIN(minLevel, logger, level, ...)                           \
+    do {                                                                                \
+        if constexpr (isLevelCompiledIn((level), (minLevel))) {                         \
+            auto& cppLoggerTarget = loggerReference(logger);                            \
+            if (cppLoggerTarget.isEnabled(level)) {                                     \
+                static constexpr LogSite cppLoggerSite{};                               \
+                cppLoggerTarget.log(cppLoggerSite, (level), __VA_ARGS__);               \
+            }                                                                           \
+        }                                                                               \
+    } while (false)
+
+/**
+ * @brief Logs a message unless its level is more verbose than CPPLOGGER_MIN_LEVEL.
+ * 
+ * The message may be a plain string or a format string followed by its arguments.
+ */
+#define CPPLOGGER_LOG(logger, level, ...) CPPLOGGER_LOG_WITH_MIN(CompiledMinLevel, logger, level, __VA_ARGS__)
+
+#define CPPLOGGER_FATAL(logger, ...) CPPLOGGER_LOG(logger, LogLevel::Fatal, __VA_ARGS__)
+#define CPPLOGGER_ERROR(logger, ...) CPPLOGGER_LOG(logger, LogLevel::Error, __VA_ARGS__)
+#define CPPLOGGER_WARNING(logger, ...) CPPLOGGER_LOG(logger, LogLevel::Warning, __VA_ARGS__)
+#define CPPLOGGER_INFO(logger, ...) CPPLOGGER_LOG(logger, LogLevel::Info, __VA_ARGS__)
+#define CPPLOGGER_DEBUG(logger, ...) CPPLOGGER_LOG(logger, LogLevel::Debug, __VA_ARGS__)
+#define CPPLOGGER_NOISE(logger, ...) CPPLOGGER_LOG(logger, LogLevel::Noise, __VA_ARGS__)
+
+/**
+ * @brief Logs a binary record on a BinaryLogger, stripped like CPPLOGGER_LOG.
+ * 
+ * The arguments after the level are the format string (a string literal) and its arguments;
+ * the call site is registered with the FormatRegistry the first time it runs.
+ */
+#define CPPLOGGER_BINARY_LOG(logger, level, ...)                                            \
+    do {                                                                                    \
+        if constexpr (isLevelCompiledIn((level))) {                                         \
+            BinaryLogger& cppLoggerBinaryTarget = binaryLoggerReference(logger);            \
+            if (cppLoggerBinaryTarget.isEnabled(level)) {                                   \
+                static BinaryFormatSite cppLoggerFormatSite;                                \
+                cppLoggerBinaryTarget.logBinary(cppLoggerFormatSite, (level), __VA_ARGS__); \
+            }                                                                               \
+        }                                                                                   \
+    } while (false)
+
+// Logger configuration
+/**
+ * @brief A JSON value, as read from a logger configuration.
+ * 
+ * The parser supports what configuration files need: objects, arrays, strings with the
+ * standard escapes, numbers, true, false and null. Errors throw std::invalid_argument with the
+ * offset at which parsing failed.
+ */
+class ConfigValue {
 public:
     /**
-     * @brief Constructs a Logger object with the specified output strategy.
+     * @brief The kind of a value.
+     */
+    enum class Type {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object
+    };
+
+    Type type = Type::Null;
+    bool boolValue = false;
+    double numberValue = 0;
+    std::string stringValue;
+    std::vector<ConfigValue> items;                            /**< The elements of an array. */
+    std::vector<std::pair<std::string, ConfigValue>> members;  /**< The members of an object, in order. */
+
+    /**
+     * @brief Parses a JSON document.
      * 
-     * @param outputStrategy The output strategy to be used for logging.
+     * @param text The document.
+     * @return The root value.
      */
-    Logger(std::unique_ptr<IOutputStrategy> outputStrategy) : outputStrategy(std::move(outputStrategy)) {}
+    static ConfigValue parse(std::string_view text) {
+        Parser parser{text};
+        ConfigValue value = parser.parseValue(0);
+        parser.skipWhitespace();
+        if (parser.pos != text.size()) {
+            parser.fail("unexpected trailing characters");
+        }
+        return value;
+    }
 
     /**
-     * @brief Logs a message with the specified log level.
+     * @brief Returns the member with the specified key, or nullptr if there is none.
      * 
-     * @param level The log level of the message.
-     * @param message The message to be logged.
+     * @param key The key to look up.
+     */
+    const ConfigValue* find(std::string_view key) const {
+        for (const auto& member : members) {
+            if (member.first == key) {
+                return &member.second;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Returns a string member, or the fallback if it is missing.
+     * 
+     * @param key The key to look up.
+     * @param fallback The value to return if the member is missing.
+     */
+    std::string stringOr(std::string_view key, std::string_view fallback) const {
+        const ConfigValue* value = find(key);
+        if (value == nullptr) {
+            return std::string(fallback);
+        }
+        value->expect(Type::String, key);
+        return value->stringValue;
+    }
+
+    /**
+     * @brief Returns a number member, or the fallback if it is missing.
+     * 
+     * @param key The key to look up.
+     * @param fallback The value to return if the member is missing.
+     */
+    double numberOr(std::string_view key, double fallback) const {
+        const ConfigValue* value = find(key);
+        if (value == nullptr) {
+            return fallback;
+        }
+        value->expect(Type::Number, key);
+        return value->numberValue;
+    }
+
+    /**
+     * @brief Returns a whole-number member, or the fallback if it is missing.
+     * 
+     * @param key The key to look up.
+     * @param fallback The value to return if the member is missing.
+     * @param minimum The smallest accepted value.
+     * @param maximum The largest accepted value; well below 2^63, so it is exact as a double.
+     * @throws std::invalid_argument if the member is not a whole number from minimum to maximum.
+     */
+    std::int64_t integerOr(std::string_view key, std::int64_t fallback, std::int64_t minimum, std::int64_t maximum) const {
+        const ConfigValue* value = find(key);
+        if (value == nullptr) {
+            return fallback;
+        }
+        value->expect(Type::Number, key);
+        double number = value->numberValue;
+        if (!(number >= static_cast<double>(minimum) && number <= static_cast<double>(maximum))
+            || number != static_cast<double>(static_cast<std::int64_t>(number))) {
+            throw std::invalid_argument("Logger config: \"" + std::string(key) + "\" must be a whole number from " +
+                                        std::to_string(minimum) + " to " + std::to_string(maximum));
+        }
+        return static_cast<std::int64_t>(number);
+    }
+
+    /**
+     * @brief Returns a boolean member, or the fallback if it is missing.
+     * 
+     * @param key The key to look up.
+     * @param fallback The value to return if the member is missing.
+     */
+    bool boolOr(std::string_view key, bool fallback) const {
+        const ConfigValue* value = find(key);
+        if (value == nullptr) {
+            return fallback;
+        }
+        value->expect(Type::Bool, key);
+        return value->boolValue;
+    }
+
+    /**
+     * @brief Throws std::invalid_argument unless the value has the specified type.
+     * 
+     * @param expected The required type.
+     * @param what The name of the value, for the error message.
      */
-    void log(LogLevel level, const std::string& message) override {
-        outputStrategy->output(message);
+    void expect(Type expected, std::string_view what) const {
+        static constexpr std::string_view names[] = {"null", "a boolean", "a number", "a string", "an array", "an object"};
+        if (type != expected) {
+            throw std::invalid_argument("Logger config: \"" + std::string(what) + "\" must be " +
+                                        std::string(names[static_cast<int>(expected)]));
+        }
+    }
+
+private:
+    static constexpr int MaxDepth = 64; /**< Nesting limit, so hostile input cannot exhaust the stack. */
+
+    struct Parser {
+        std::string_view text;
+        std::size_t pos = 0;
+
+        [[noreturn]] void fail(const char* reason) const {
+            throw std::invalid_argument("Logger config: " + std::string(reason) + " at offset " + std::to_string(pos));
+        }
+
+        void skipWhitespace() {
+            while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r')) {
+                ++pos;
+            }
+        }
+
+        bool consume(char c) {
+            skipWhitespace();
+            if (pos < text.size() && text[pos] == c) {
+                ++pos;
+                return true;
+            }
+            return false;
+        }
+
+        bool consumeWord(std::string_view word) {
+            if (text.substr(pos, word.size()) == word) {
+                pos += word.size();
+                return true;
+            }
+            return false;
+        }
+
+        ConfigValue parseValue(int depth) {
+            if (depth > MaxDepth) {
+                fail("nesting too deep");
+            }
+            skipWhitespace();
+            if (pos >= text.size()) {
+                fail("unexpected end of input");
+            }
+            ConfigValue value;
+            char c = text[pos];
+            if (c == '{') {
+                ++pos;
+                value.type = Type::Object;
+                if (consume('}')) {
+                    return value;
+                }
+                do {
+                    skipWhitespace();
+                    std::string key = parseString();
+                    if (!consume(':')) {
+                        fail("expected ':'");
+                    }
+                    value.members.emplace_back(std::move(key), parseValue(depth + 1));
+                } while (consume(','));
+                if (!consume('}')) {
+                    fail("expected ',' or '}'");
+                }
+            } else if (c == '[') {
+                ++pos;
+                value.type = Type::Array;
+                if (consume(']')) {
+                    return value;
+                }
+                do {
+                    value.items.push_back(parseValue(depth + 1));
+                } while (consume(','));
+                if (!consume(']')) {
+                    fail("expected ',' or ']'");
+                }
+            } else if (c == '"') {
+                value.type = Type::String;
+                value.stringValue = parseString();
+            } else if (consumeWord("true")) {
+                value.type = Type::Bool;
+                value.boolValue = true;
+            } else if (consumeWord("false")) {
+                value.type = Type::Bool;
+            } else if (consumeWord("null")) {
+                value.type = Type::Null;
+            } else {
+                value.type = Type::Number;
+                value.numberValue = parseNumber();
+            }
+            return value;
+        }
+
+        std::string parseString() {
+            if (pos >= text.size() || text[pos] != '"') {
+                fail("expected a string");
+            }
+            ++pos;
+            std::string result;
+            while (pos < text.size() && text[pos] != '"') {
+                char c = text[pos++];
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    fail("control character in string");
+                }
+                if (c != '\\') {
+                    result.push_back(c);
+                    continue;
+                }
+                if (pos >= text.size()) {
+                    break;
+                }
+                char escape = text[pos++];
+                switch (escape) {
+                    case '"': result.push_back('"'); break;
+                    case '\\': result.push_back('\\'); break;
+                    case '/': result.push_back('/'); break;
+                    case 'b': result.push_back('\b'); break;
+                    case 'f': result.push_back('\f'); break;
+                    case 'n': result.push_back('\n'); break;
+                    case 'r': result.push_back('\r'); break;
+                    case 't': result.push_back('\t'); break;
+                    case 'u': appendCodePoint(result, parseCodePoint()); break;
+                    default: fail("invalid escape");
+                }
+            }
+            if (pos >= text.size()) {
+                fail("unterminated string");
+            }
+            ++pos;
+            return result;
+        }
+
+        unsigned parseHex() {
+            if (pos + 4 > text.size()) {
+                fail("truncated \\u escape");
+            }
+            unsigned value = 0;
+            auto result = std::from_chars(text.data() + pos, text.data() + pos + 4, value, 16);
+            if (result.ptr != text.data() + pos + 4) {
+                fail("invalid \\u escape");
+            }
+            pos += 4;
+            return value;
+        }
+
+        /**
+         * @brief Reads the digits of a unicode escape, plus the low half that must follow a high surrogate.
+         */
+        unsigned parseCodePoint() {
+            unsigned code = parseHex();
+            if (code >= 0xDC00 && code <= 0xDFFF) {
+                fail("lone low surrogate in \\u escape");
+            }
+            if (code < 0xD800 || code > 0xDBFF) {
+                return code;
+            }
+            if (pos + 2 > text.size() || text[pos] != '\\' || text[pos + 1] != 'u') {
+                fail("lone high surrogate in \\u escape");
+            }
+            pos += 2;
+            unsigned low = parseHex();
+            if (low < 0xDC00 || low > 0xDFFF) {
+                fail("lone high surrogate in \\u escape");
+            }
+            return 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+        }
+
+        static void appendCodePoint(std::string& out, unsigned code) {
+            if (code < 0x80) {
+                out.push_back(static_cast<char>(code));
+            } else if (code < 0x800) {
+                out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+                out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+            } else if (code < 0x10000) {
+                out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+                out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+            } else {
+                out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+                out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+            }
+        }
+
+        double parseNumber() {
+            std::size_t start = pos;
+            while (pos < text.size() && (std::isdigit(static_cast<unsigned char>(text[pos])) || text[pos] == '-' ||
+                                         text[pos] == '+' || text[pos] == '.' || text[pos] == 'e' || text[pos] == 'E')) {
+                ++pos;
+            }
+            if (start == pos) {
+                fail("unexpected character");
+            }
+            std::string number(text.substr(start, pos - start));
+            char* end = nullptr;
+            double value = std::strtod(number.c_str(), &end);
+            if (end != number.c_str() + number.size()) {
+                pos = start;
+                fail("invalid number");
+            }
+            return value;
+        }
+    };
+};
+
+/**
+ * @brief Builds logger pipelines from a configuration document.
+ * 
+ * A configuration is a JSON object; every key is optional:
+ * 
+ *     {
+ *       "level": "info",
+ *       "decorators": ["timestamp", {"type": "context", "placement": "fields"}, "level"],
+ *       "async": {"capacity": 8192, "overflow": "shed_by_level", "block_timeout_us": 1000},
+ *       "fan_out": false,
+ *       "sinks": [{"type": "console"}, {"type": "file", "path": "app.log", "format": "json"}]
+ *     }
+ * 
+ * "level" adds an outermost LevelFilterDecorator. Decorators are listed outermost first: "level",
+ * "timestamp" (with "precision" s/ms/us and "utc") and "context" (with "placement"
+ * prefix/fields/both). "async" (true or an object) hands records to an AsyncLogger instead of
+ * writing them on the calling thread. Sinks are "console", "file" (with "path" and "buffered",
+ * true by default), "compressed" (a gzip CompressedFileOutput with "path", "block_size" and
+ * "compression_level"), "durable" (a DurableFileOutput with "path", "durable_level" and
+ * "max_commit_delay_us") and "null"; "format": "json" wraps a sink in a JsonOutput. Several sinks are
+ * combined in a MultiOutput, or in a FanOutOutput with "fan_out", where each sink takes its own
+ * "overflow" and "queue_capacity". Overflow policies are named block, block_with_timeout,
+ * drop_newest, overwrite_oldest and shed_by_level. "category" wraps the chain in a
+ * CategoryDecorator of the global CategoryRegistry, and "categories", an object such as
+ * {"net": "debug", "storage.wal": "warning"}, sets levels in that registry. Unknown names throw
+ * std::invalid_argument.
+ */
+namespace logger_config {
+
+constexpr std::int64_t MaxCapacity = std::int64_t(1) << 30;        /**< Largest queue capacity or block size a config may ask for. */
+constexpr std::int64_t MaxDelayMicroseconds = 3600LL * 1000 * 1000; /**< Longest timeout or delay a config may ask for: one hour. */
+
+/**
+ * @brief Returns the log level with the specified lower-case name.
+ * 
+ * @param name One of fatal, error, warning, info, debug and noise.
+ */
+inline LogLevel parseLevel(std::string_view name) {
+    static constexpr std::string_view names[] = {"fatal", "error", "warning", "info", "debug", "noise"};
+    for (int i = 0; i <= static_cast<int>(LogLevel::Noise); ++i) {
+        if (names[i] == name) {
+            return static_cast<LogLevel>(i);
+        }
+    }
+    throw std::invalid_argument("Logger config: unknown level \"" + std::string(name) + "\"");
+}
+
+/**
+ * @brief Returns the overflow policy with the specified name.
+ * 
+ * @param name One of block, block_with_timeout, drop_newest, overwrite_oldest and shed_by_level.
+ */
+inline OverflowPolicy parseOverflowPolicy(std::string_view name) {
+    static constexpr std::pair<std::string_view, OverflowPolicy> policies[] = {
+        {"block", OverflowPolicy::Block},
+        {"block_with_timeout", OverflowPolicy::BlockWithTimeout},
+        {"drop_newest", OverflowPolicy::DropNewest},
+        {"overwrite_oldest", OverflowPolicy::OverwriteOldest},
+        {"shed_by_level", OverflowPolicy::ShedByLevel},
+    };
+    for (const auto& policy : policies) {
+        if (policy.first == name) {
+            return policy.second;
+        }
     }
+    throw std::invalid_argument("Logger config: unknown overflow policy \"" + std::string(name) + "\"");
+}
+
+/**
+ * @brief Discards every record, for sinks that are switched off.
+ */
+class NullOutput : public IOutputStrategy {
+public:
+    void output(const std::string&) override {}
 };
 
+/**
+ * @brief Builds the output strategy described by one entry of "sinks".
+ * 
+ * @param sink The sink object.
+ */
+inline std::unique_ptr<IOutputStrategy> buildSink(const ConfigValue& sink) {
+    sink.expect(ConfigValue::Type::Object, "sinks");
+    std::string type = sink.stringOr("type", "");
+    std::unique_ptr<IOutputStrategy> output;
+    if (type == "console") {
+        output = std::make_unique<ConsoleOutput>();
+    } else if (type == "file") {
+        std::string path = sink.stringOr("path", "");
+        if (path.empty()) {
+            throw std::invalid_argument("Logger config: a file sink needs a \"path\"");
+        }
+        if (sink.boolOr("buffered", true)) {
+            output = std::make_unique<BufferedFileOutput>(path);
+        } else {
+            output = std::make_unique<FileOutput>(path);
+        }
+    } else if (type == "compressed") {
+        std::string path = sink.stringOr("path", "");
+        if (path.empty()) {
+            throw std::invalid_argument("Logger config: a compressed sink needs a \"path\"");
+        }
+        CompressionOptions options;
+        options.blockSize = static_cast<std::size_t>(sink.integerOr("block_size", static_cast<std::int64_t>(options.blockSize), 1, MaxCapacity));
+        options.level = static_cast<int>(sink.integerOr("compression_level", options.level, 1, 9));
+        output = std::make_unique<CompressedFileOutput>(path, options);
+    } else if (type == "durable") {
+        std::string path = sink.stringOr("path", "");
+        if (path.empty()) {
+            throw std::invalid_argument("Logger config: a durable sink needs a \"path\"");
+        }
+        DurabilityOptions options;
+        options.durableLevel = parseLevel(sink.stringOr("durable_level", "error"));
+        options.maxCommitDelay = std::chrono::microseconds(
+            sink.integerOr("max_commit_delay_us", options.maxCommitDelay.count(), 0, MaxDelayMicroseconds));
+        output = std::make_unique<DurableFileOutput>(path, options);
+    } else if (type == "null") {
+        output = std::make_unique<NullOutput>();
+    } else {
+        throw std::invalid_argument("Logger config: unknown sink type \"" + type + "\"");
+    }
+
+    std::string format = sink.stringOr("format", "text");
+    if (format == "json") {
+        output = std::make_unique<JsonOutput>(std::move(output));
+    } else if (format != "text") {
+        throw std::invalid_argument("Logger config: unknown sink format \"" + format + "\"");
+    }
+    return output;
+}
+
+/**
+ * @brief Builds the output strategy for every sink of the configuration.
+ * 
+ * @param config The configuration object.
+ */
+inline std::unique_ptr<IOutputStrategy> buildOutput(const ConfigValue& config) {
+    const ConfigValue* sinks = config.find("sinks");
+    if (sinks == nullptr) {
+        return std::make_unique<ConsoleOutput>();
+    }
+    sinks->expect(ConfigValue::Type::Array, "sinks");
+    if (sinks->items.size() == 1) {
+        return buildSink(sinks->items.front());
+    }
+    if (config.boolOr("fan_out", false)) {
+        std::vector<SinkConfig> configs;
+        for (const ConfigValue& sink : sinks->items) {
+            SinkConfig sinkConfig{buildSink(sink)};
+            sinkConfig.overflowPolicy = parseOverflowPolicy(sink.stringOr("overflow", "block"));
+            sinkConfig.queueCapacity = static_cast<std::size_t>(sink.integerOr("queue_capacity", 8192, 1, MaxCapacity));
+            configs.push_back(std::move(sinkConfig));
+        }
+        return std::make_unique<FanOutOutput>(std::move(configs));
+    }
+    std::vector<std::unique_ptr<IOutputStrategy>> outputs;
+    for (const ConfigValue& sink : sinks->items) {
+        outputs.push_back(buildSink(sink));
+    }
+    return std::make_unique<MultiOutput>(std::move(outputs));
+}
+
+/**
+ * @brief Wraps a logger in the decorator described by one entry of "decorators".
+ * 
+ * @param decorator The decorator name, or an object with a "type" and options.
+ * @param logger The logger to be decorated.
+ */
+inline std::unique_ptr<ILogger> wrapDecorator(const ConfigValue& decorator, std::unique_ptr<ILogger> logger) {
+    ConfigValue options;
+    std::string type;
+    if (decorator.type == ConfigValue::Type::String) {
+        type = decorator.stringValue;
+    } else {
+        decorator.expect(ConfigValue::Type::Object, "decorators");
+        type = decorator.stringOr("type", "");
+    }
+    const ConfigValue& settings = decorator.type == ConfigValue::Type::Object ? decorator : options;
+
+    if (type == "level") {
+        return std::make_unique<LogLevelDecorator>(std::move(logger));
+    }
+    if (type == "timestamp") {
+        std::string precision = settings.stringOr("precision", "s");
+        TimestampPrecision parsed = TimestampPrecision::Seconds;
+        if (precision == "ms") {
+            parsed = TimestampPrecision::Milliseconds;
+        } else if (precision == "us") {
+            parsed = TimestampPrecision::Microseconds;
+        } else if (precision != "s") {
+            throw std::invalid_argument("Logger config: unknown timestamp precision \"" + precision + "\"");
+        }
+        TimeZone zone = settings.boolOr("utc", false) ? TimeZone::Utc : TimeZone::Local;
+        return std::make_unique<TimestampDecorator>(std::move(logger), parsed, zone);
+    }
+    if (type == "context") {
+        std::string placement = settings.stringOr("placement", "prefix");
+        ContextPlacement parsed = ContextPlacement::Prefix;
+        if (placement == "fields") {
+            parsed = ContextPlacement::Fields;
+        } else if (placement == "both") {
+            parsed = ContextPlacement::Both;
+        } else if (placement != "prefix") {
+            throw std::invalid_argument("Logger config: unknown context placement \"" + placement + "\"");
+        }
+        return std::make_unique<ContextDecorator>(std::move(logger), parsed);
+    }
+    throw std::invalid_argument("Logger config: unknown decorator \"" + type + "\"");
+}
+
+/**
+ * @brief Builds the complete logger chain described by a configuration.
+ * 
+ * @param config The configuration object.
+ */
+inline std::unique_ptr<ILogger> build(const ConfigValue& config) {
+    config.expect(ConfigValue::Type::Object, "config");
+
+    // Levels of "categories" go into the global registry only once the whole config was accepted
+    std::vector<std::pair<std::string_view, LogLevel>> categoryLevels;
+    if (const ConfigValue* categories = config.find("categories")) {
+        categories->expect(ConfigValue::Type::Object, "categories");
+        for (const auto& category : categories->members) {
+            category.second.expect(ConfigValue::Type::String, category.first);
+            categoryLevels.emplace_back(category.first, parseLevel(category.second.stringValue));
+        }
+    }
+
+    std::unique_ptr<IOutputStrategy> output = buildOutput(config);
+
+    std::unique_ptr<ILogger> logger;
+    const ConfigValue* async = config.find("async");
+    if (async == nullptr) {
+        logger = std::make_unique<Logger>(std::move(output));
+    } else if (async->type == ConfigValue::Type::Object) {
+        QueueOptions options;
+        options.capacity = static_cast<std::size_t>(
+            async->integerOr("capacity", static_cast<std::int64_t>(AsyncLogger::DefaultCapacity), 1, MaxCapacity));
+        options.overflowPolicy = parseOverflowPolicy(async->stringOr("overflow", "block"));
+        options.blockTimeout = std::chrono::microseconds(
+            async->integerOr("block_timeout_us", options.blockTimeout.count(), 0, MaxDelayMicroseconds));
+        logger = std::make_unique<AsyncLogger>(std::move(output), options);
+    } else {
+        async->expect(ConfigValue::Type::Bool, "async");
+        if (async->boolValue) {
+            logger = std::make_unique<AsyncLogger>(std::move(output));
+        } else {
+            logger = std::make_unique<Logger>(std::move(output));
+        }
+    }
+
+    if (const ConfigValue* decorators = config.find("decorators")) {
+        decorators->expect(ConfigValue::Type::Array, "decorators");
+        for (auto it = decorators->items.rbegin(); it != decorators->items.rend(); ++it) {
+            logger = wrapDecorator(*it, std::move(logger));
+        }
+    }
+
+    if (config.find("level") != nullptr) {
+        logger = std::make_unique<LevelFilterDecorator>(std::move(logger), parseLevel(config.stringOr("level", "info")));
+    }
+
+    if (config.find("category") != nullptr) {
+        logger = std::make_unique<CategoryDecorator>(std::move(logger), config.stringOr("category", ""));
+    }
+    for (const auto& categoryLevel : categoryLevels) {
+        CategoryRegistry::global().setLevel(categoryLevel.first, categoryLevel.second);
+    }
+    return logger;
+}
+
+} // namespace logger_config
+
 // Logger Factory
 /**
  * @brief The LoggerFactory class is responsible for creating instances of ILogger.
@@ -366,6 +9042,18 @@ public:
         return std::make_unique<LevelFilterDecorator>(std::make_unique<Logger>(std::make_unique<FileOutput>(filename)));
     }
 
+    /**
+     * @brief Creates a buffered file logger with level filter decorator.
+     * 
+     * @param filename The name of the file to log to.
+     * @param policy The policy that decides when buffered messages are written.
+     * @return A unique pointer to the created ILogger instance.
+     */
+    static std::unique_ptr<LevelFilterDecorator> createFileLoggerWithLevelFilter(std::string filename, const FlushPolicy& policy)
+    {
+        return std::make_unique<LevelFilterDecorator>(std::make_unique<Logger>(std::make_unique<BufferedFileOutput>(filename, policy)));
+    }
+
     /**
      * @brief Creates a file logger with level and timestamp decorators.
      * 
@@ -376,4 +9064,196 @@ public:
     {
         return std::make_unique<TimestampDecorator>(std::make_unique<Logger>(std::make_unique<FileOutput>(filename)));
     }
+
+    /**
+     * @brief Creates a buffered file logger with level and timestamp decorators.
+     * 
+     * @param filename The name of the file to log to.
+     * @param policy The policy that decides when buffered messages are written.
+     * @return A unique pointer to the created ILogger instance.
+     */
+    static std::unique_ptr<ILoggerDecorator> createFileLoggerWithLevelAndTimestamp(std::string filename, const FlushPolicy& policy)
+    {
+        return std::make_unique<TimestampDecorator>(std::make_unique<Logger>(std::make_unique<BufferedFileOutput>(filename, policy)));
+    }
+
+    /**
+     * @brief Creates a file logger that writes from a background thread.
+     * 
+     * @param filename The name of the file to log to.
+     * @param capacity The number of records that can be queued before log() starts waiting.
+     * @return A unique pointer to the created AsyncLogger instance.
+     */
+    static std::unique_ptr<AsyncLogger> createAsyncFileLogger(std::string filename, std::size_t capacity = AsyncLogger::DefaultCapacity)
+    {
+        return std::make_unique<AsyncLogger>(std::make_unique<FileOutput>(filename), capacity);
+    }
+
+    /**
+     * @brief Creates a file logger that writes from a background thread, with an overflow policy.
+     * 
+     * @param filename The name of the file to log to.
+     * @param options The capacity of the queue and what log() does when it is full.
+     * @return A unique pointer to the created AsyncLogger instance.
+     */
+    static std::unique_ptr<AsyncLogger> createAsyncFileLogger(std::string filename, const QueueOptions& options)
+    {
+        return std::make_unique<AsyncLogger>(std::make_unique<FileOutput>(filename), options);
+    }
+
+    /**
+     * @brief Creates a file logger that many threads can share without contending on a lock.
+     * 
+     * @param filename The name of the file to log to.
+     * @param options The ordering, merge interval and shard capacity.
+     * @return A unique pointer to the created ShardedLogger instance.
+     */
+    static std::unique_ptr<ShardedLogger> createShardedFileLogger(std::string filename, ShardedLoggerOptions options = ShardedLoggerOptions())
+    {
+        return std::make_unique<ShardedLogger>(std::make_unique<BufferedFileOutput>(filename), options);
+    }
+
+    /**
+     * @brief Creates a buffered file logger for one category, tagged with the category name.
+     * 
+     * @param filename The name of the file to log to.
+     * @param registry The registry the category belongs to. It must outlive the logger.
+     * @param category The category whose effective level filters the records.
+     * @param policy The policy that decides when buffered messages are written.
+     * @return A unique pointer to the created CategoryDecorator instance.
+     */
+    static std::unique_ptr<CategoryDecorator> createCategoryFileLogger(std::string filename, CategoryRegistry& registry,
+                                                                       Category category, const FlushPolicy& policy = FlushPolicy())
+    {
+        return std::make_unique<CategoryDecorator>(std::make_unique<Logger>(std::make_unique<BufferedFileOutput>(filename, policy)),
+                                                   registry, category);
+    }
+
+    /**
+     * @brief Wraps a pipeline in a CategoryDecorator, so it only passes what the category enables.
+     * 
+     * @param pipeline The logger chain, for example one returned by another factory method.
+     * @param registry The registry the category belongs to. It must outlive the logger.
+     * @param category The category handle.
+     * @return A unique pointer to the created CategoryDecorator instance.
+     */
+    static std::unique_ptr<CategoryDecorator> createCategoryLogger(std::unique_ptr<ILogger> pipeline, CategoryRegistry& registry,
+                                                                   Category category)
+    {
+        return std::make_unique<CategoryDecorator>(std::move(pipeline), registry, category);
+    }
+
+    /**
+     * @brief Creates the logger chain described by a JSON configuration.
+     * 
+     * @param json The configuration; see logger_config for the keys it understands.
+     * @return A unique pointer to the created ILogger instance.
+     */
+    static std::unique_ptr<ILogger> createFromConfig(std::string_view json)
+    {
+        return logger_config::build(ConfigValue::parse(json));
+    }
+
+    /**
+     * @brief Creates the logger chain described by a JSON configuration file.
+     * 
+     * @param path The path of the configuration file.
+     * @return A unique pointer to the created ILogger instance.
+     */
+    static std::unique_ptr<ILogger> createFromConfigFile(const std::string& path)
+    {
+        std::ifstream file(path);
+        if (!file) {
+            throw std::invalid_argument("Logger config: cannot open " + path);
+        }
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        return createFromConfig(contents.str());
+    }
+
+    /**
+     * @brief Creates a logger whose pipeline is read from a configuration file and can be reloaded.
+     * 
+     * Call reloadable->reload(LoggerFactory::createFromConfigFile(path)) to apply a changed file
+     * while other threads keep logging.
+     * 
+     * @param path The path of the configuration file.
+     * @return A unique pointer to the created ReloadableLogger instance.
+     */
+    static std::unique_ptr<ReloadableLogger> createReloadableLogger(const std::string& path)
+    {
+        return std::make_unique<ReloadableLogger>(createFromConfigFile(path));
+    }
+
+    /**
+     * @brief Creates a buffered file logger with level filter decorator that writes one JSON object per line.
+     * 
+     * @param filename The name of the file to log to.
+     * @param policy The policy that decides when buffered lines are written.
+     * @return A unique pointer to the created ILogger instance.
+     */
+    static std::unique_ptr<LevelFilterDecorator> createJsonFileLogger(std::string filename, const FlushPolicy& policy = FlushPolicy())
+    {
+        return std::make_unique<LevelFilterDecorator>(std::make_unique<Logger>(
+            std::make_unique<JsonOutput>(std::make_unique<BufferedFileOutput>(filename, policy))));
+    }
+
+    /**
+     * @brief Creates a fused console pipeline with level stage.
+     * 
+     * This is the statically composed counterpart of createConsoleLoggerWithLevel(); wrap it with
+     * makePipelineLogger() where an ILogger is needed.
+     * 
+     * @return A unique pointer to the created pipeline.
+     */
+    static std::unique_ptr<ConsolePipelineWithLevel> createConsolePipelineWithLevel()
+    {
+        return std::make_unique<ConsolePipelineWithLevel>();
+    }
+
+    /**
+     * @brief Creates a fused file pipeline with level filter stage.
+     * 
+     * @param filename The name of the file to log to.
+     * @return A unique pointer to the created pipeline.
+     */
+    static std::unique_ptr<FilePipelineWithLevelFilter> createFilePipelineWithLevelFilter(std::string filename)
+    {
+        return std::make_unique<FilePipelineWithLevelFilter>(filename);
+    }
+
+    /**
+     * @brief Creates a fused buffered file pipeline with level filter stage.
+     * 
+     * @param filename The name of the file to log to.
+     * @param policy The policy that decides when buffered messages are written.
+     * @return A unique pointer to the created pipeline.
+     */
+    static std::unique_ptr<BufferedFilePipelineWithLevelFilter> createFilePipelineWithLevelFilter(std::string filename, const FlushPolicy& policy)
+    {
+        return std::make_unique<BufferedFilePipelineWithLevelFilter>(filename, policy);
+    }
+
+    /**
+     * @brief Creates a fused file pipeline with timestamp stage.
+     * 
+     * @param filename The name of the file to log to.
+     * @return A unique pointer to the created pipeline.
+     */
+    static std::unique_ptr<FilePipelineWithLevelAndTimestamp> createFilePipelineWithLevelAndTimestamp(std::string filename)
+    {
+        return std::make_unique<FilePipelineWithLevelAndTimestamp>(filename);
+    }
+
+    /**
+     * @brief Creates a fused buffered file pipeline with timestamp stage.
+     * 
+     * @param filename The name of the file to log to.
+     * @param policy The policy that decides when buffered messages are written.
+     * @return A unique pointer to the created pipeline.
+     */
+    static std::unique_ptr<BufferedFilePipelineWithLevelAndTimestamp> createFilePipelineWithLevelAndTimestamp(std::string filename, const FlushPolicy& policy)
+    {
+        return std::make_unique<BufferedFilePipelineWithLevelAndTimestamp>(filename, policy);
+    }
 };
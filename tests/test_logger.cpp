@@ -3,6 +3,10 @@
 #include <gtest/gtest.h>
 #include "../include/logger.hpp"
 
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/wait.h>
+
 TEST(LoggerTest, CreateConsoleLoggerWithLevel)
 {
     std::unique_ptr<ILogger> logger = LoggerFactory::createConsoleLoggerWithLevel();
@@ -47,6 +51,124 @@ TEST(LoggerTest, ConsoleLoggerOutput)
     ASSERT_EQ(output.str(), message + "\n");
 }
 
+static std::string readPipe(int fd)
+{
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    std::string data;
+    char chunk[4096];
+    ssize_t received;
+    while ((received = ::read(fd, chunk, sizeof(chunk))) > 0) {
+        data.append(chunk, static_cast<std::size_t>(received));
+    }
+    return data;
+}
+
+TEST(LoggerTest, ConsoleOutputBlockBuffersOnPipe)
+{
+    // Arrange
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+    ConsoleOptions options;
+    options.outputFd = fds[1];
+    auto logger = std::make_unique<Logger>(std::make_unique<ConsoleOutput>(options));
+
+    // Act
+    logger->log(LogLevel::Info, "first");
+    logger->log(LogLevel::Debug, "second");
+    std::string beforeFlush = readPipe(fds[0]);
+    logger->log(LogLevel::Error, "third");
+    std::string afterError = readPipe(fds[0]);
+
+    // Assert
+    EXPECT_EQ(beforeFlush, "");
+    EXPECT_EQ(afterError, "first\nsecond\nthird\n");
+    logger.reset();
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+TEST(LoggerTest, ConsoleOutputLineBufferingAndErrorsToStderr)
+{
+    // Arrange
+    int outFds[2];
+    int errFds[2];
+    ASSERT_EQ(::pipe(outFds), 0);
+    ASSERT_EQ(::pipe(errFds), 0);
+    ConsoleOptions options;
+    options.buffering = ConsoleBuffering::Line;
+    options.errorsToStderr = true;
+    options.outputFd = outFds[1];
+    options.errorFd = errFds[1];
+    ConsoleOutput output(options);
+
+    // Act
+    output.output("plain");
+    std::string afterPlain = readPipe(outFds[0]);
+    output.write(LogRecord(LogLevel::Fatal, "fatal"));
+    output.write(LogRecord(LogLevel::Warning, "warning"));
+
+    // Assert
+    EXPECT_EQ(afterPlain, "plain\n");
+    EXPECT_EQ(readPipe(errFds[0]), "fatal\n");
+    EXPECT_EQ(readPipe(outFds[0]), "warning\n");
+    for (int fd : {outFds[0], outFds[1], errFds[0], errFds[1]}) {
+        ::close(fd);
+    }
+}
+
+TEST(LoggerTest, ConsoleOutputWritesOversizedRecordWithBuffer)
+{
+    // Arrange
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+    ConsoleOptions options;
+    options.buffering = ConsoleBuffering::Block;
+    options.bufferSize = 16;
+    options.outputFd = fds[1];
+    ConsoleOutput output(options);
+    std::string large(40, 'x');
+
+    // Act
+    output.output("small");
+    output.output(large);
+
+    // Assert
+    EXPECT_EQ(readPipe(fds[0]), "small\n" + large + "\n");
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+TEST(LoggerTest, ConsoleOutputsShareBufferAndDrainOnTimer)
+{
+    // Arrange
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+    ConsoleOptions options;
+    options.buffering = ConsoleBuffering::Block;
+    options.flushInterval = std::chrono::milliseconds(200);
+    options.outputFd = fds[1];
+    ConsoleOutput first(options);
+    ConsoleOutput second(options);
+
+    // Act
+    first.output("one");
+    second.output("two");
+    first.output("three");
+    std::string beforeInterval = readPipe(fds[0]);
+    std::string afterInterval;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (afterInterval.size() < 14 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        afterInterval += readPipe(fds[0]);
+    }
+
+    // Assert
+    EXPECT_EQ(beforeInterval, "");
+    EXPECT_EQ(afterInterval, "one\ntwo\nthree\n");
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
 TEST(LoggerTest, FileLoggerOutput)
 {
     // Arrange
@@ -138,3 +260,2498 @@ TEST(LoggerTest, MultiOutputLogger)
     std::string fileContent((std::istreambuf_iterator<char>(inputFile)), std::istreambuf_iterator<char>());
     ASSERT_EQ(fileContent, message + "\n");
 }
+
+TEST(LoggerTest, AsyncLoggerDrainsOnDestruction)
+{
+    // Arrange
+    std::string filename = "test_async.log";
+    std::ofstream file(filename);
+    file.close();
+
+    // Act
+    {
+        std::unique_ptr<ILogger> logger = LoggerFactory::createAsyncFileLogger(filename, 4);
+        for (int i = 0; i < 100; ++i) {
+            logger->log(LogLevel::Info, "Message " + std::to_string(i));
+        }
+    }
+
+    // Assert
+    std::ifstream inputFile(filename);
+    std::string line;
+    int count = 0;
+    while (std::getline(inputFile, line)) {
+        ASSERT_EQ(line, "Message " + std::to_string(count));
+        ++count;
+    }
+    ASSERT_EQ(count, 100);
+}
+
+TEST(LoggerTest, AsyncLoggerMultipleProducers)
+{
+    // Arrange
+    std::stringstream output;
+    std::streambuf* oldCoutBuffer = std::cout.rdbuf();
+    std::cout.rdbuf(output.rdbuf()); // Redirect cout to stringstream
+
+    auto logger = std::make_unique<AsyncLogger>(std::make_unique<ConsoleOutput>(), 64);
+    const int threadCount = 4;
+    const int messagesPerThread = 500;
+
+    // Act
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&logger, t] {
+            for (int i = 0; i < messagesPerThread; ++i) {
+                logger->log(LogLevel::Info, "Thread " + std::to_string(t));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    logger->flush();
+
+    // Assert
+    std::cout.rdbuf(oldCoutBuffer); // Restore cout buffer
+    std::string line;
+    int counts[threadCount] = {};
+    while (std::getline(output, line)) {
+        ASSERT_EQ(line.rfind("Thread ", 0), 0u);
+        counts[std::stoi(line.substr(7))]++;
+    }
+    for (int t = 0; t < threadCount; ++t) {
+        ASSERT_EQ(counts[t], messagesPerThread);
+    }
+}
+
+static std::string readFile(const std::string& filename)
+{
+    std::ifstream inputFile(filename);
+    return std::string((std::istreambuf_iterator<char>(inputFile)), std::istreambuf_iterator<char>());
+}
+
+TEST(LoggerTest, BufferedFileLoggerFlushPolicy)
+{
+    // Arrange
+    std::string filename = "test_buffered.log";
+    std::ofstream file(filename);
+    file.close();
+    FlushPolicy policy;
+    policy.bufferSize = 1024;
+    policy.flushInterval = std::chrono::hours(1);
+    policy.flushLevel = LogLevel::Error;
+    std::unique_ptr<ILogger> logger = std::make_unique<Logger>(std::make_unique<BufferedFileOutput>(filename, policy));
+
+    // Act & Assert
+    logger->log(LogLevel::Info, "Info message");
+    ASSERT_EQ(readFile(filename), "");
+    logger->log(LogLevel::Error, "Error message");
+    ASSERT_EQ(readFile(filename), "Info message\nError message\n");
+    logger->log(LogLevel::Info, "Buffered until destruction");
+    logger.reset();
+    ASSERT_EQ(readFile(filename), "Info message\nError message\nBuffered until destruction\n");
+}
+
+TEST(LoggerTest, BufferedFileLoggerWritesBurstFollowedBySilence)
+{
+    // Arrange
+    std::string filename = "test_buffered_interval.log";
+    std::ofstream file(filename);
+    file.close();
+    FlushPolicy policy;
+    policy.flushInterval = std::chrono::milliseconds(50);
+    auto logger = LoggerFactory::createFileLoggerWithLevelFilter(filename, policy);
+    logger->setMinLevel(LogLevel::Debug);
+
+    // Act
+    logger->log(LogLevel::Info, "burst 1");
+    logger->log(LogLevel::Debug, "burst 2");
+    std::string beforeDeadline = readFile(filename);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (readFile(filename).empty() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    // Assert
+    ASSERT_EQ(beforeDeadline, "");
+    ASSERT_EQ(readFile(filename), "burst 1\nburst 2\n"); // Without another record to trigger it
+}
+
+TEST(LoggerTest, BufferedFileLoggerFlushesWhenFull)
+{
+    // Arrange
+    std::string filename = "test_buffered_full.log";
+    std::ofstream file(filename);
+    file.close();
+    FlushPolicy policy;
+    policy.bufferSize = 16;
+    policy.flushInterval = std::chrono::hours(1);
+    auto logger = LoggerFactory::createFileLoggerWithLevelFilter(filename, policy);
+
+    // Act & Assert
+    logger->log(LogLevel::Info, "1234");
+    ASSERT_EQ(readFile(filename), "");
+    logger->log(LogLevel::Info, "0123456789");
+    ASSERT_EQ(readFile(filename), "1234\n0123456789\n");
+}
+
+TEST(LoggerTest, IoUringFileOutputDoubleBuffersAndAppends)
+{
+    // Arrange
+    std::string filename = "test_io_uring.log";
+    {
+        std::ofstream file(filename);
+        file << "existing\n";
+    }
+    FlushPolicy policy;
+    policy.bufferSize = 64;
+    policy.flushInterval = std::chrono::hours(1);
+    auto output = std::make_unique<IoUringFileOutput>(filename, policy);
+    IoUringFileOutput* sink = output.get();
+    auto logger = std::make_unique<Logger>(std::move(output));
+    std::string expected = "existing\n";
+
+    // Act
+    logger->log(LogLevel::Info, "held");
+    std::string beforeFlush = readFile(filename);
+    for (int i = 0; i < 200; ++i) {
+        std::string message = "record " + std::to_string(i);
+        logger->log(LogLevel::Info, message);
+        expected += message + "\n";
+    }
+    std::string large(150, 'x');
+    logger->log(LogLevel::Info, large);
+    sink->flush();
+    std::string afterFlush = readFile(filename);
+    logger->log(LogLevel::Info, "at destruction");
+    logger.reset();
+
+    // Assert
+    EXPECT_EQ(beforeFlush, "existing\n");
+    EXPECT_EQ(afterFlush, "existing\nheld\n" + expected.substr(9) + large + "\n");
+    EXPECT_EQ(readFile(filename), afterFlush + "at destruction\n");
+    std::remove(filename.c_str());
+}
+
+TEST(LoggerTest, TimestampFormatterUtcPrecision)
+{
+    // 2021-01-02 03:04:05.678901 UTC
+    auto time = std::chrono::system_clock::time_point(std::chrono::microseconds(1609556645678901LL));
+
+    ASSERT_EQ(TimestampFormatter(TimestampPrecision::Seconds, TimeZone::Utc).format(time), "2021-01-02 03:04:05");
+    ASSERT_EQ(TimestampFormatter(TimestampPrecision::Milliseconds, TimeZone::Utc).format(time), "2021-01-02 03:04:05.678");
+    ASSERT_EQ(TimestampFormatter(TimestampPrecision::Microseconds, TimeZone::Utc).format(time), "2021-01-02 03:04:05.678901");
+
+    // Same second, different fraction: the cached date must be reused with the new fraction
+    auto later = time + std::chrono::microseconds(300000);
+    ASSERT_EQ(TimestampFormatter(TimestampPrecision::Microseconds, TimeZone::Utc).format(later), "2021-01-02 03:04:05.978901");
+    auto nextSecond = time + std::chrono::microseconds(400000);
+    ASSERT_EQ(TimestampFormatter(TimestampPrecision::Milliseconds, TimeZone::Utc).format(nextSecond), "2021-01-02 03:04:06.078");
+}
+
+TEST(LoggerTest, TimestampFormatterMatchesPutTime)
+{
+    auto now = std::chrono::system_clock::now();
+    std::time_t now_c = std::chrono::system_clock::to_time_t(now);
+    std::tm calendar{};
+    localtime_r(&now_c, &calendar);
+    std::stringstream expected;
+    expected << std::put_time(&calendar, "%F %T");
+
+    ASSERT_EQ(TimestampFormatter().format(now), expected.str());
+}
+
+// Output strategy that keeps the records it receives, for inspecting the pipeline
+class CaptureOutput : public IOutputStrategy {
+public:
+    struct Captured {
+        LogLevel level;
+        std::string prefix;
+        std::string message;
+        const char* messageData;
+    };
+
+    explicit CaptureOutput(std::vector<Captured>& records) : records(records) {}
+
+    void output(const std::string& message) override {
+        records.push_back({LogLevel::Info, "", message, message.data()});
+    }
+
+    void write(const LogRecord& record) override {
+        records.push_back({record.level, std::string(record.prefix()), std::string(record.messageText(scratch)), record.message.data()});
+    }
+
+private:
+    std::vector<Captured>& records;
+    std::string scratch;
+};
+
+TEST(LoggerTest, LogRecordPrependOrder)
+{
+    LogRecord record(LogLevel::Warning, "message");
+    record.prepend("[inner] ");
+    record.prepend("[outer] ");
+    ASSERT_EQ(record.prefix(), "[outer] [inner] ");
+    ASSERT_EQ(record.str(), "[outer] [inner] message");
+
+    // Prefixes larger than the inline headroom still keep their order
+    std::string large(LogRecord::PrefixCapacity, 'x');
+    record.prepend(large);
+    ASSERT_EQ(record.str(), large + "[outer] [inner] message");
+}
+
+TEST(LoggerTest, DecoratorChainAnnotatesRecordInPlace)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> records;
+    std::unique_ptr<ILogger> logger = std::make_unique<LogLevelDecorator>(
+        std::make_unique<TimestampDecorator>(
+            std::make_unique<Logger>(std::make_unique<CaptureOutput>(records)), TimestampPrecision::Seconds, TimeZone::Utc));
+    std::string message = "Test message";
+
+    // Act
+    logger->log(LogLevel::Info, message);
+
+    // Assert
+    ASSERT_EQ(records.size(), 1u);
+    ASSERT_EQ(records[0].level, LogLevel::Info);
+    ASSERT_EQ(records[0].message, message);
+    ASSERT_EQ(records[0].messageData, message.data()); // The message reached the sink without being copied
+    ASSERT_EQ(records[0].prefix.size(), std::string("[YYYY-MM-DD HH:MM:SS] [3] ").size());
+    ASSERT_EQ(records[0].prefix.front(), '[');
+    ASSERT_EQ(records[0].prefix.substr(records[0].prefix.size() - 6), "] [3] ");
+}
+
+TEST(LoggerTest, CompileTimeLevelElimination)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> records;
+    std::unique_ptr<ILogger> logger = std::make_unique<Logger>(std::make_unique<CaptureOutput>(records));
+    int evaluations = 0;
+    auto expensive = [&evaluations](const char* text) {
+        ++evaluations;
+        return std::string(text);
+    };
+
+    // Act
+    CPPLOGGER_LOG_WITH_MIN(LogLevel::Info, logger, LogLevel::Debug, expensive("stripped"));
+    CPPLOGGER_LOG_WITH_MIN(LogLevel::Info, logger, LogLevel::Info, expensive("kept"));
+    CPPLOGGER_INFO(logger, expensive("default minimum keeps everything"));
+
+    // Assert
+    static_assert(!isLevelCompiledIn(LogLevel::Noise, LogLevel::Debug), "Noise must be stripped below Debug");
+    static_assert(isLevelCompiledIn(LogLevel::Fatal, LogLevel::Fatal), "Fatal is always kept");
+    ASSERT_EQ(evaluations, 2);
+    ASSERT_EQ(records.size(), 2u);
+    ASSERT_EQ(records[0].message, "kept");
+}
+
+// Formatting argument that counts how often it is rendered
+struct CountingArgument {
+    int& formatted;
+};
+
+std::ostream& operator<<(std::ostream& stream, const CountingArgument& argument)
+{
+    ++argument.formatted;
+    return stream << "counted";
+}
+
+TEST(LoggerTest, FormatMessagePlaceholders)
+{
+    std::string out;
+    formatMessage(out, "{} + {} = {}, {{literal}}, {1}, {}, missing {}", 1, 2.5, "three", std::string("four"));
+    ASSERT_EQ(out, "1 + 2.5 = three, {literal}, 2.5, four, missing {}");
+
+    out.clear();
+    formatMessage(out, "{} {} {}", true, 'c', -42L);
+    ASSERT_EQ(out, "true c -42");
+}
+
+TEST(LoggerTest, FormatMessageStopsCharArraysAtTheirBounds)
+{
+    // Arrange
+    char terminated[8] = "ab";
+    char unterminated[3] = {'x', 'y', 'z'};
+    std::string out;
+
+    // Act
+    formatMessage(out, "{}|{}|{}", terminated, unterminated, "lit");
+
+    // Assert
+    ASSERT_EQ(out, "ab|xyz|lit");
+}
+
+TEST(LoggerTest, LazyFormattingAfterFilter)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> records;
+    std::unique_ptr<ILogger> logger = std::make_unique<LevelFilterDecorator>(
+        std::make_unique<LogLevelDecorator>(std::make_unique<Logger>(std::make_unique<CaptureOutput>(records))), LogLevel::Warning);
+    int formatted = 0;
+
+    // Act
+    logger->log(LogLevel::Debug, "filtered {} {}", CountingArgument{formatted}, 1);
+    logger->log(LogLevel::Error, "kept {} {}", CountingArgument{formatted}, 2);
+    CPPLOGGER_ERROR(logger, "macro {}", 3);
+
+    // Assert
+    ASSERT_EQ(formatted, 1);
+    ASSERT_EQ(records.size(), 2u);
+    ASSERT_EQ(records[0].prefix + records[0].message, "[1] kept counted 2");
+    ASSERT_EQ(records[1].message, "macro 3");
+}
+
+TEST(LoggerTest, LazyFormattingIntoBufferedFile)
+{
+    // Arrange
+    std::string filename = "test_lazy.log";
+    std::ofstream file(filename);
+    file.close();
+
+    // Act
+    {
+        auto logger = LoggerFactory::createFileLoggerWithLevelFilter(filename, FlushPolicy());
+        logger->log(LogLevel::Info, "request {} took {} ms", 17, 3.25);
+    }
+
+    // Assert
+    ASSERT_EQ(readFile(filename), "request 17 took 3.25 ms\n");
+}
+
+TEST(LoggerTest, IsEnabledFollowsNestedFilter)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> records;
+    auto filter = std::make_unique<LevelFilterDecorator>(std::make_unique<Logger>(std::make_unique<CaptureOutput>(records)), LogLevel::Warning);
+    LevelFilterDecorator* innerFilter = filter.get();
+    std::unique_ptr<ILogger> logger = std::make_unique<TimestampDecorator>(std::make_unique<LogLevelDecorator>(std::move(filter)));
+
+    // Act & Assert
+    ASSERT_TRUE(logger->isEnabled(LogLevel::Warning));
+    ASSERT_FALSE(logger->isEnabled(LogLevel::Info));
+
+    innerFilter->setMinLevel(LogLevel::Debug);
+    ASSERT_TRUE(logger->isEnabled(LogLevel::Debug));
+    ASSERT_FALSE(logger->isEnabled(LogLevel::Noise));
+    ASSERT_EQ(innerFilter->getMinLevel(), LogLevel::Debug);
+
+    innerFilter->setMinLevel(LogLevel::Error);
+    logger->log(LogLevel::Warning, "filtered");
+    logger->log(LogLevel::Error, "kept");
+    ASSERT_EQ(records.size(), 1u);
+    ASSERT_EQ(records[0].message, "kept");
+}
+
+TEST(LoggerTest, SetMinLevelWhileLogging)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> records;
+    auto logger = std::make_unique<LevelFilterDecorator>(
+        std::make_unique<AsyncLogger>(std::make_unique<CaptureOutput>(records)), LogLevel::Error);
+    std::atomic<bool> done{false};
+
+    // Act
+    std::thread admin([&] {
+        for (int i = 0; i < 1000; ++i) {
+            logger->setMinLevel(i % 2 == 0 ? LogLevel::Noise : LogLevel::Fatal);
+        }
+        logger->setMinLevel(LogLevel::Error);
+        done = true;
+    });
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 2; ++t) {
+        producers.emplace_back([&] {
+            while (!done) {
+                logger->log(LogLevel::Debug, "maybe");
+                logger->log(LogLevel::Fatal, "always");
+            }
+        });
+    }
+    admin.join();
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    logger.reset();
+
+    // Assert
+    ASSERT_TRUE(std::all_of(records.begin(), records.end(), [](const CaptureOutput::Captured& record) {
+        return record.message == "maybe" || record.message == "always";
+    }));
+}
+
+static void removeSegments(const std::string& filename)
+{
+    for (int i = 0; i < 1000; ++i) {
+        std::remove((filename + "." + std::to_string(i)).c_str());
+    }
+}
+
+static std::string readSegments(const std::string& filename)
+{
+    std::string content;
+    for (int i = 0; std::ifstream(filename + "." + std::to_string(i)).good(); ++i) {
+        content += readFile(filename + "." + std::to_string(i));
+    }
+    return content;
+}
+
+TEST(LoggerTest, MmapFileOutputTruncatesOnClose)
+{
+    // Arrange
+    std::string filename = "test_mmap.log";
+    removeSegments(filename);
+
+    // Act
+    {
+        std::unique_ptr<ILogger> logger = std::make_unique<LogLevelDecorator>(
+            std::make_unique<Logger>(std::make_unique<MmapFileOutput>(filename, 4096)));
+        logger->log(LogLevel::Info, "first");
+        logger->log(LogLevel::Error, "second {}", 2);
+    }
+
+    // Assert
+    ASSERT_EQ(readFile(filename + ".0"), "[3] first\n[1] second 2\n");
+}
+
+TEST(LoggerTest, MmapFileOutputRollsSegments)
+{
+    // Arrange
+    std::string filename = "test_mmap_roll.log";
+    removeSegments(filename);
+    std::string expected;
+
+    // Act
+    {
+        auto output = std::make_unique<MmapFileOutput>(filename, 32);
+        MmapFileOutput* mmapOutput = output.get();
+        std::unique_ptr<ILogger> logger = std::make_unique<Logger>(std::move(output));
+        for (int i = 0; i < 20; ++i) {
+            std::string message = "message " + std::to_string(i);
+            logger->log(LogLevel::Info, message);
+            expected += message + "\n";
+        }
+        logger->log(LogLevel::Info, std::string(100, 'x')); // Larger than a segment
+        expected += std::string(100, 'x') + "\n";
+        ASSERT_NE(mmapOutput->currentSegmentPath(), filename + ".0");
+    }
+
+    // Assert
+    ASSERT_EQ(readSegments(filename), expected);
+}
+
+TEST(LoggerTest, MmapFileOutputConcurrentWriters)
+{
+    // Arrange
+    std::string filename = "test_mmap_threads.log";
+    removeSegments(filename);
+    const int threadCount = 4;
+    const int messagesPerThread = 2000;
+
+    // Act
+    {
+        std::unique_ptr<ILogger> logger = std::make_unique<Logger>(std::make_unique<MmapFileOutput>(filename, 4096));
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadCount; ++t) {
+            threads.emplace_back([&logger, t] {
+                for (int i = 0; i < messagesPerThread; ++i) {
+                    logger->log(LogLevel::Info, "thread {} message {}", t, i);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    // Assert
+    std::istringstream content(readSegments(filename));
+    std::string line;
+    int next[threadCount] = {};
+    while (std::getline(content, line)) {
+        int thread = 0;
+        int message = 0;
+        ASSERT_EQ(std::sscanf(line.c_str(), "thread %d message %d", &thread, &message), 2) << line;
+        ASSERT_EQ(message, next[thread]++); // Each thread's records stay in order
+    }
+    for (int t = 0; t < threadCount; ++t) {
+        ASSERT_EQ(next[t], messagesPerThread);
+    }
+}
+
+static void removeRotatedFiles(const std::string& filename)
+{
+    std::remove(filename.c_str());
+    for (int i = 1; i < 20; ++i) {
+        std::remove((filename + "." + std::to_string(i)).c_str());
+        std::remove((filename + "." + std::to_string(i) + ".gz").c_str());
+    }
+}
+
+static bool fileExists(const std::string& filename)
+{
+    return std::ifstream(filename).good();
+}
+
+TEST(LoggerTest, RotatingFileOutputKeepsEveryLineInOrder)
+{
+    // Arrange
+    std::string filename = "test_rotate.log";
+    removeRotatedFiles(filename);
+    RotationPolicy policy;
+    policy.maxFileSize = 40;
+    policy.maxFiles = 19;
+    std::string expected;
+
+    // Act
+    {
+        std::unique_ptr<ILogger> logger = std::make_unique<Logger>(std::make_unique<RotatingFileOutput>(filename, policy));
+        for (int i = 0; i < 30; ++i) {
+            logger->log(LogLevel::Info, "line {}", i);
+            expected += "line " + std::to_string(i) + "\n";
+        }
+    }
+
+    // Assert
+    ASSERT_TRUE(fileExists(filename + ".1"));
+    std::string content;
+    for (int i = 19; i >= 1; --i) {
+        if (fileExists(filename + "." + std::to_string(i))) {
+            content += readFile(filename + "." + std::to_string(i));
+        }
+    }
+    content += readFile(filename);
+    ASSERT_EQ(content, expected);
+}
+
+TEST(LoggerTest, RotatingFileOutputRetention)
+{
+    // Arrange
+    std::string filename = "test_rotate_retention.log";
+    removeRotatedFiles(filename);
+    RotationPolicy policy;
+    policy.maxFileSize = 10;
+    policy.maxFiles = 2;
+
+    // Act
+    {
+        RotatingFileOutput output(filename, policy);
+        for (int i = 0; i < 30; ++i) {
+            output.output("0123456789");
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    // Assert
+    ASSERT_TRUE(fileExists(filename));
+    ASSERT_TRUE(fileExists(filename + ".1"));
+    ASSERT_TRUE(fileExists(filename + ".2"));
+    ASSERT_FALSE(fileExists(filename + ".3"));
+}
+
+TEST(LoggerTest, RotatingFileOutputKeepsWritingWhenNextFileFailsToOpen)
+{
+    // Arrange
+    std::string filename = "test_rotate_open_failure.log";
+    removeRotatedFiles(filename);
+    RotationPolicy policy;
+    policy.maxFileSize = 10;
+    int opened = 0;
+    auto openFile = [&opened](const std::string& name) -> std::unique_ptr<IOutputStrategy> {
+        if (++opened == 2) {
+            throw std::runtime_error("Unable to open file"); // As FileOutput does on a full disk
+        }
+        return std::make_unique<FileOutput>(name);
+    };
+
+    // Act
+    {
+        RotatingFileOutput output(filename, policy, openFile);
+        for (const char* line : {"aaaaaaaaa", "bbbbbbbbb", "ccccccccc", "ddddddddd"}) {
+            output.output(line);
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    }
+
+    // Assert
+    auto read = [](const std::string& name) {
+        std::ifstream file(name);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    };
+    ASSERT_EQ(opened, 4);
+    ASSERT_EQ(read(filename + ".2"), "aaaaaaaaa\nbbbbbbbbb\nccccccccc\n"); // Retried at the next size limit
+    ASSERT_EQ(read(filename + ".1"), "ddddddddd\n");
+    ASSERT_EQ(read(filename), "");
+    ASSERT_FALSE(fileExists(filename + ".next"));
+    removeRotatedFiles(filename);
+}
+
+#if defined(CPPLOGGER_HAVE_ZLIB)
+TEST(LoggerTest, RotatingFileOutputCompressesRotatedFiles)
+{
+    // Arrange
+    std::string filename = "test_rotate_gzip.log";
+    removeRotatedFiles(filename);
+    RotationPolicy policy;
+    policy.maxFileSize = 20;
+    policy.maxFiles = 3;
+    policy.compression = RotationCompression::Gzip;
+
+    // Act
+    {
+        RotatingFileOutput output(filename, policy);
+        output.output("first rotated file");
+        output.output("second file");
+    }
+
+    // Assert
+    ASSERT_FALSE(fileExists(filename + ".1"));
+    gzFile compressed = gzopen((filename + ".1.gz").c_str(), "rb");
+    ASSERT_NE(compressed, nullptr);
+    char buffer[256];
+    int length = gzread(compressed, buffer, sizeof(buffer));
+    gzclose(compressed);
+    ASSERT_EQ(std::string(buffer, length > 0 ? length : 0).rfind("first rotated file\n", 0), 0u);
+}
+#endif
+
+static int openLoopbackSocket(int type, int& port)
+{
+    int fd = ::socket(AF_INET, type, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    ::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    socklen_t length = sizeof(address);
+    ::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length);
+    port = ntohs(address.sin_port);
+    return fd;
+}
+
+static std::string receiveWithTimeout(int fd, int timeoutMs)
+{
+    pollfd descriptor{fd, POLLIN, 0};
+    if (::poll(&descriptor, 1, timeoutMs) <= 0) {
+        return std::string();
+    }
+    char buffer[1024];
+    ssize_t length = ::recv(fd, buffer, sizeof(buffer), 0);
+    return std::string(buffer, length > 0 ? length : 0);
+}
+
+TEST(LoggerTest, NetworkOutputSendsSyslogDatagrams)
+{
+    // Arrange
+    int port = 0;
+    int receiver = openLoopbackSocket(SOCK_DGRAM, port);
+    NetworkOutput output("syslog://127.0.0.1:" + std::to_string(port));
+
+    // Act
+    LogRecord error(LogLevel::Error, "disk failure");
+    output.write(error);
+    std::string first = receiveWithTimeout(receiver, 2000);
+    output.output("plain message");
+    std::string second = receiveWithTimeout(receiver, 2000);
+    ::close(receiver);
+
+    // Assert
+    ASSERT_EQ(first, "<11>disk failure");
+    ASSERT_EQ(second, "<14>plain message");
+}
+
+TEST(LoggerTest, NetworkOutputFramesTcpRecords)
+{
+    // Arrange
+    int port = 0;
+    int listener = openLoopbackSocket(SOCK_STREAM, port);
+    ::listen(listener, 1);
+    std::string received;
+
+    // Act
+    {
+        NetworkOutput output("syslog+tcp://127.0.0.1:" + std::to_string(port));
+        output.write(LogRecord(LogLevel::Warning, "first"));
+        output.write(LogRecord(LogLevel::Debug, "second"));
+        pollfd descriptor{listener, POLLIN, 0};
+        ASSERT_GT(::poll(&descriptor, 1, 2000), 0);
+        int connection = ::accept(listener, nullptr, nullptr);
+        while (received.size() < std::string("<12>first\n<15>second\n").size()) {
+            std::string chunk = receiveWithTimeout(connection, 2000);
+            if (chunk.empty()) {
+                break;
+            }
+            received += chunk;
+        }
+        ::close(connection);
+    }
+    ::close(listener);
+
+    // Assert
+    ASSERT_EQ(received, "<12>first\n<15>second\n");
+}
+
+TEST(LoggerTest, NetworkOutputDropsWhenCollectorIsDown)
+{
+    // Arrange
+    int port = 0;
+    int unused = openLoopbackSocket(SOCK_STREAM, port);
+    ::close(unused); // Nothing listens on the port, so every connect attempt is refused
+    NetworkOptions options;
+    options.queueCapacity = 16;
+    options.overflowPolicy = OverflowPolicy::DropNewest;
+    options.shutdownTimeout = std::chrono::milliseconds(50);
+    auto started = std::chrono::steady_clock::now();
+
+    // Act
+    std::size_t dropped = 0;
+    {
+        NetworkOutput output("tcp://127.0.0.1:" + std::to_string(port), options);
+        for (int i = 0; i < 10000; ++i) {
+            output.output("message");
+        }
+        dropped = output.droppedCount();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - started;
+
+    // Assert
+    ASSERT_GT(dropped, 0u);
+    ASSERT_LT(elapsed, std::chrono::seconds(2));
+}
+
+TEST(LoggerTest, NetworkServiceRejectsInvalidUrls)
+{
+    ASSERT_THROW(NetworkService("localhost:514"), std::invalid_argument);
+    ASSERT_THROW(NetworkService("http://localhost"), std::invalid_argument);
+    ASSERT_THROW(NetworkService("syslog://[::1:514"), std::invalid_argument);
+}
+
+TEST(LoggerTest, BinaryLoggerRoundTripsThroughDecoder)
+{
+    // Arrange
+    std::string filename = "test_binary.bin";
+    std::remove(filename.c_str());
+    int value = 42;
+
+    // Act
+    {
+        BinaryLogger logger(filename);
+        CPPLOGGER_BINARY_LOG(logger, LogLevel::Error, "value {} of {} is {}", value, std::string("limit"), 1.5);
+        CPPLOGGER_BINARY_LOG(logger, LogLevel::Info, "flags {} {} {{literal}}", true, 'x');
+        CPPLOGGER_BINARY_LOG(logger, LogLevel::Warning, "no arguments");
+        logger.log(LogLevel::Debug, "text record {}", -7);
+    }
+    std::string text;
+    BinaryDecodeOptions options;
+    options.showTimestamp = false;
+    std::size_t records = BinaryLogDecoder(options).decode(readFile(filename), text);
+
+    // Assert
+    ASSERT_EQ(records, 4u);
+    ASSERT_EQ(text,
+              "[1] value 42 of limit is 1.5\n"
+              "[3] flags true x {literal}\n"
+              "[2] no arguments\n"
+              "[4] text record -7\n");
+}
+
+TEST(LoggerTest, BinaryLoggerEncodesNullAndUnterminatedStrings)
+{
+    // Arrange
+    std::string filename = "test_binary_strings.bin";
+    std::remove(filename.c_str());
+    char* missing = nullptr;
+    char unterminated[3] = {'x', 'y', 'z'};
+    char terminated[8] = "ab";
+
+    // Act
+    {
+        BinaryLogger logger(filename);
+        CPPLOGGER_BINARY_LOG(logger, LogLevel::Info, "{}|{}|{}", missing, unterminated, terminated);
+    }
+    std::string text;
+    BinaryDecodeOptions options;
+    options.showTimestamp = false;
+    BinaryLogDecoder(options).decode(readFile(filename), text);
+
+    // Assert
+    ASSERT_EQ(text, "[3] (null)|xyz|ab\n");
+    std::remove(filename.c_str());
+}
+
+TEST(LoggerTest, BinaryDecoderMatchesTextDecorators)
+{
+    // Arrange
+    std::string filename = "test_binary_decorated.bin";
+    std::remove(filename.c_str());
+    std::vector<CaptureOutput::Captured> captured;
+    TimestampDecorator textLogger(std::make_unique<LogLevelDecorator>(std::make_unique<Logger>(std::make_unique<CaptureOutput>(captured))));
+
+    // Act
+    {
+        BinaryLogger logger(filename);
+        CPPLOGGER_BINARY_LOG(logger, LogLevel::Info, "request {} took {} ms", 17u, 3);
+    }
+    textLogger.log(LogLevel::Info, "request {} took {} ms", 17u, 3);
+    std::string text;
+    BinaryLogDecoder().decode(readFile(filename), text);
+
+    // Assert: same layout, the timestamps may differ by a second
+    std::string expected = captured[0].prefix + captured[0].message + "\n";
+    ASSERT_EQ(text.size(), expected.size());
+    ASSERT_EQ(text.substr(0, 5), expected.substr(0, 5));
+    ASSERT_EQ(text.substr(text.find(']', 4)), expected.substr(expected.find(']', 4)));
+}
+
+TEST(LoggerTest, BinaryLoggerKeepsPerThreadOrderAcrossSessions)
+{
+    // Arrange
+    std::string filename = "test_binary_threads.bin";
+    std::remove(filename.c_str());
+    const int threadCount = 4;
+    const int perThread = 2000;
+    BinaryLogOptions options;
+    options.bufferSize = 1024;
+
+    // Act
+    for (int session = 0; session < 2; ++session) {
+        BinaryLogger logger(filename, options);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadCount; ++t) {
+            threads.emplace_back([&logger, t] {
+                for (int i = 0; i < perThread; ++i) {
+                    CPPLOGGER_BINARY_LOG(logger, LogLevel::Info, "{} {}", t, i);
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+    std::string text;
+    BinaryDecodeOptions decodeOptions;
+    decodeOptions.showLevel = false;
+    decodeOptions.showTimestamp = false;
+    std::size_t records = BinaryLogDecoder(decodeOptions).decode(readFile(filename), text);
+
+    // Assert
+    ASSERT_EQ(records, 2u * threadCount * perThread);
+    std::vector<int> next(threadCount, 0);
+    std::istringstream lines(text);
+    int thread = 0;
+    int index = 0;
+    while (lines >> thread >> index) {
+        ASSERT_EQ(index, next[thread] % perThread);
+        ++next[thread];
+    }
+    for (int count : next) {
+        ASSERT_EQ(count, 2 * perThread);
+    }
+}
+
+class SlowOutput : public IOutputStrategy {
+public:
+    explicit SlowOutput(std::atomic<int>& written) : written(written) {}
+
+    void output(const std::string&) override {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        written.fetch_add(1);
+    }
+
+private:
+    std::atomic<int>& written;
+};
+
+TEST(LoggerTest, FanOutOutputSharesSerializedRecord)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> first;
+    std::vector<CaptureOutput::Captured> second;
+    std::vector<SinkConfig> sinks;
+    sinks.push_back(SinkConfig{std::make_unique<CaptureOutput>(first)});
+    sinks.push_back(SinkConfig{std::make_unique<CaptureOutput>(second)});
+    FanOutOutput output(std::move(sinks));
+
+    // Act
+    LogRecord record(LogLevel::Warning, "shared");
+    record.prepend("[2] ");
+    output.write(record);
+    output.waitDrained();
+
+    // Assert
+    ASSERT_EQ(first.size(), 1u);
+    ASSERT_EQ(second.size(), 1u);
+    ASSERT_EQ(first[0].level, LogLevel::Warning);
+    ASSERT_EQ(first[0].prefix, "[2] ");
+    ASSERT_EQ(first[0].message, "shared");
+    ASSERT_EQ(first[0].messageData, second[0].messageData);
+}
+
+TEST(LoggerTest, FanOutOutputIsolatesSlowSink)
+{
+    // Arrange
+    std::atomic<int> slowWritten{0};
+    std::vector<CaptureOutput::Captured> fast;
+    std::vector<SinkConfig> sinks;
+    sinks.push_back(SinkConfig{std::make_unique<CaptureOutput>(fast), OverflowPolicy::Block});
+    sinks.push_back(SinkConfig{std::make_unique<SlowOutput>(slowWritten), OverflowPolicy::DropNewest, 4});
+    auto started = std::chrono::steady_clock::now();
+
+    // Act
+    std::size_t dropped = 0;
+    {
+        FanOutOutput output(std::move(sinks));
+        for (int i = 0; i < 200; ++i) {
+            output.write(LogRecord(LogLevel::Info, "message"));
+        }
+        auto loggingTime = std::chrono::steady_clock::now() - started;
+        ASSERT_LT(loggingTime, std::chrono::milliseconds(500));
+        dropped = output.droppedCount(1);
+        ASSERT_EQ(output.droppedCount(0), 0u);
+    }
+
+    // Assert
+    ASSERT_EQ(fast.size(), 200u);
+    ASSERT_GT(dropped, 0u);
+    ASSERT_EQ(slowWritten.load() + static_cast<int>(dropped), 200);
+}
+
+TEST(LoggerTest, ShardedLoggerKeepsPerThreadOrder)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> captured;
+    const int threadCount = 8;
+    const int perThread = 5000;
+    ShardedLoggerOptions options;
+    options.shardCapacity = 4096;
+
+    // Act
+    {
+        ShardedLogger logger(std::make_unique<CaptureOutput>(captured), options);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadCount; ++t) {
+            threads.emplace_back([&logger, t] {
+                for (int i = 0; i < perThread; ++i) {
+                    logger.log(LogLevel::Info, "{} {}", t, i);
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+    // Assert
+    ASSERT_EQ(captured.size(), static_cast<std::size_t>(threadCount * perThread));
+    std::vector<int> next(threadCount, 0);
+    for (const auto& record : captured) {
+        std::istringstream fields(record.message);
+        int thread = 0;
+        int index = 0;
+        fields >> thread >> index;
+        ASSERT_EQ(index, next[thread]++);
+    }
+}
+
+TEST(LoggerTest, ShardedLoggerMergesByTimestamp)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> captured;
+    ShardedLoggerOptions options;
+    options.order = MergeOrder::Timestamp;
+    options.mergeInterval = std::chrono::milliseconds(10000);
+    ShardedLogger logger(std::make_unique<CaptureOutput>(captured), options);
+    auto base = std::chrono::system_clock::now();
+
+    // Act: two threads log interleaved timestamps
+    auto producer = [&logger, base](int first) {
+        for (int i = first; i < 10; i += 2) {
+            std::string message = std::to_string(i);
+            LogRecord record(LogLevel::Info, message);
+            record.time = base + std::chrono::milliseconds(i);
+            logger.logRecord(record);
+        }
+    };
+    std::thread odd(producer, 1);
+    std::thread even(producer, 0);
+    odd.join();
+    even.join();
+    logger.flush();
+
+    // Assert
+    ASSERT_EQ(captured.size(), 10u);
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(captured[i].message, std::to_string(i));
+    }
+}
+
+TEST(LoggerTest, TelemetryCountsRecordsBytesAndLatency)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> captured;
+    Logger logger(std::make_unique<CaptureOutput>(captured));
+
+    // Act
+    logger.log(LogLevel::Info, "12345");
+    logger.log(LogLevel::Error, "123");
+    TelemetrySnapshot stats = logger.stats();
+
+    // Assert
+    ASSERT_EQ(stats.recordsIn, 2u);
+    ASSERT_EQ(stats.recordBytes, 10u); // Each record counts its newline
+    ASSERT_EQ(stats.writeLatency.count, 1u); // Only the first of every LatencySampleInterval writes is timed
+    std::vector<std::string> names;
+    stats.forEachMetric([&names](std::string_view name, std::uint64_t) { names.emplace_back(name); });
+    ASSERT_EQ(names.front(), "records_in");
+    ASSERT_NE(std::find(names.begin(), names.end(), "write_latency_p99_ns"), names.end());
+}
+
+TEST(LoggerTest, LevelFilterCountsFilteredRecords)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> captured;
+    auto filter = std::make_unique<LevelFilterDecorator>(std::make_unique<Logger>(std::make_unique<CaptureOutput>(captured)), LogLevel::Warning);
+    LevelFilterDecorator* filterPointer = filter.get();
+    TimestampDecorator logger(std::move(filter));
+
+    // Act
+    logger.log(LogLevel::Info, "rejected by the cached level of the outer decorator");
+    logger.log(LogLevel::Debug, "rejected {}", 2);
+    logger.log(LogLevel::Error, "passes");
+    LogRecord record(LogLevel::Noise, "rejected by the filter itself");
+    filterPointer->logRecord(record);
+
+    // Assert
+    ASSERT_EQ(captured.size(), 1u);
+    ASSERT_EQ(filterPointer->filteredCount(), 3u);
+}
+
+TEST(LoggerTest, LatencyHistogramReportsPercentileBuckets)
+{
+    // Arrange
+    LatencyHistogram histogram;
+
+    // Act
+    for (int i = 0; i < 990; ++i) {
+        histogram.record(std::chrono::nanoseconds(100));
+    }
+    for (int i = 0; i < 10; ++i) {
+        histogram.record(std::chrono::microseconds(50));
+    }
+    LatencyHistogram::Snapshot snapshot = histogram.snapshot();
+
+    // Assert
+    ASSERT_EQ(snapshot.count, 1000u);
+    ASSERT_EQ(snapshot.percentile(0.5), 128u);
+    ASSERT_EQ(snapshot.percentile(0.99), 128u);
+    ASSERT_EQ(snapshot.percentile(0.999), 65536u);
+}
+
+TEST(LoggerTest, FanOutOutputReportsSinkTelemetry)
+{
+    // Arrange
+    std::atomic<int> slowWritten{0};
+    std::vector<CaptureOutput::Captured> fast;
+    std::vector<SinkConfig> sinks;
+    sinks.push_back(SinkConfig{std::make_unique<CaptureOutput>(fast)});
+    sinks.push_back(SinkConfig{std::make_unique<SlowOutput>(slowWritten), OverflowPolicy::DropNewest, 2});
+    FanOutOutput output(std::move(sinks));
+
+    // Act
+    for (int i = 0; i < 20; ++i) {
+        output.measuredWrite(LogRecord(LogLevel::Info, "message"));
+    }
+    output.waitDrained();
+    TelemetrySnapshot total = output.stats();
+    TelemetrySnapshot fastStats = output.sinkStats(0);
+    TelemetrySnapshot slowStats = output.sinkStats(1);
+
+    // Assert
+    ASSERT_EQ(total.recordsIn, 20u);
+    ASSERT_EQ(fastStats.recordsIn, 20u);
+    ASSERT_EQ(fastStats.recordsDropped, 0u);
+    ASSERT_GT(slowStats.recordsDropped, 0u);
+    ASSERT_EQ(slowStats.recordsIn + slowStats.recordsDropped, 20u);
+    ASSERT_EQ(total.recordsDropped, slowStats.recordsDropped);
+}
+
+TEST(LoggerTest, RateLimitDecoratorSuppressesFloodAndSummarizes)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> captured;
+    RateLimitPolicy policy;
+    policy.key = RateLimitKey::Level;
+    policy.recordsPerSecond = 1;
+    policy.burst = 5;
+    std::uint64_t suppressed = 0;
+
+    // Act
+    {
+        RateLimitDecorator logger(std::make_unique<Logger>(std::make_unique<CaptureOutput>(captured)), policy);
+        for (int i = 0; i < 100; ++i) {
+            logger.log(LogLevel::Warning, "disk almost full");
+        }
+        logger.log(LogLevel::Fatal, "never limited");
+        suppressed = logger.suppressedCount();
+    }
+
+    // Assert
+    ASSERT_EQ(captured.size(), 100 - suppressed + 2);
+    ASSERT_GE(suppressed, 90u);
+    ASSERT_EQ(captured[captured.size() - 2].message, "never limited");
+    ASSERT_EQ(captured.back().message, "suppressed " + std::to_string(suppressed) + " messages at level 2");
+}
+
+TEST(LoggerTest, RateLimitDecoratorKeepsCallSitesApart)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> captured;
+    RateLimitPolicy policy;
+    policy.recordsPerSecond = 1;
+    policy.burst = 2;
+    policy.summaryInterval = std::chrono::milliseconds(60000);
+    RateLimitDecorator logger(std::make_unique<Logger>(std::make_unique<CaptureOutput>(captured)), policy);
+
+    // Act
+    for (int i = 0; i < 50; ++i) {
+        logger.log(LogLevel::Warning, "flooding call site {}", i);
+    }
+    logger.log(LogLevel::Warning, "quiet call site {}", 0);
+
+    // Assert
+    ASSERT_EQ(captured.size(), 3u);
+    ASSERT_EQ(captured.back().message, "quiet call site 0");
+    ASSERT_EQ(logger.suppressedCount(), 48u);
+}
+
+TEST(LoggerTest, RateLimitDecoratorKeysPlainMessagesByMacroCallSite)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> captured;
+    RateLimitPolicy policy;
+    policy.recordsPerSecond = 1;
+    policy.burst = 2;
+    policy.summaryInterval = std::chrono::milliseconds(60000);
+    RateLimitDecorator logger(std::make_unique<Logger>(std::make_unique<CaptureOutput>(captured)), policy);
+
+    // Act
+    for (int i = 0; i < 50; ++i) {
+        std::string message = "flooding request " + std::to_string(i) + std::string(40, '.'); // Heap allocated
+        CPPLOGGER_WARNING(logger, message);
+    }
+    std::string quiet = "quiet";
+    CPPLOGGER_WARNING(logger, quiet);
+    logger.log(LogLevel::Warning, std::string("no call site")); // Keyed by level, which is not flooded
+
+    // Assert
+    ASSERT_EQ(captured.size(), 4u);
+    ASSERT_EQ(captured[2].message, "quiet");
+    ASSERT_EQ(captured[3].message, "no call site");
+    ASSERT_EQ(logger.suppressedCount(), 48u);
+}
+
+TEST(LoggerTest, RateLimitDecoratorSummaryNamesFloodingCallSite)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> captured;
+    RateLimitPolicy policy;
+    policy.recordsPerSecond = 1;
+    policy.burst = 2;
+    policy.summaryInterval = std::chrono::milliseconds(60000);
+
+    // Act
+    {
+        RateLimitDecorator logger(std::make_unique<Logger>(std::make_unique<CaptureOutput>(captured)), policy);
+        for (int i = 0; i < 10; ++i) {
+            CPPLOGGER_WARNING(logger, "flooding request " + std::to_string(i));
+        }
+        for (int i = 0; i < 3; ++i) {
+            logger.log(LogLevel::Warning, std::string("no call site")); // Keyed by level, in a bucket of its own
+        }
+    }
+
+    // Assert
+    std::vector<std::string> messages;
+    for (const auto& record : captured) {
+        messages.push_back(record.message);
+    }
+    ASSERT_EQ(messages.size(), 6u);
+    ASSERT_NE(std::find(messages.begin(), messages.end(), "suppressed 8 messages like \"flooding request 2\""), messages.end());
+    ASSERT_NE(std::find(messages.begin(), messages.end(), "suppressed 1 message at level 2"), messages.end());
+}
+
+TEST(LoggerTest, RateLimitDecoratorSamplesVerboseLevels)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> captured;
+    RateLimitPolicy policy;
+    policy.recordsPerSecond = 1e9;
+    policy.burst = 1000000;
+    policy.sampleEvery = 10;
+    RateLimitDecorator logger(std::make_unique<Logger>(std::make_unique<CaptureOutput>(captured)), policy);
+
+    // Act
+    for (int i = 0; i < 10000; ++i) {
+        logger.log(LogLevel::Debug, "sampled");
+    }
+    for (int i = 0; i < 100; ++i) {
+        logger.log(LogLevel::Info, "kept");
+    }
+
+    // Assert
+    std::size_t debugRecords = captured.size() - 100;
+    ASSERT_GT(debugRecords, 500u);
+    ASSERT_LT(debugRecords, 1500u);
+    ASSERT_EQ(logger.sampledOutCount(), 10000u - debugRecords);
+}
+
+TEST(LoggerTest, DuplicateSuppressionCollapsesRepeats)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> captured;
+    std::uint64_t suppressed = 0;
+
+    // Act
+    {
+        DuplicateSuppressionDecorator logger(std::make_unique<Logger>(std::make_unique<CaptureOutput>(captured)));
+        for (int i = 0; i < 5; ++i) {
+            logger.log(LogLevel::Error, "connection refused");
+        }
+        logger.log(LogLevel::Warning, "connection refused"); // A different level starts its own run
+        logger.log(LogLevel::Error, "retry {}", 3);
+        logger.log(LogLevel::Error, "retry {}", 3);
+        suppressed = logger.suppressedCount();
+    }
+
+    // Assert
+    ASSERT_EQ(suppressed, 5u);
+    std::vector<std::string> messages;
+    for (const auto& record : captured) {
+        messages.push_back(record.message);
+    }
+    ASSERT_NE(std::find(messages.begin(), messages.end(), "message repeated 4 times: \"connection refused\""), messages.end());
+    ASSERT_NE(std::find(messages.begin(), messages.end(), "message repeated 1 time: \"retry 3\""), messages.end());
+    ASSERT_EQ(std::count(messages.begin(), messages.end(), "connection refused"), 2);
+    ASSERT_EQ(std::count(messages.begin(), messages.end(), "retry 3"), 1);
+    ASSERT_EQ(captured.size(), 5u);
+}
+
+TEST(LoggerTest, DuplicateSuppressionNamesMessageOfInterleavedRuns)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> captured;
+
+    // Act
+    {
+        DuplicateSuppressionDecorator logger(std::make_unique<Logger>(std::make_unique<CaptureOutput>(captured)));
+        logger.log(LogLevel::Error, "connection refused");
+        logger.log(LogLevel::Error, "connection refused");
+        logger.log(LogLevel::Error, "disk full");
+        logger.log(LogLevel::Error, "disk full");
+        logger.log(LogLevel::Error, "connection refused"); // Still the run that started first
+    }
+
+    // Assert
+    std::vector<std::string> messages;
+    for (const auto& record : captured) {
+        messages.push_back(record.message);
+    }
+    ASSERT_EQ(messages.size(), 4u);
+    ASSERT_EQ(messages[0], "connection refused");
+    ASSERT_EQ(messages[1], "disk full");
+    ASSERT_NE(std::find(messages.begin(), messages.end(), "message repeated 2 times: \"connection refused\""), messages.end());
+    ASSERT_NE(std::find(messages.begin(), messages.end(), "message repeated 1 time: \"disk full\""), messages.end());
+}
+
+TEST(LoggerTest, DuplicateSuppressionReportsHeldRunsAfterMaxHold)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> captured;
+    DuplicateSuppressionPolicy policy;
+    policy.maxHold = std::chrono::milliseconds(20);
+    std::uint64_t suppressed = 0;
+
+    // Act
+    {
+        DuplicateSuppressionDecorator logger(std::make_unique<Logger>(std::make_unique<CaptureOutput>(captured)), policy);
+        logger.log(LogLevel::Info, "polling");
+        logger.log(LogLevel::Info, "polling");
+        logger.log(LogLevel::Info, "polling");
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        logger.log(LogLevel::Info, "polling"); // Starts counting a new run of the same message
+        suppressed = logger.suppressedCount();
+    } // The timer thread has stopped; captured is ours again
+
+    // Assert
+    ASSERT_EQ(suppressed, 3u);
+    ASSERT_EQ(captured.size(), 3u);
+    ASSERT_EQ(captured[1].message, "message repeated 2 times: \"polling\"");
+    ASSERT_EQ(captured[1].level, LogLevel::Info);
+    ASSERT_EQ(captured[2].message, "message repeated 1 time: \"polling\""); // Reported on destruction
+}
+
+TEST(LoggerTest, DuplicateSuppressionCountsConcurrentRepeats)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> captured;
+    std::uint64_t suppressed = 0;
+
+    // Act
+    {
+        DuplicateSuppressionDecorator logger(std::make_unique<Logger>(std::make_unique<CaptureOutput>(captured)));
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&logger] {
+                for (int i = 0; i < 1000; ++i) {
+                    logger.log(LogLevel::Error, "connection refused");
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        suppressed = logger.suppressedCount();
+    }
+
+    // Assert
+    ASSERT_EQ(suppressed, 3999u);
+    ASSERT_EQ(captured.size(), 2u);
+    ASSERT_EQ(captured[1].message, "message repeated 3999 times: \"connection refused\"");
+}
+
+TEST(LoggerTest, PipelineMatchesDecoratorChain)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> fromChain;
+    std::vector<CaptureOutput::Captured> fromPipeline;
+    LogLevelDecorator chain(std::make_unique<LevelFilterDecorator>(std::make_unique<Logger>(std::make_unique<CaptureOutput>(fromChain)), LogLevel::Warning));
+    Pipeline<LevelStage, FilterStage, CaptureOutput> pipeline(fromPipeline);
+    pipeline.stage<FilterStage>().setMinLevel(LogLevel::Warning);
+
+    // Act
+    chain.log(LogLevel::Info, "filtered");
+    chain.log(LogLevel::Error, "kept {}", 1);
+    pipeline.log(LogLevel::Info, "filtered");
+    pipeline.log(LogLevel::Error, "kept {}", 1);
+    CPPLOGGER_WARNING(pipeline, "macro {}", 2);
+
+    // Assert
+    ASSERT_FALSE(pipeline.isEnabled(LogLevel::Info));
+    ASSERT_EQ(fromPipeline.size(), 2u);
+    ASSERT_EQ(fromPipeline[0].prefix + fromPipeline[0].message, fromChain[0].prefix + fromChain[0].message);
+    ASSERT_EQ(fromPipeline[1].prefix + fromPipeline[1].message, "[2] macro 2");
+    ASSERT_EQ(pipeline.stats().recordsIn, 2u);
+}
+
+TEST(LoggerTest, PipelineLoggerErasesPipelineType)
+{
+    // Arrange
+    std::string filename = "test_pipeline.log";
+    std::remove(filename.c_str());
+    auto pipeline = LoggerFactory::createFilePipelineWithLevelFilter(filename);
+    auto logger = std::make_unique<PipelineLogger<FilePipelineWithLevelFilter>>(std::move(pipeline));
+    PipelineLogger<FilePipelineWithLevelFilter>* erased = logger.get();
+    TimestampDecorator decorated(std::move(logger));
+
+    // Act
+    decorated.log(LogLevel::Debug, "filtered");
+    erased->configure([](FilePipelineWithLevelFilter& fused) { fused.stage<FilterStage>().setMinLevel(LogLevel::Debug); });
+    decorated.log(LogLevel::Debug, "now logged");
+
+    // Assert
+    ASSERT_TRUE(decorated.isEnabled(LogLevel::Debug));
+    std::string content = readFile(filename);
+    ASSERT_EQ(content.find("filtered"), std::string::npos);
+    ASSERT_NE(content.find("] now logged\n"), std::string::npos);
+}
+
+TEST(LoggerTest, JsonOutputWritesFieldsAsKeys)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> captured;
+    JsonOutput output(std::make_unique<CaptureOutput>(captured));
+    std::string user = "ada \"lovelace\"";
+    LogField fields[] = {{"user", user}, {"attempt", -3}, {"bytes", 4096u}, {"ratio", 0.5}, {"ok", true}};
+    LogRecord record(LogLevel::Warning, "login\tfailed\n");
+    record.time = std::chrono::system_clock::time_point(std::chrono::seconds(1700000000) + std::chrono::microseconds(123456));
+    record.fields = LogFields{fields, 5};
+
+    // Act
+    output.write(record);
+
+    // Assert
+    ASSERT_EQ(captured.size(), 1u);
+    EXPECT_EQ(captured[0].level, LogLevel::Warning);
+    EXPECT_EQ(captured[0].message,
+              "{\"time\":\"2023-11-14T22:13:20.123456Z\",\"level\":\"warning\",\"message\":\"login\\tfailed\\n\","
+              "\"user\":\"ada \\\"lovelace\\\"\",\"attempt\":-3,\"bytes\":4096,\"ratio\":0.5,\"ok\":true}");
+}
+
+TEST(LoggerTest, LogFieldCopiesCharValues)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> captured;
+    JsonOutput output(std::make_unique<CaptureOutput>(captured));
+    LogField fields[] = {LogField("grade", 'A'), LogField("quote", '"')}; // The characters are temporaries
+    LogRecord record(LogLevel::Info, "graded");
+    record.time = std::chrono::system_clock::time_point(std::chrono::seconds(1700000000));
+    record.fields = LogFields{fields, 2};
+
+    // Act
+    output.write(record);
+
+    // Assert
+    EXPECT_EQ(fields[0].type, LogField::Type::Char);
+    EXPECT_EQ(fields[0].charValue, 'A');
+    ASSERT_EQ(captured.size(), 1u);
+    EXPECT_NE(captured[0].message.find("\"grade\":\"A\",\"quote\":\"\\\"\"}"), std::string::npos);
+}
+
+TEST(LoggerTest, JsonEscapingMatchesScalarReference)
+{
+    // Arrange
+    auto reference = [](std::string_view text) {
+        std::string out;
+        for (char c : text) {
+            switch (c) {
+                case '"': out.append("\\\""); break;
+                case '\\': out.append("\\\\"); break;
+                case '\b': out.append("\\b"); break;
+                case '\f': out.append("\\f"); break;
+                case '\n': out.append("\\n"); break;
+                case '\r': out.append("\\r"); break;
+                case '\t': out.append("\\t"); break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char escape[8];
+                        std::snprintf(escape, sizeof(escape), "\\u%04x", c);
+                        out.append(escape);
+                    } else {
+                        out.push_back(c);
+                    }
+            }
+        }
+        return out;
+    };
+    const char specials[] = {'"', '\\', '\n', '\x01', '\x1f', '\t'};
+
+    // Act & Assert
+    for (std::size_t length : {0u, 15u, 16u, 31u, 32u, 33u, 70u}) {
+        for (std::size_t position = 0; position < length; ++position) {
+            for (char special : specials) {
+                std::string text(length, 'a');
+                text[position] = special;
+                text[length - 1 - position] = static_cast<char>(0xC3); // Non-ASCII bytes pass through
+                std::string escaped;
+                json_encoding::appendEscaped(escaped, text);
+                ASSERT_EQ(escaped, reference(text)) << "length " << length << " position " << position;
+            }
+        }
+    }
+}
+
+TEST(LoggerTest, AsyncLoggerKeepsFieldsAndPrefix)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> captured;
+    auto async = std::make_unique<AsyncLogger>(std::make_unique<JsonOutput>(std::make_unique<CaptureOutput>(captured)));
+    AsyncLogger* queue = async.get();
+    LogLevelDecorator logger(std::move(async));
+
+    // Act
+    {
+        std::string request = "GET /index.html";
+        logger.log(LogLevel::Info, "served", {{"request", request}, {"status", 200}});
+    }
+    queue->flush();
+
+    // Assert
+    ASSERT_EQ(captured.size(), 1u);
+    const std::string& line = captured[0].message;
+    EXPECT_NE(line.find("\"prefix\":\"[3] \",\"message\":\"served\",\"request\":\"GET /index.html\",\"status\":200}"), std::string::npos) << line;
+}
+
+TEST(LoggerTest, ContextDecoratorPrependsScopedPrefix)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> captured;
+    ContextDecorator logger(std::make_unique<LogLevelDecorator>(std::make_unique<Logger>(std::make_unique<CaptureOutput>(captured))));
+
+    // Act
+    const char* cachedPrefix = nullptr;
+    {
+        auto request = LogContext::push("request", 42);
+        {
+            auto shard = LogContext::push("shard", "eu-1");
+            logger.log(LogLevel::Info, "first");
+            cachedPrefix = LogContext::prefix().data();
+            logger.log(LogLevel::Info, "second");
+            EXPECT_EQ(LogContext::prefix().data(), cachedPrefix);
+        }
+        logger.log(LogLevel::Warning, "third");
+    }
+    logger.log(LogLevel::Info, "fourth");
+
+    // Assert
+    ASSERT_EQ(captured.size(), 4u);
+    EXPECT_EQ(captured[0].prefix, "[3] [request=42 shard=eu-1] ");
+    EXPECT_EQ(captured[1].prefix, "[3] [request=42 shard=eu-1] ");
+    EXPECT_EQ(captured[2].prefix, "[2] [request=42] ");
+    EXPECT_EQ(captured[3].prefix, "[3] ");
+    EXPECT_EQ(LogContext::size(), 0u);
+}
+
+TEST(LoggerTest, ContextDecoratorAddsFieldsPerThread)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> captured;
+    ContextDecorator logger(std::make_unique<Logger>(std::make_unique<JsonOutput>(std::make_unique<CaptureOutput>(captured))),
+                            ContextPlacement::Fields);
+    auto request = LogContext::push("request", "abc");
+
+    // Act
+    logger.log(LogLevel::Info, "with fields", {{"status", 200}});
+    std::thread other([&logger] { logger.log(LogLevel::Info, "other thread"); });
+    other.join();
+
+    // Assert
+    ASSERT_EQ(captured.size(), 2u);
+    EXPECT_NE(captured[0].message.find("\"message\":\"with fields\",\"request\":\"abc\",\"status\":200}"), std::string::npos)
+        << captured[0].message;
+    EXPECT_NE(captured[1].message.find("\"message\":\"other thread\"}"), std::string::npos) << captured[1].message;
+}
+
+TEST(LoggerTest, FlightRecorderReplaysFilteredRecordsOnFatal)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> captured;
+    FlightRecorderOptions options;
+    options.capacity = 3;
+    FlightRecorderDecorator logger(
+        std::make_unique<LevelFilterDecorator>(std::make_unique<Logger>(std::make_unique<CaptureOutput>(captured))), options);
+
+    // Act
+    bool debugEnabled = logger.isEnabled(LogLevel::Debug);
+    for (int i = 1; i <= 4; ++i) {
+        logger.log(LogLevel::Debug, "debug {}", i);
+    }
+    logger.log(LogLevel::Info, "live");
+    std::size_t beforeFatal = captured.size();
+    logger.log(LogLevel::Fatal, "crash");
+
+    // Assert
+    EXPECT_TRUE(debugEnabled);
+    EXPECT_EQ(beforeFatal, 1u);
+    std::vector<std::string> messages;
+    for (const auto& record : captured) {
+        messages.push_back(record.message);
+    }
+    std::vector<std::string> expected = {"live", "flight recorder: replaying 3 records", "debug 2", "debug 3", "debug 4", "crash"};
+    EXPECT_EQ(messages, expected);
+    EXPECT_EQ(logger.recordedCount(), 4u);
+    EXPECT_EQ(logger.replayedCount(), 3u);
+}
+
+TEST(LoggerTest, LogFieldCopyIsReusableAfterMove)
+{
+    // Arrange
+    LogField first[] = {{"request", std::string_view("abc")}, {"status", 200}};
+    LogField second[] = {{"user", std::string_view("ada")}};
+    LogFieldCopy copy;
+    copy.assign(LogFields{first, 2});
+
+    // Act
+    LogFieldCopy moved(std::move(copy));
+    copy.assign(LogFields{second, 1}); // As a flight recorder slot does after a dump
+    LogFields reused = copy.view();
+    LogFields kept = moved.view();
+
+    // Assert
+    ASSERT_EQ(reused.size(), 1u);
+    EXPECT_EQ(reused.begin()->key, "user");
+    EXPECT_EQ(reused.begin()->stringValue, "ada");
+    ASSERT_EQ(kept.size(), 2u);
+    EXPECT_EQ(kept.begin()->stringValue, "abc");
+}
+
+TEST(LoggerTest, FlightRecorderDumpsAllThreadsOnSignal)
+{
+    // Arrange
+    std::vector<CaptureOutput::Captured> captured;
+    FlightRecorderDecorator logger(std::make_unique<LevelFilterDecorator>(
+        std::make_unique<TimestampDecorator>(std::make_unique<Logger>(std::make_unique<CaptureOutput>(captured))), LogLevel::Warning));
+    FlightRecorderDecorator::dumpOnSignal(SIGUSR1);
+    logger.log(LogLevel::Debug, "main 1");
+    std::thread worker([&logger] { logger.log(LogLevel::Info, "worker"); });
+    worker.join();
+    logger.log(LogLevel::Debug, "main 2");
+
+    // Act
+    std::raise(SIGUSR1);
+    logger.log(LogLevel::Error, "after signal");
+    std::size_t afterSignal = captured.size();
+    std::size_t secondDump = logger.dump();
+    std::signal(SIGUSR1, SIG_DFL);
+
+    // Assert
+    ASSERT_EQ(afterSignal, 5u);
+    EXPECT_EQ(captured[0].message, "flight recorder: replaying 3 records");
+    EXPECT_EQ(captured[1].message, "main 1");
+    EXPECT_EQ(captured[2].message, "worker");
+    EXPECT_EQ(captured[3].message, "main 2");
+    EXPECT_EQ(captured[4].message, "after signal");
+    EXPECT_FALSE(captured[1].prefix.empty()); // Replayed through the timestamp decorator
+    EXPECT_EQ(secondDump, 0u);
+}
+
+// Counts heap allocations on every thread while countingAllocations is set
+static std::atomic<bool> countingAllocations{false};
+static std::atomic<std::size_t> allocationCount{0};
+
+void* operator new(std::size_t size)
+{
+    if (countingAllocations.load(std::memory_order_relaxed)) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* memory = std::malloc(size != 0 ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+// Discards records, holding every write until the gate opens
+class GatedNullOutput : public IOutputStrategy {
+public:
+    explicit GatedNullOutput(std::atomic<bool>& open) : open(open) {}
+
+    void output(const std::string&) override {}
+
+    void write(const LogRecord&) override {
+        while (!open.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    std::atomic<bool>& open;
+};
+
+TEST(LoggerTest, RecordPoolRecyclesSlabsToProducer)
+{
+    // Arrange
+    RecordPool pool(32);
+    PooledRecord handed;
+
+    // Act
+    std::thread producer([&pool, &handed] { handed = PooledRecord(LogRecord(LogLevel::Info, "from producer"), pool); });
+    producer.join();
+    std::string stored(handed.str());
+    PooledRecord shared = handed;
+    handed.reset();
+    std::string stillShared(shared.materialize().message);
+    shared.reset(); // Returns the slab to the producer, not to this thread
+
+    LogRecord long_record(LogLevel::Error, std::string_view("a message that does not fit into a slab of 32 bytes"));
+    long_record.prepend("[1] ");
+    PooledRecord spilled(long_record, pool);
+    LogRecord replayed = spilled.materialize();
+
+    // Assert
+    EXPECT_EQ(stored, "from producer");
+    EXPECT_EQ(stillShared, "from producer");
+    EXPECT_EQ(pool.slabCount(), 1u); // This thread took over the cache of the exited producer
+    EXPECT_EQ(pool.spillCount(), 1u);
+    EXPECT_EQ(replayed.prefix(), "[1] ");
+    EXPECT_EQ(replayed.message, "a message that does not fit into a slab of 32 bytes");
+    EXPECT_EQ(replayed.level, LogLevel::Error);
+}
+
+TEST(LoggerTest, RecordPoolReusesCachesOfExitedThreads)
+{
+    // Arrange
+    RecordPool pool(64);
+    std::vector<PooledRecord> inFlight;
+    std::mutex inFlightMutex;
+
+    // Act
+    for (int round = 0; round < 50; ++round) {
+        std::thread producer([&pool, &inFlight, &inFlightMutex] {
+            PooledRecord first(LogRecord(LogLevel::Info, "released"), pool);
+            PooledRecord kept(LogRecord(LogLevel::Info, "handed over"), pool);
+            std::lock_guard<std::mutex> lock(inFlightMutex);
+            inFlight.push_back(std::move(kept));
+        });
+        producer.join();
+        inFlight.clear(); // Slabs still in flight return to the cache of the exited thread
+    }
+
+    // Assert
+    EXPECT_EQ(pool.slabCount(), 2u);
+}
+
+TEST(LoggerTest, QueuedLoggingDoesNotAllocateInSteadyState)
+{
+    // Arrange
+    std::atomic<bool> open{false};
+    AsyncLogger async(std::make_unique<GatedNullOutput>(open), 256);
+    std::vector<SinkConfig> sinks;
+    sinks.push_back(SinkConfig{std::make_unique<GatedNullOutput>(open)});
+    sinks.push_back(SinkConfig{std::make_unique<GatedNullOutput>(open)});
+    FanOutOutput fanOut(std::move(sinks));
+    std::string message(120, 'm');
+    const int batch = 100;
+
+    // Warm up the pools with more records in flight than a batch holds
+    for (int i = 0; i < batch; ++i) {
+        async.log(LogLevel::Info, message);
+        async.log(LogLevel::Info, "value {}", i);
+        fanOut.write(LogRecord(LogLevel::Info, message));
+    }
+    open.store(true, std::memory_order_release);
+    async.flush();
+    fanOut.waitDrained();
+
+    // Act
+    countingAllocations.store(true);
+    for (int round = 0; round < 50; ++round) {
+        for (int i = 0; i < batch / 2; ++i) {
+            async.log(LogLevel::Info, message);
+            async.log(LogLevel::Warning, "value {} of {}", i, round);
+            fanOut.write(LogRecord(LogLevel::Info, message));
+        }
+        async.flush();
+        fanOut.waitDrained();
+    }
+    countingAllocations.store(false);
+
+    // Assert
+    EXPECT_EQ(allocationCount.load(), 0u);
+}
+
+// Captures records, holding every write until the gate opens
+class GatedCaptureOutput : public CaptureOutput {
+public:
+    GatedCaptureOutput(std::vector<Captured>& records, std::atomic<bool>& open) : CaptureOutput(records), open(open) {}
+
+    void write(const LogRecord& record) override {
+        while (!open.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+        CaptureOutput::write(record);
+    }
+
+private:
+    std::atomic<bool>& open;
+};
+
+TEST(LoggerTest, AsyncLoggerOverwriteOldestKeepsNewestRecords)
+{
+    // Arrange
+    std::atomic<bool> open{false};
+    std::vector<CaptureOutput::Captured> records;
+    QueueOptions options;
+    options.capacity = 8;
+    options.overflowPolicy = OverflowPolicy::OverwriteOldest;
+    AsyncLogger async(std::make_unique<GatedCaptureOutput>(records, open), options);
+
+    // Act
+    for (int i = 0; i < 40; ++i) {
+        async.log(LogLevel::Info, "record {}", i);
+    }
+    std::uint64_t dropped = async.stats().recordsDropped;
+    open.store(true, std::memory_order_release);
+    async.flush();
+
+    // Assert
+    ASSERT_GT(dropped, 0u);
+    ASSERT_LE(records.size(), 9u); // The queue plus the record held by the worker
+    ASSERT_EQ(records.size() + dropped, 40u);
+    ASSERT_EQ(records.back().message, "record 39");
+    ASSERT_EQ(records[records.size() - 2].message, "record 38");
+}
+
+TEST(LoggerTest, FanOutSinkShedsVerboseRecordsAndTimesOut)
+{
+    // Arrange
+    std::atomic<bool> open{false};
+    std::vector<CaptureOutput::Captured> shedding;
+    std::vector<CaptureOutput::Captured> timed;
+    std::vector<SinkConfig> sinks;
+    sinks.push_back(SinkConfig{std::make_unique<GatedCaptureOutput>(shedding, open), OverflowPolicy::ShedByLevel, 8});
+    sinks.push_back(SinkConfig{std::make_unique<GatedCaptureOutput>(timed, open), OverflowPolicy::BlockWithTimeout, 2,
+                               std::chrono::microseconds(200)});
+
+    // Act
+    TelemetrySnapshot sheddingStats;
+    TelemetrySnapshot timedStats;
+    {
+        FanOutOutput output(std::move(sinks));
+        for (int i = 0; i < 20; ++i) {
+            output.write(LogRecord(LogLevel::Debug, "verbose"));
+        }
+        for (int i = 0; i < 3; ++i) {
+            output.write(LogRecord(LogLevel::Error, "important"));
+        }
+        sheddingStats = output.sinkStats(0);
+        timedStats = output.sinkStats(1);
+        open.store(true, std::memory_order_release);
+        output.waitDrained();
+    }
+
+    // Assert
+    std::size_t errors = std::count_if(shedding.begin(), shedding.end(), [](const CaptureOutput::Captured& record) {
+        return record.level == LogLevel::Error;
+    });
+    ASSERT_EQ(errors, 3u);
+    ASSERT_GE(sheddingStats.recordsDropped, 15u);
+    ASSERT_EQ(shedding.size() + sheddingStats.recordsDropped, 23u);
+    ASSERT_GT(timedStats.recordsDropped, 0u);
+    ASSERT_EQ(timed.size() + timedStats.recordsDropped, 23u);
+}
+
+TEST(LoggerTest, FanOutFlushDoesNotWaitForWedgedSink)
+{
+    // Arrange
+    std::atomic<bool> open{false};
+    std::vector<CaptureOutput::Captured> fast;
+    std::vector<CaptureOutput::Captured> wedged;
+    std::vector<SinkConfig> sinks;
+    sinks.push_back(SinkConfig{std::make_unique<CaptureOutput>(fast)});
+    sinks.push_back(SinkConfig{std::make_unique<GatedCaptureOutput>(wedged, open), OverflowPolicy::DropNewest, 4});
+    auto output = std::make_unique<FanOutOutput>(std::move(sinks));
+    FanOutOutput* fanOut = output.get();
+    AsyncLogger logger(std::move(output), 256);
+
+    // Act
+    auto started = std::chrono::steady_clock::now();
+    for (int i = 0; i < 100; ++i) {
+        logger.log(LogLevel::Info, "record {}", i);
+    }
+    logger.flush();
+    auto flushTime = std::chrono::steady_clock::now() - started;
+    open.store(true, std::memory_order_release);
+    fanOut->waitDrained();
+
+    // Assert
+    ASSERT_LT(flushTime, std::chrono::milliseconds(500));
+    ASSERT_EQ(fast.size(), 100u);
+    ASSERT_EQ(wedged.size() + fanOut->droppedCount(1), 100u);
+}
+
+// Counts the records it receives; safe to share between threads
+class CountingOutput : public IOutputStrategy {
+public:
+    explicit CountingOutput(std::atomic<int>& count) : count(count) {}
+
+    void output(const std::string&) override {
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<int>& count;
+};
+
+TEST(LoggerTest, RateLimitDecoratorSummarizesAtWindowEnd)
+{
+    // Arrange
+    std::atomic<int> written{0};
+    RateLimitPolicy policy;
+    policy.key = RateLimitKey::Level;
+    policy.recordsPerSecond = 1;
+    policy.burst = 2;
+    policy.summaryInterval = std::chrono::milliseconds(50);
+    RateLimitDecorator logger(std::make_unique<Logger>(std::make_unique<CountingOutput>(written)), policy);
+
+    // Act
+    for (int i = 0; i < 20; ++i) {
+        logger.log(LogLevel::Warning, "flood");
+    }
+    int beforeWindowEnd = written.load();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (written.load() < 3 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    // Assert
+    ASSERT_EQ(beforeWindowEnd, 2);
+    ASSERT_EQ(written.load(), 3); // The summary, without another record to trigger it
+}
+
+TEST(LoggerTest, DuplicateSuppressionReportsRunFollowedBySilence)
+{
+    // Arrange
+    std::atomic<int> written{0};
+    DuplicateSuppressionPolicy policy;
+    policy.maxHold = std::chrono::milliseconds(30);
+    DuplicateSuppressionDecorator logger(std::make_unique<Logger>(std::make_unique<CountingOutput>(written)), policy);
+
+    // Act
+    for (int i = 0; i < 10; ++i) {
+        logger.log(LogLevel::Error, "connection refused");
+    }
+    int beforeHold = written.load();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (written.load() < 2 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    // Assert
+    ASSERT_EQ(beforeHold, 1);
+    ASSERT_EQ(written.load(), 2); // "message repeated 9 times", without another record
+    ASSERT_EQ(logger.suppressedCount(), 9u);
+}
+
+TEST(LoggerTest, ReloadableLoggerSwapsPipelineUnderLoad)
+{
+    // Arrange
+    std::atomic<int> first{0};
+    std::atomic<int> second{0};
+    std::atomic<int> logged{0};
+    std::atomic<bool> stop{false};
+    ReloadableLogger logger(std::make_unique<Logger>(std::make_unique<CountingOutput>(first)));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                logger.log(LogLevel::Warning, "record");
+                logged.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    // Act
+    while (first.load() < 100) {
+        std::this_thread::yield();
+    }
+    logger.reload(std::make_unique<LevelFilterDecorator>(
+        std::make_unique<Logger>(std::make_unique<CountingOutput>(second)), LogLevel::Warning));
+    int retired = first.load();
+    while (second.load() < 100) {
+        std::this_thread::yield();
+    }
+    stop.store(true);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    // Assert
+    ASSERT_EQ(logger.reloadCount(), 1u);
+    ASSERT_EQ(first.load(), retired); // Nothing reaches the old pipeline once reload() returns
+    ASSERT_EQ(first.load() + second.load(), logged.load());
+    ASSERT_TRUE(logger.isEnabled(LogLevel::Warning));
+    ASSERT_FALSE(logger.isEnabled(LogLevel::Info));
+}
+
+TEST(LoggerTest, LoggerFactoryBuildsPipelineFromConfig)
+{
+    // Arrange
+    std::string filename = "test_config.log";
+    std::ofstream file(filename);
+    file.close();
+    std::string config = R"({
+        "level": "warning",
+        "decorators": ["level"],
+        "sinks": [{"type": "file", "path": "test_config.log", "buffered": false}]
+    })";
+
+    // Act
+    std::unique_ptr<ILogger> logger = LoggerFactory::createFromConfig(config);
+    logger->log(LogLevel::Info, "filtered");
+    logger->log(LogLevel::Error, "kept");
+    logger.reset();
+
+    // Assert
+    ASSERT_EQ(readFile(filename), "[1] kept\n");
+    ASSERT_THROW(LoggerFactory::createFromConfig(R"({"sinks": [{"type": "carrier pigeon"}]})"), std::invalid_argument);
+    ASSERT_THROW(LoggerFactory::createFromConfig(R"({"level": "info",})"), std::invalid_argument);
+    ASSERT_THROW(LoggerFactory::createFromConfig(R"({"async": {"overflow": "sometimes"}})"), std::invalid_argument);
+    std::remove(filename.c_str());
+}
+
+TEST(LoggerTest, LoggerFactoryRejectsOutOfRangeConfigNumbers)
+{
+    // Arrange
+    const char* configs[] = {
+        R"({"async": {"capacity": -1}})",
+        R"({"async": {"capacity": 1e300}})",
+        R"({"async": {"capacity": 2.5}})",
+        R"({"async": {"block_timeout_us": -5}})",
+        R"({"fan_out": true, "sinks": [{"type": "null", "queue_capacity": -8}, {"type": "null"}]})",
+        R"({"sinks": [{"type": "compressed", "path": "test_config_range.gz", "compression_level": 42}]})",
+    };
+
+    // Act & Assert
+    for (const char* config : configs) {
+        ASSERT_THROW(LoggerFactory::createFromConfig(config), std::invalid_argument) << config;
+    }
+    ASSERT_NE(LoggerFactory::createFromConfig(R"({"async": {"capacity": 16}, "sinks": [{"type": "null"}]})"), nullptr);
+}
+
+TEST(LoggerTest, LoggerFactoryLeavesCategoriesAloneOnRejectedConfig)
+{
+    // Arrange
+    Category first = CategoryRegistry::global().get("config_test.first");
+    LogLevel before = first.level();
+    std::string config = R"({"categories": {"config_test.first": "noise", "config_test.second": "loud"}, "sinks": [{"type": "null"}]})";
+
+    // Act
+    ASSERT_THROW(LoggerFactory::createFromConfig(config), std::invalid_argument);
+
+    // Assert
+    ASSERT_EQ(first.level(), before);
+    ASSERT_NE(before, LogLevel::Noise);
+}
+
+TEST(LoggerTest, ConfigValueDecodesSurrogatePairs)
+{
+    // Arrange
+    std::string_view pair = R"(["\u00e9\u20ac\uD83D\uDE00"])";
+
+    // Act
+    ConfigValue value = ConfigValue::parse(pair);
+
+    // Assert
+    ASSERT_EQ(value.items.at(0).stringValue, "\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80");
+    ASSERT_THROW(ConfigValue::parse(R"("\uD83D")"), std::invalid_argument);
+    ASSERT_THROW(ConfigValue::parse(R"("\uD83Dx")"), std::invalid_argument);
+    ASSERT_THROW(ConfigValue::parse(R"("\uD83D\u0041")"), std::invalid_argument);
+    ASSERT_THROW(ConfigValue::parse(R"("\uDE00")"), std::invalid_argument);
+}
+
+TEST(LoggerTest, CategoryRegistryInheritsParentLevels)
+{
+    // Arrange
+    CategoryRegistry registry;
+    Category http = registry.get("net.http");
+    Category wal = registry.get("storage.wal");
+
+    // Act
+    registry.setLevel("net", LogLevel::Debug);
+    LogLevel inherited = http.level();
+    registry.setLevel("net.http", LogLevel::Error);
+    registry.setLevel("net", LogLevel::Noise);
+    LogLevel overridden = http.level();
+    registry.clearLevel("net.http");
+
+    // Assert
+    ASSERT_EQ(registry.size(), 5u); // Root, net, net.http, storage and storage.wal
+    ASSERT_EQ(registry.get("net.http").id(), http.id());
+    ASSERT_EQ(http.name(), "net.http");
+    ASSERT_EQ(inherited, LogLevel::Debug);
+    ASSERT_EQ(overridden, LogLevel::Error);
+    ASSERT_EQ(http.level(), LogLevel::Noise);
+    ASSERT_TRUE(http.isEnabled(LogLevel::Debug));
+    ASSERT_EQ(wal.level(), LogLevel::Info);
+    ASSERT_FALSE(wal.isEnabled(LogLevel::Debug));
+}
+
+TEST(LoggerTest, CategoryDecoratorFollowsLevelChanges)
+{
+    // Arrange
+    CategoryRegistry registry;
+    std::vector<CaptureOutput::Captured> records;
+    auto logger = LoggerFactory::createCategoryLogger(std::make_unique<Logger>(std::make_unique<CaptureOutput>(records)),
+                                                      registry, registry.get("storage.wal"));
+
+    // Act
+    logger->log(LogLevel::Debug, "hidden");
+    bool enabledBefore = logger->isEnabled(LogLevel::Debug);
+    registry.setLevel("storage", LogLevel::Debug);
+    logger->log(LogLevel::Debug, "shown");
+
+    // Assert
+    ASSERT_FALSE(enabledBefore);
+    ASSERT_TRUE(logger->isEnabled(LogLevel::Debug));
+    ASSERT_EQ(records.size(), 1u);
+    ASSERT_EQ(records[0].prefix, "[storage.wal] ");
+    ASSERT_EQ(records[0].message, "shown");
+}
+
+TEST(LoggerTest, DurableFileOutputGroupsCommits)
+{
+    // Arrange
+    std::string filename = "test_durable.log";
+    std::remove(filename.c_str());
+    DurabilityOptions options;
+    options.maxCommitDelay = std::chrono::milliseconds(5);
+    const int threads = 4;
+    const int perThread = 25;
+
+    // Act
+    std::uint64_t commits = 0;
+    bool allCommitted = true;
+    {
+        DurableFileOutput output(filename, options);
+        std::vector<std::thread> writers;
+        std::atomic<int> failures{0};
+        for (int t = 0; t < threads; ++t) {
+            writers.emplace_back([&output, &failures] {
+                for (int i = 0; i < perThread; ++i) {
+                    DurableFileOutput::Token token = output.writeDurable(LogRecord(LogLevel::Error, "audit"));
+                    if (!output.wait(token) || !output.isCommitted(token)) {
+                        failures.fetch_add(1);
+                    }
+                }
+            });
+        }
+        for (std::thread& writer : writers) {
+            writer.join();
+        }
+        output.write(LogRecord(LogLevel::Info, "fast path"));
+        allCommitted = failures.load() == 0 && output.sync();
+        commits = output.commitCount();
+    }
+
+    // Assert
+    std::string contents = readFile(filename);
+    ASSERT_TRUE(allCommitted);
+    ASSERT_LT(commits, static_cast<std::uint64_t>(threads * perThread)); // Waiters share syncs
+    ASSERT_EQ(std::count(contents.begin(), contents.end(), '\n'), threads * perThread + 1);
+    ASSERT_EQ(contents.substr(contents.size() - 10), "fast path\n");
+    std::remove(filename.c_str());
+}
+
+#if defined(CPPLOGGER_HAVE_ZLIB)
+static std::string readGzip(const std::string& filename)
+{
+    std::string content;
+    gzFile compressed = gzopen(filename.c_str(), "rb");
+    if (compressed == nullptr) {
+        return content;
+    }
+    char buffer[4096];
+    int length = 0;
+    while ((length = gzread(compressed, buffer, sizeof(buffer))) > 0) {
+        content.append(buffer, static_cast<std::size_t>(length));
+    }
+    gzclose(compressed);
+    return content;
+}
+
+TEST(LoggerTest, CompressedFileOutputStreamsGzipBlocks)
+{
+    // Arrange
+    std::string filename = "test_compressed.log.gz";
+    std::remove(filename.c_str());
+    CompressionOptions options;
+    options.blockSize = 4096;
+    std::string expected;
+
+    // Act
+    std::string flushed;
+    {
+        CompressedFileOutput output(filename, options);
+        for (int i = 0; i < 2000; ++i) {
+            std::string line = "request " + std::to_string(i) + " served in " + std::to_string(i % 17) + " ms";
+            output.write(LogRecord(LogLevel::Info, line));
+            expected += line + "\n";
+        }
+        output.flush();
+        flushed = readGzip(filename); // The member is not finished yet, but every block is readable
+    }
+
+    // Assert
+    ASSERT_EQ(flushed, expected);
+    ASSERT_EQ(readGzip(filename), expected);
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    ASSERT_LT(static_cast<std::size_t>(file.tellg()) * 5, expected.size());
+    std::remove(filename.c_str());
+}
+
+TEST(LoggerTest, RotatingFileOutputWritesCompressedStreams)
+{
+    // Arrange
+    std::string filename = "test_rotate_stream.log";
+    removeRotatedFiles(filename);
+    RotationPolicy policy;
+    policy.maxFileSize = 200;
+    policy.maxFiles = 19;
+    policy.compression = RotationCompression::GzipStream;
+    std::string expected;
+
+    // Act
+    {
+        Logger logger(std::make_unique<RotatingFileOutput>(filename, policy));
+        for (int i = 0; i < 60; ++i) {
+            logger.log(LogLevel::Info, "line {}", i);
+            expected += "line " + std::to_string(i) + "\n";
+        }
+    }
+
+    // Assert
+    ASSERT_TRUE(fileExists(filename + ".1.gz"));
+    ASSERT_FALSE(fileExists(filename + ".1"));
+    std::string content;
+    for (int i = 19; i >= 1; --i) {
+        content += readGzip(filename + "." + std::to_string(i) + ".gz");
+    }
+    content += readGzip(filename);
+    ASSERT_EQ(content, expected);
+}
+
+TEST(LoggerTest, RotatingFileOutputKeepsFilesThatFailedToCompress)
+{
+    // Arrange
+    std::string filename = "test_rotate_gzip_failure.log";
+    removeRotatedFiles(filename);
+    for (int i = 1; i <= 3; ++i) {
+        // Non-empty directories cannot be replaced, so no compressed file can be created
+        std::string directory = filename + "." + std::to_string(i) + ".gz";
+        ::mkdir(directory.c_str(), 0700);
+        std::ofstream(directory + "/keep");
+    }
+    RotationPolicy policy;
+    policy.maxFileSize = 10;
+    policy.maxFiles = 3;
+    policy.compression = RotationCompression::Gzip;
+
+    // Act
+    {
+        RotatingFileOutput output(filename, policy);
+        for (const char* line : {"aaaaaaaaa", "bbbbbbbbb", "ccccccccc"}) {
+            output.output(line);
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    }
+
+    // Assert
+    std::string content = readGzip(filename); // gzread passes uncompressed files through
+    for (int i = 1; i <= 3; ++i) {
+        std::string index = "." + std::to_string(i);
+        content += readGzip(filename + index) + readGzip(filename + index + ".gz");
+    }
+    for (const char* line : {"aaaaaaaaa\n", "bbbbbbbbb\n", "ccccccccc\n"}) {
+        ASSERT_NE(content.find(line), std::string::npos) << line;
+    }
+    for (int i = 1; i <= 3; ++i) {
+        std::string directory = filename + "." + std::to_string(i) + ".gz";
+        std::remove((directory + "/keep").c_str());
+    }
+    removeRotatedFiles(filename);
+}
+#endif
+
+TEST(LoggerTest, SharedMemoryOutputDeliversThroughCollector)
+{
+    // Arrange
+    std::string prefix = "cpplogger_test_" + std::to_string(::getpid());
+    std::vector<CaptureOutput::Captured> records;
+    SharedMemoryCollector collector(prefix, std::make_unique<CaptureOutput>(records));
+    const int threadCount = 4;
+    const int perRound = 100;
+    const int rounds = 8;
+    SharedMemoryOptions options;
+    options.capacity = 64 * 1024;
+
+    // Act
+    std::string segment;
+    std::uint64_t dropped = 0;
+    {
+        auto output = std::make_unique<SharedMemoryOutput>(prefix, options);
+        SharedMemoryOutput& ring = *output;
+        segment = output->name();
+        Logger logger(std::move(output));
+        for (int round = 0; round < rounds; ++round) { // Every round wraps further around the ring
+            std::vector<std::thread> threads;
+            for (int t = 0; t < threadCount; ++t) {
+                threads.emplace_back([&logger, t, round] {
+                    for (int i = 0; i < perRound; ++i) {
+                        logger.log(LogLevel::Warning, "thread {} message {}", t, round * perRound + i);
+                    }
+                });
+            }
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+            collector.poll();
+        }
+        dropped = ring.droppedCount();
+    }
+    collector.poll();
+
+    // Assert
+    ASSERT_EQ(dropped, 0u);
+    ASSERT_EQ(records.size(), static_cast<std::size_t>(threadCount * perRound * rounds));
+    int next[threadCount] = {};
+    for (const CaptureOutput::Captured& record : records) {
+        int thread = 0;
+        int message = 0;
+        ASSERT_EQ(std::sscanf(record.message.c_str(), "thread %d message %d", &thread, &message), 2) << record.message;
+        ASSERT_EQ(record.level, LogLevel::Warning);
+        ASSERT_EQ(message, next[thread]++); // Each thread's records stay in order
+    }
+    ASSERT_EQ(collector.segmentCount(), 0u);
+    ASSERT_FALSE(fileExists("/dev/shm" + segment)); // Removed once drained and closed
+}
+
+TEST(LoggerTest, SharedMemoryCollectorDrainsOtherProcesses)
+{
+    // Arrange
+    std::string prefix = "cpplogger_fork_" + std::to_string(::getpid());
+    std::vector<CaptureOutput::Captured> records;
+    SharedMemoryCollector collector(prefix, std::make_unique<CaptureOutput>(records));
+
+    // Act
+    const int children = 2;
+    for (int c = 0; c < children; ++c) {
+        pid_t pid = ::fork();
+        ASSERT_GE(pid, 0);
+        if (pid == 0) {
+            SharedMemoryOptions options;
+            options.capacity = 4096;
+            SharedMemoryOutput output(prefix, options);
+            LogRecord record(LogLevel::Error, std::string_view("from child"));
+            record.prepend("[child] ");
+            for (int i = 0; i < 200; ++i) {
+                output.write(record); // No collector runs yet, so the ring fills up and drops
+            }
+            ::_exit(0);
+        }
+        int status = 0;
+        ::waitpid(pid, &status, 0);
+        ASSERT_TRUE(WIFEXITED(status));
+    }
+    collector.poll();
+
+    // Assert
+    ASSERT_GT(records.size(), 0u);
+    ASSERT_GT(collector.droppedCount(), 0u);
+    ASSERT_EQ(records.size() + collector.droppedCount(), static_cast<std::size_t>(children * 200));
+    ASSERT_EQ(records[0].prefix, "[child] ");
+    ASSERT_EQ(records[0].message, "from child");
+    ASSERT_EQ(records[0].level, LogLevel::Error);
+    ASSERT_EQ(collector.segmentCount(), 0u);
+}
+
+// Maps the header and ring of a shared-memory segment, as a producer or collector would
+static char* mapSegment(const std::string& name, std::size_t capacity)
+{
+    int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        return nullptr;
+    }
+    void* mapping = ::mmap(nullptr, shared_memory_ring::DataOffset + capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    return mapping == MAP_FAILED ? nullptr : static_cast<char*>(mapping);
+}
+
+TEST(LoggerTest, SharedMemoryCollectorSkipsAbandonedAndCorruptSlots)
+{
+    // Arrange
+    std::string prefix = "cpplogger_damaged_" + std::to_string(::getpid());
+    std::vector<CaptureOutput::Captured> records;
+    SharedMemoryCollector collector(prefix, std::make_unique<CaptureOutput>(records));
+    SharedMemoryOptions options;
+    options.capacity = 4096;
+
+    // Act
+    pid_t pid = ::fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        SharedMemoryOutput output(prefix, options);
+        char* mapping = mapSegment(output.name(), 4096);
+        auto* header = reinterpret_cast<shared_memory_ring::Header*>(mapping);
+        output.output("before");
+        header->head.fetch_add(32); // Claimed by a thread that dies before publishing
+        output.output("after");
+        ::_exit(0); // Without closing the segment
+    }
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    collector.poll();
+    std::size_t abandonedRecords = records.size();
+    std::uint64_t abandonedDrops = collector.droppedCount();
+    std::size_t abandonedSegments = collector.segmentCount();
+
+    std::string corruptName;
+    {
+        SharedMemoryOutput output(prefix, options);
+        corruptName = output.name();
+        output.output("unreadable");
+        char* mapping = mapSegment(corruptName, 4096);
+        auto* slot = reinterpret_cast<shared_memory_ring::Slot*>(mapping + shared_memory_ring::DataOffset);
+        slot->prefixLength = 0xFFFF; // Longer than the slot
+        collector.poll();
+        ::munmap(mapping, shared_memory_ring::DataOffset + 4096);
+    }
+
+    // Assert
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(abandonedRecords, 2u);
+    EXPECT_EQ(records[0].message, "before");
+    EXPECT_EQ(records[1].message, "after");
+    EXPECT_EQ(abandonedDrops, 1u);
+    EXPECT_EQ(abandonedSegments, 0u);
+    EXPECT_EQ(records.size(), 2u);
+    EXPECT_EQ(collector.segmentCount(), 0u);
+    EXPECT_FALSE(fileExists("/dev/shm" + corruptName));
+}
+
+TEST(LoggerTest, SharedMemoryOutputRetiresSegmentOfReusedPid)
+{
+    // Arrange
+    std::string prefix = "cpplogger_stale_" + std::to_string(::getpid());
+    std::vector<CaptureOutput::Captured> records;
+    SharedMemoryCollector collector(prefix, std::make_unique<CaptureOutput>(records));
+    SharedMemoryOptions options;
+    options.capacity = 4096;
+    std::string current;
+    {
+        SharedMemoryOutput first(prefix, options);
+        current = first.name();
+    }
+    collector.poll();
+    std::size_t index = std::stoul(current.substr(current.rfind('.') + 1));
+    std::string stale = current.substr(0, current.rfind('.') + 1) + std::to_string(index + 1);
+    int fd = ::shm_open(stale.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(::ftruncate(fd, static_cast<off_t>(shared_memory_ring::DataOffset + 4096)), 0);
+    ::close(fd);
+    char* mapping = mapSegment(stale, 4096);
+    auto* header = reinterpret_cast<shared_memory_ring::Header*>(mapping);
+    header->capacity = 4096;
+    header->pid = ::getpid(); // As left by an earlier process with this pid
+    header->magic.store(shared_memory_ring::Magic);
+
+    // Act
+    std::string name;
+    {
+        SharedMemoryOutput output(prefix, options);
+        name = output.name();
+    }
+    std::uint32_t staleClosed = header->closed.load();
+    collector.poll();
+
+    // Assert
+    EXPECT_NE(name, stale);
+    EXPECT_EQ(staleClosed, 1u);
+    EXPECT_EQ(collector.segmentCount(), 0u);
+    EXPECT_FALSE(fileExists("/dev/shm" + stale));
+    ::munmap(mapping, shared_memory_ring::DataOffset + 4096);
+}
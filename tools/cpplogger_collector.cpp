@@ -0,0 +1,92 @@
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "../include/logger.hpp"
+
+// Drains the shared-memory rings of every SharedMemoryOutput with a prefix into one set of sinks
+static volatile std::sig_atomic_t stopRequested = 0;
+
+static void requestStop(int)
+{
+    stopRequested = 1;
+}
+
+static void printUsage(const char* program)
+{
+    std::cerr << "Usage: " << program << " [--prefix=NAME] [--output=FILE | --config=FILE] [--json] [--poll-ms=N]" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    std::string prefix = "cpplogger";
+    std::string outputFile;
+    std::string configFile;
+    bool json = false;
+    int pollMs = 10;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument.rfind("--prefix=", 0) == 0) {
+            prefix = argument.substr(9);
+        } else if (argument.rfind("--output=", 0) == 0) {
+            outputFile = argument.substr(9);
+        } else if (argument.rfind("--config=", 0) == 0) {
+            configFile = argument.substr(9);
+        } else if (argument == "--json") {
+            json = true;
+        } else if (argument.rfind("--poll-ms=", 0) == 0) {
+            pollMs = std::atoi(argument.c_str() + 10);
+        } else {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (prefix.empty() || prefix.find('/') != std::string::npos || pollMs <= 0 || (!outputFile.empty() && !configFile.empty())) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::unique_ptr<IOutputStrategy> output;
+    try {
+        if (!configFile.empty()) {
+            // The "sinks" of a logger configuration file, as LoggerFactory::createFromConfigFile reads them
+            std::ifstream file(configFile);
+            if (!file) {
+                std::cerr << argv[0] << ": cannot open " << configFile << std::endl;
+                return EXIT_FAILURE;
+            }
+            std::ostringstream contents;
+            contents << file.rdbuf();
+            output = logger_config::buildOutput(ConfigValue::parse(contents.str()));
+        } else if (!outputFile.empty()) {
+            output = std::make_unique<BufferedFileOutput>(outputFile);
+        } else {
+            output = std::make_unique<ConsoleOutput>();
+        }
+    } catch (const std::exception& error) {
+        std::cerr << argv[0] << ": " << error.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (json) {
+        output = std::make_unique<JsonOutput>(std::move(output));
+    }
+
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+    SharedMemoryCollector collector(prefix, std::move(output));
+    while (!stopRequested) {
+        if (collector.poll() == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(pollMs));
+        }
+    }
+    collector.poll();
+    if (collector.droppedCount() > 0) {
+        std::cerr << argv[0] << ": producers dropped " << collector.droppedCount() << " records" << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,65 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include "../include/logger.hpp"
+
+// Decodes binary logs written by BinaryLogger into the text the level and timestamp decorators produce
+static void printUsage(const char* program)
+{
+    std::cerr << "Usage: " << program << " [--no-level] [--no-timestamp] [--precision=s|ms|us] [--utc] FILE..." << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    BinaryDecodeOptions options;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--no-level") {
+            options.showLevel = false;
+        } else if (argument == "--no-timestamp") {
+            options.showTimestamp = false;
+        } else if (argument == "--precision=s") {
+            options.precision = TimestampPrecision::Seconds;
+        } else if (argument == "--precision=ms") {
+            options.precision = TimestampPrecision::Milliseconds;
+        } else if (argument == "--precision=us") {
+            options.precision = TimestampPrecision::Microseconds;
+        } else if (argument == "--utc") {
+            options.zone = TimeZone::Utc;
+        } else if (argument.rfind("--", 0) == 0) {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        } else {
+            files.push_back(argument);
+        }
+    }
+    if (files.empty()) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    for (const std::string& file : files) {
+        std::ifstream input(file, std::ios::binary);
+        if (!input) {
+            std::cerr << argv[0] << ": cannot open " << file << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::string data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        std::string text;
+        BinaryLogDecoder decoder(options);
+        try {
+            decoder.decode(data, text);
+        } catch (const std::runtime_error& error) {
+            std::cout << text;
+            std::cerr << argv[0] << ": " << file << ": " << error.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << text;
+    }
+    return EXIT_SUCCESS;
+}